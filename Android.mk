@@ -102,6 +102,7 @@ LOCAL_C_INCLUDES := \
 	external/skia/src/images \
 	external/skia/src/ports \
 	external/sqlite/dist \
+	external/zlib \
 	frameworks/base/core/jni/android/graphics \
 	frameworks/base/include \
 	frameworks/opt/emoji
@@ -294,6 +295,16 @@ ifeq ($(ENABLE_WTF_USE_ACCELERATED_COMPOSITING),true)
 LOCAL_CFLAGS += -DWTF_USE_ACCELERATED_COMPOSITING=1
 endif
 
+# Tracks every live node so that WebViewCore::dumpDomTree() can print DOM memory per node class.
+ifeq ($(ENABLE_NODE_STATISTICS),true)
+LOCAL_CFLAGS += -DDUMP_NODE_STATISTICS=1
+endif
+
+# Counts 8-bit strings and their UTF-16 copies so that WebViewCore::dumpDomTree() can print the memory saved.
+ifeq ($(ENABLE_STRING_STATISTICS),true)
+LOCAL_CFLAGS += -DSTRING_STATS=1
+endif
+
 # LOCAL_LDLIBS is used in simulator builds only and simulator builds are only
 # valid on Linux
 LOCAL_LDLIBS += -lpthread -ldl
@@ -0,0 +1 @@
+var countAfterExternalScript = document.getElementsByTagName("li").length;
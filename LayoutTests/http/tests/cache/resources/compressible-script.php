@@ -0,0 +1,12 @@
+<?php
+header("Content-Type: application/javascript");
+header("Cache-Control: max-age=3600");
+
+// The lines repeat the same words, so the memory cache can compress the script
+// to a small fraction of its size. compressed-resource-round-trip.html rebuilds
+// each line to check the script survived being compressed and uncompressed.
+echo "var roundTripLines = [];\n";
+for ($i = 0; $i < 4000; ++$i)
+    echo "roundTripLines.push('line " . $i . " of the compressible script');\n";
+echo "var roundTripScriptRuns = (window.roundTripScriptRuns || 0) + 1;\n";
+?>
@@ -0,0 +1,8 @@
+<?php
+header("Content-Type: text/css");
+header("Cache-Control: max-age=3600");
+
+// One rule per width, so a corrupted byte changes a computed width or drops a rule.
+for ($i = 0; $i < 4000; ++$i)
+    echo ".round-trip-" . $i . " { width: " . $i . "px; }\n";
+?>
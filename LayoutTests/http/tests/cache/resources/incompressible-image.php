@@ -0,0 +1,16 @@
+<?php
+header("Content-Type: image/bmp");
+header("Cache-Control: max-age=3600");
+
+// A 128x128 24-bit bitmap of random pixels. Images are never compressed by the
+// memory cache, and random pixels would not shrink anyway, so loading enough of
+// these fills the dead capacity and makes the cache prune.
+$width = 128;
+$height = 128;
+$pixelBytes = $width * $height * 3;
+echo "BM" . pack("V", 54 + $pixelBytes) . pack("V", 0) . pack("V", 54);
+echo pack("V", 40) . pack("V", $width) . pack("V", $height) . pack("v", 1) . pack("v", 24);
+echo pack("V", 0) . pack("V", $pixelBytes) . pack("V", 2835) . pack("V", 2835) . pack("V", 0) . pack("V", 0);
+for ($i = 0; $i < $pixelBytes; $i += 4)
+    echo pack("V", mt_rand());
+?>
@@ -0,0 +1,12 @@
+<?php
+header("Content-Type: application/javascript");
+header("Cache-Control: max-age=3600");
+
+// Records a stamp that differs on every load from the network, so that a page
+// can tell a load served by the memory cache from one that went to the server.
+// The padding makes the script as large as the "size" parameter asks.
+$name = $_GET["name"];
+$size = intval($_GET["size"]);
+echo "window.stamps['" . $name . "'] = (window.stamps['" . $name . "'] || []).concat(['" . uniqid("", true) . "']);\n";
+echo "/*" . str_repeat("x", max(0, $size)) . "*/\n";
+?>
@@ -0,0 +1,2 @@
+document.getElementById('result').innerHTML += (window.hintedScriptRuns ? ' ' : '') + 'hinted script ran';
+window.hintedScriptRuns = (window.hintedScriptRuns || 0) + 1;
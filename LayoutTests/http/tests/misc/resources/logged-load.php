@@ -0,0 +1,26 @@
+<?php
+require_once '../../resources/portabilityLayer.php';
+
+// Appends "start <name>" to the log when the request arrives and "end <name>" just before the
+// response is sent, so that a page can tell in what order the browser started its loads.
+$log = sys_get_temp_dir() . "/" . $_GET['log'];
+$name = $_GET['name'];
+$delay = intval($_GET['delay']);
+
+file_put_contents($log, "start " . $name . "\n", FILE_APPEND | LOCK_EX);
+usleep($delay * 1000);
+file_put_contents($log, "end " . $name . "\n", FILE_APPEND | LOCK_EX);
+
+header("Cache-Control: no-store, no-cache, must-revalidate");
+$type = $_GET['type'];
+if ($type == "image") {
+    header("Content-Type: image/gif");
+    echo base64_decode("R0lGODlhAQABAIAAAP///wAAACH5BAEAAAAALAAAAAABAAEAAAICRAEAOw==");
+} else if ($type == "style") {
+    header("Content-Type: text/css");
+    echo "#console { }\n";
+} else {
+    header("Content-Type: application/javascript");
+    echo "\n";
+}
+?>
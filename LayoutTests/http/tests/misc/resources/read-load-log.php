@@ -0,0 +1,9 @@
+<?php
+require_once '../../resources/portabilityLayer.php';
+
+header("Cache-Control: no-store, no-cache, must-revalidate");
+header("Content-Type: text/plain");
+$log = sys_get_temp_dir() . "/" . $_GET['log'];
+echo file_get_contents($log);
+unlink($log);
+?>
@@ -219,8 +219,11 @@ EncodedJSValue JSC_HOST_CALL arrayProtoFuncToString(ExecState* exec)
     for (unsigned i = 0; i < length; i++) {
         if (i)
             buffer.append(',');
-        if (RefPtr<StringImpl> rep = strBuffer[i])
-            buffer.append(rep->characters(), rep->length());
+        if (RefPtr<StringImpl> rep = strBuffer[i]) {
+            size_t oldSize = buffer.size();
+            buffer.grow(oldSize + rep->length());
+            rep->copyCharactersTo(buffer.data() + oldSize, 0, rep->length());
+        }
     }
     ASSERT(buffer.size() == totalSize);
     return JSValue::encode(jsString(exec, UString::adopt(buffer)));
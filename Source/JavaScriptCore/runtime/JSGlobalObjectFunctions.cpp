@@ -220,7 +220,8 @@ double parseIntOverflow(const UChar* s, int length, int radix)
 static double parseInt(const UString& s, int radix)
 {
     int length = s.length();
-    const UChar* data = s.characters();
+    StringImpl::UpconvertedCharacters characters(s.impl());
+    const UChar* data = characters;
     int p = 0;
 
     while (p < length && isStrWhiteSpace(data[p]))
@@ -367,7 +368,7 @@ double jsToNumber(const UString& s)
     unsigned size = s.length();
 
     if (size == 1) {
-        UChar c = s.characters()[0];
+        UChar c = s[0];
         if (isASCIIDigit(c))
             return c - '0';
         if (isStrWhiteSpace(c))
@@ -375,7 +376,8 @@ double jsToNumber(const UString& s)
         return NaN;
     }
 
-    const UChar* data = s.characters();
+    StringImpl::UpconvertedCharacters characters(s.impl());
+    const UChar* data = characters;
     const UChar* end = data + size;
 
     // Skip leading white space.
@@ -410,13 +412,14 @@ static double parseFloat(const UString& s)
     unsigned size = s.length();
 
     if (size == 1) {
-        UChar c = s.characters()[0];
+        UChar c = s[0];
         if (isASCIIDigit(c))
             return c - '0';
         return NaN;
     }
 
-    const UChar* data = s.characters();
+    StringImpl::UpconvertedCharacters characters(s.impl());
+    const UChar* data = characters;
     const UChar* end = data + size;
 
     // Skip leading white space.
@@ -85,7 +85,7 @@ void JSString::resolveRope(ExecState* exec) const
             StringImpl* string = static_cast<StringImpl*>(currentFiber);
             unsigned length = string->length();
             position -= length;
-            StringImpl::copyChars(position, string->characters(), length);
+            string->copyCharactersTo(position, 0, length);
 
             // Was this the last item in the work queue?
             if (workQueue.isEmpty()) {
@@ -151,7 +151,7 @@ JSString* JSString::substringFromRope(ExecState* exec, unsigned substringStart,
 
     if (substringLength == 1) {
         ASSERT(substringFiberCount == 1);
-        UChar c = substringFibers[0].characters()[0];
+        UChar c = substringFibers[0][0];
         if (c <= maxSingleCharacterString)
             return globalData->smallStrings.singleCharacterString(globalData, c);
     }
@@ -153,6 +153,15 @@ bool StringPrototype::getOwnPropertyDescriptor(ExecState* exec, const Identifier
 
 // ------------------------------ Functions --------------------------
 
+static inline void appendCharacters(Vector<UChar>& buffer, const UString& string, unsigned start, unsigned length)
+{
+    if (!length)
+        return;
+    size_t oldSize = buffer.size();
+    buffer.grow(oldSize + length);
+    string.impl()->copyCharactersTo(buffer.data() + oldSize, start, length);
+}
+
 static NEVER_INLINE UString substituteBackreferencesSlow(const UString& replacement, const UString& source, const int* ovector, RegExp* reg, size_t i)
 {
     Vector<UChar> substitutedReplacement;
@@ -165,7 +174,7 @@ static NEVER_INLINE UString substituteBackreferencesSlow(const UString& replacem
         if (ref == '$') {
             // "$$" -> "$"
             ++i;
-            substitutedReplacement.append(replacement.characters() + offset, i - offset);
+            appendCharacters(substitutedReplacement, replacement, offset, i - offset);
             offset = i + 1;
             continue;
         }
@@ -205,15 +214,15 @@ static NEVER_INLINE UString substituteBackreferencesSlow(const UString& replacem
             continue;
 
         if (i - offset)
-            substitutedReplacement.append(replacement.characters() + offset, i - offset);
+            appendCharacters(substitutedReplacement, replacement, offset, i - offset);
         i += 1 + advance;
         offset = i + 1;
         if (backrefStart >= 0)
-            substitutedReplacement.append(source.characters() + backrefStart, backrefLength);
+            appendCharacters(substitutedReplacement, source, backrefStart, backrefLength);
     } while ((i = replacement.find('$', i + 1)) != notFound);
 
     if (replacement.length() - offset)
-        substitutedReplacement.append(replacement.characters() + offset, replacement.length() - offset);
+        appendCharacters(substitutedReplacement, replacement, offset, replacement.length() - offset);
 
     substitutedReplacement.shrinkToFit();
     return UString::adopt(substitutedReplacement);
@@ -279,13 +288,13 @@ static ALWAYS_INLINE JSValue jsSpliceSubstringsWithSeparators(ExecState* exec, J
     for (int i = 0; i < maxCount; i++) {
         if (i < rangeCount) {
             if (int srcLen = substringRanges[i].length) {
-                StringImpl::copyChars(buffer + bufferPos, source.characters() + substringRanges[i].position, srcLen);
+                source.impl()->copyCharactersTo(buffer + bufferPos, substringRanges[i].position, srcLen);
                 bufferPos += srcLen;
             }
         }
         if (i < separatorCount) {
             if (int sepLen = separators[i].length()) {
-                StringImpl::copyChars(buffer + bufferPos, separators[i].characters(), sepLen);
+                separators[i].impl()->copyCharactersTo(buffer + bufferPos, 0, sepLen);
                 bufferPos += sepLen;
             }
         }
@@ -512,7 +521,7 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncCharCodeAt(ExecState* exec)
     if (a0.isUInt32()) {
         uint32_t i = a0.asUInt32();
         if (i < len)
-            return JSValue::encode(jsNumber(s.characters()[i]));
+            return JSValue::encode(jsNumber(s[i]));
         return JSValue::encode(jsNaN());
     }
     double dpos = a0.toInteger(exec);
@@ -859,7 +868,7 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncToLowerCase(ExecState* exec)
     if (!sSize)
         return JSValue::encode(sVal);
 
-    const UChar* sData = s.characters();
+    StringImpl::UpconvertedCharacters sData(s.impl());
     Vector<UChar> buffer(sSize);
 
     UChar ored = 0;
@@ -899,7 +908,7 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncToUpperCase(ExecState* exec)
     if (!sSize)
         return JSValue::encode(sVal);
 
-    const UChar* sData = s.characters();
+    StringImpl::UpconvertedCharacters sData(s.impl());
     Vector<UChar> buffer(sSize);
 
     UChar ored = 0;
@@ -1041,7 +1050,8 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncFontsize(ExecState* exec)
         buffer[12] = '0' + smallInteger;
         buffer[13] = '"';
         buffer[14] = '>';
-        memcpy(&buffer[15], s.characters(), stringSize * sizeof(UChar));
+        if (stringSize)
+            s.impl()->copyCharactersTo(&buffer[15], 0, stringSize);
         buffer[15 + stringSize] = '<';
         buffer[16 + stringSize] = '/';
         buffer[17 + stringSize] = 'f';
@@ -1086,10 +1096,12 @@ EncodedJSValue JSC_HOST_CALL stringProtoFuncLink(ExecState* exec)
     buffer[6] = 'f';
     buffer[7] = '=';
     buffer[8] = '"';
-    memcpy(&buffer[9], linkText.characters(), linkTextSize * sizeof(UChar));
+    if (linkTextSize)
+        linkText.impl()->copyCharactersTo(&buffer[9], 0, linkTextSize);
     buffer[9 + linkTextSize] = '"';
     buffer[10 + linkTextSize] = '>';
-    memcpy(&buffer[11 + linkTextSize], s.characters(), stringSize * sizeof(UChar));
+    if (stringSize)
+        s.impl()->copyCharactersTo(&buffer[11 + linkTextSize], 0, stringSize);
     buffer[11 + linkTextSize + stringSize] = '<';
     buffer[12 + linkTextSize + stringSize] = '/';
     buffer[13 + linkTextSize + stringSize] = 'a';
@@ -221,54 +221,26 @@ bool operator==(const UString& s1, const char *s2)
     if (s2 == 0)
         return s1.isEmpty();
 
-    const UChar* u = s1.characters();
-    const UChar* uend = u + s1.length();
-    while (u != uend && *s2) {
-        if (u[0] != (unsigned char)*s2)
+    unsigned length = s1.length();
+    unsigned i = 0;
+    while (i != length && *s2) {
+        if (s1[i] != (unsigned char)*s2)
             return false;
         s2++;
-        u++;
+        i++;
     }
 
-    return u == uend && *s2 == 0;
+    return i == length && *s2 == 0;
 }
 
 bool operator<(const UString& s1, const UString& s2)
 {
-    const unsigned l1 = s1.length();
-    const unsigned l2 = s2.length();
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.characters();
-    const UChar* c2 = s2.characters();
-    unsigned l = 0;
-    while (l < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        l++;
-    }
-    if (l < lmin)
-        return (c1[0] < c2[0]);
-
-    return (l1 < l2);
+    return codePointCompare(s1, s2) < 0;
 }
 
 bool operator>(const UString& s1, const UString& s2)
 {
-    const unsigned l1 = s1.length();
-    const unsigned l2 = s2.length();
-    const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1.characters();
-    const UChar* c2 = s2.characters();
-    unsigned l = 0;
-    while (l < lmin && *c1 == *c2) {
-        c1++;
-        c2++;
-        l++;
-    }
-    if (l < lmin)
-        return (c1[0] > c2[0]);
-
-    return (l1 > l2);
+    return codePointCompare(s1, s2) > 0;
 }
 
 CString UString::ascii() const
@@ -277,13 +249,12 @@ CString UString::ascii() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
     for (unsigned i = 0; i < length; ++i) {
-        UChar ch = characters[i];
+        UChar ch = (*m_impl)[i];
         characterBuffer[i] = ch && (ch < 0x20 || ch >= 0x7f) ? '?' : ch;
     }
 
@@ -296,11 +267,16 @@ CString UString::latin1() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
+    if (length && m_impl->is8Bit()) {
+        memcpy(characterBuffer, m_impl->characters8(), length);
+        return result;
+    }
+
+    const UChar* characters = this->characters();
     for (unsigned i = 0; i < length; ++i) {
         UChar ch = characters[i];
         characterBuffer[i] = ch > 0xff ? '?' : ch;
@@ -321,6 +297,26 @@ static inline void putUTF8Triple(char*& buffer, UChar ch)
 CString UString::utf8(bool strict) const
 {
     unsigned length = this->length();
+
+    if (length && m_impl->is8Bit()) {
+        // Latin-1 characters take at most two UTF-8 bytes.
+        if (length > numeric_limits<unsigned>::max() / 2)
+            return CString();
+        Vector<char, 1024> bufferVector(length * 2);
+        char* buffer = bufferVector.data();
+        const LChar* characters = m_impl->characters8();
+        for (unsigned i = 0; i < length; ++i) {
+            LChar ch = characters[i];
+            if (ch < 0x80)
+                *buffer++ = ch;
+            else {
+                *buffer++ = static_cast<char>((ch >> 6) | 0xC0);
+                *buffer++ = static_cast<char>((ch & 0x3F) | 0x80);
+            }
+        }
+        return CString(bufferVector.data(), buffer - bufferVector.data());
+    }
+
     const UChar* characters = this->characters();
 
     // Allocate a buffer big enough to hold all the characters
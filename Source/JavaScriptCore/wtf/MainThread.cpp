@@ -44,11 +44,13 @@ struct FunctionWithContext {
     MainThreadFunction* function;
     void* context;
     ThreadCondition* syncFlag;
+    double queueTime;
 
-    FunctionWithContext(MainThreadFunction* function = 0, void* context = 0, ThreadCondition* syncFlag = 0)
+    FunctionWithContext(MainThreadFunction* function = 0, void* context = 0, ThreadCondition* syncFlag = 0, double queueTime = 0)
         : function(function)
         , context(context)
         , syncFlag(syncFlag)
+        , queueTime(queueTime)
     { 
     }
     bool operator == (const FunctionWithContext& o)
@@ -69,6 +71,22 @@ public:
 
 typedef Deque<FunctionWithContext> FunctionQueue;
 
+struct FunctionQueues {
+    FunctionQueues() : pendingFunctions(0) { }
+
+    FunctionQueue lanes[MainThreadPriorityCount];
+    MainThreadLaneStatistics statistics[MainThreadPriorityCount];
+    unsigned pendingFunctions;
+};
+
+// How long the oldest function of a lane may wait before it runs ahead of the lanes above it.
+static const double maxLaneLatency[MainThreadPriorityCount] = { 0, 0.1, 0.2, 1 };
+
+// 0.1 sec delays in UI is approximate threshold when they become noticeable. Keep running functions
+// for at most half of that, and for less when only lower priority functions are left, so that user
+// input waiting in the run loop is not held up by background work.
+static const double maxLaneRunLoopSuspensionTime[MainThreadPriorityCount] = { 0.05, 0.05, 0.02, 0.005 };
+
 static bool callbacksPaused; // This global variable is only accessed from main thread.
 #if !PLATFORM(MAC) && !PLATFORM(QT)
 static ThreadIdentifier mainThreadIdentifier;
@@ -80,10 +98,37 @@ static Mutex& mainThreadFunctionQueueMutex()
     return staticMutex;
 }
 
-static FunctionQueue& functionQueue()
+static FunctionQueues& functionQueues()
 {
-    DEFINE_STATIC_LOCAL(FunctionQueue, staticFunctionQueue, ());
-    return staticFunctionQueue;
+    DEFINE_STATIC_LOCAL(FunctionQueues, staticFunctionQueues, ());
+    return staticFunctionQueues;
+}
+
+// Must be called with mainThreadFunctionQueueMutex() held. Returns true if no functions were pending.
+static bool enqueueFunction(const FunctionWithContext& invocation, MainThreadPriority priority)
+{
+    ASSERT(priority < MainThreadPriorityCount);
+    FunctionQueues& queues = functionQueues();
+    queues.lanes[priority].append(invocation);
+    return !queues.pendingFunctions++;
+}
+
+// Must be called with mainThreadFunctionQueueMutex() held and functions pending.
+static MainThreadPriority nextLane(double now)
+{
+    FunctionQueues& queues = functionQueues();
+    ASSERT(queues.pendingFunctions);
+
+    for (unsigned lane = MainThreadRenderingPriority; lane < MainThreadPriorityCount; ++lane) {
+        if (!queues.lanes[lane].isEmpty() && now - queues.lanes[lane].first().queueTime > maxLaneLatency[lane])
+            return static_cast<MainThreadPriority>(lane);
+    }
+
+    unsigned lane = 0;
+    while (queues.lanes[lane].isEmpty())
+        ++lane;
+    ASSERT(lane < MainThreadPriorityCount);
+    return static_cast<MainThreadPriority>(lane);
 }
 
 
@@ -131,9 +176,6 @@ void initializeMainThreadToProcessMainThread()
 }
 #endif
 
-// 0.1 sec delays in UI is approximate threshold when they become noticeable. Have a limit that's half of that.
-static const double maxRunLoopSuspensionTime = 0.05;
-
 void dispatchFunctionsFromMainThread()
 {
     ASSERT(isMainThread());
@@ -147,34 +189,52 @@ void dispatchFunctionsFromMainThread()
     while (true) {
         {
             MutexLocker locker(mainThreadFunctionQueueMutex());
-            if (!functionQueue().size())
+            FunctionQueues& queues = functionQueues();
+            if (!queues.pendingFunctions)
                 break;
-            invocation = functionQueue().takeFirst();
+
+            double now = currentTime();
+            MainThreadPriority lane = nextLane(now);
+
+            // If we are running accumulated functions for too long so UI may become unresponsive, we need to
+            // yield so the user input can be processed. Otherwise user may not be able to even close the window.
+            // This code has effect only in case the scheduleDispatchFunctionsOnMainThread() is implemented in a way that
+            // allows input events to be processed before we are back here.
+            if (now - startTime > maxLaneRunLoopSuspensionTime[lane]) {
+                scheduleDispatchFunctionsOnMainThread();
+                break;
+            }
+
+            invocation = queues.lanes[lane].takeFirst();
+            --queues.pendingFunctions;
+
+            MainThreadLaneStatistics& statistics = queues.statistics[lane];
+            double latency = now - invocation.queueTime;
+            ++statistics.dispatchedFunctions;
+            statistics.totalLatency += latency;
+            if (latency > statistics.maxLatency)
+                statistics.maxLatency = latency;
         }
 
         invocation.function(invocation.context);
         if (invocation.syncFlag)
             invocation.syncFlag->signal();
-
-        // If we are running accumulated functions for too long so UI may become unresponsive, we need to
-        // yield so the user input can be processed. Otherwise user may not be able to even close the window.
-        // This code has effect only in case the scheduleDispatchFunctionsOnMainThread() is implemented in a way that
-        // allows input events to be processed before we are back here.
-        if (currentTime() - startTime > maxRunLoopSuspensionTime) {
-            scheduleDispatchFunctionsOnMainThread();
-            break;
-        }
     }
 }
 
 void callOnMainThread(MainThreadFunction* function, void* context)
+{
+    callOnMainThread(function, context, MainThreadLoadingPriority);
+}
+
+void callOnMainThread(MainThreadFunction* function, void* context, MainThreadPriority priority)
 {
     ASSERT(function);
+    double queueTime = currentTime();
     bool needToSchedule = false;
     {
         MutexLocker locker(mainThreadFunctionQueueMutex());
-        needToSchedule = functionQueue().size() == 0;
-        functionQueue().append(FunctionWithContext(function, context));
+        needToSchedule = enqueueFunction(FunctionWithContext(function, context, 0, queueTime), priority);
     }
     if (needToSchedule)
         scheduleDispatchFunctionsOnMainThread();
@@ -189,11 +249,12 @@ void callOnMainThreadAndWait(MainThreadFunction* function, void* context)
         return;
     }
 
+    // Callers rely on the function running after everything they queued with callOnMainThread()
+    // before the call, so it goes into the default lane rather than ahead of it.
     ThreadCondition syncFlag;
     Mutex& functionQueueMutex = mainThreadFunctionQueueMutex();
     MutexLocker locker(functionQueueMutex);
-    functionQueue().append(FunctionWithContext(function, context, &syncFlag));
-    if (functionQueue().size() == 1)
+    if (enqueueFunction(FunctionWithContext(function, context, &syncFlag, currentTime()), MainThreadLoadingPriority))
         scheduleDispatchFunctionsOnMainThread();
     syncFlag.wait(functionQueueMutex);
 }
@@ -206,16 +267,37 @@ void cancelCallOnMainThread(MainThreadFunction* function, void* context)
 
     FunctionWithContextFinder pred(FunctionWithContext(function, context));
 
-    while (true) {
-        // We must redefine 'i' each pass, because the itererator's operator= 
-        // requires 'this' to be valid, and remove() invalidates all iterators
-        FunctionQueue::iterator i(functionQueue().findIf(pred));
-        if (i == functionQueue().end())
-            break;
-        functionQueue().remove(i);
+    FunctionQueues& queues = functionQueues();
+    for (unsigned lane = 0; lane < MainThreadPriorityCount; ++lane) {
+        while (true) {
+            // We must redefine 'i' each pass, because the itererator's operator= 
+            // requires 'this' to be valid, and remove() invalidates all iterators
+            FunctionQueue::iterator i(queues.lanes[lane].findIf(pred));
+            if (i == queues.lanes[lane].end())
+                break;
+            queues.lanes[lane].remove(i);
+            --queues.pendingFunctions;
+        }
     }
 }
 
+MainThreadLaneStatistics mainThreadLaneStatistics(MainThreadPriority priority)
+{
+    ASSERT(priority < MainThreadPriorityCount);
+
+    MutexLocker locker(mainThreadFunctionQueueMutex());
+    MainThreadLaneStatistics statistics = functionQueues().statistics[priority];
+    statistics.pendingFunctions = functionQueues().lanes[priority].size();
+    return statistics;
+}
+
+void resetMainThreadLaneStatistics()
+{
+    MutexLocker locker(mainThreadFunctionQueueMutex());
+    for (unsigned lane = 0; lane < MainThreadPriorityCount; ++lane)
+        functionQueues().statistics[lane] = MainThreadLaneStatistics();
+}
+
 void setMainThreadCallbacksPaused(bool paused)
 {
     ASSERT(isMainThread());
@@ -37,13 +37,45 @@ namespace WTF {
 typedef uint32_t ThreadIdentifier;
 typedef void MainThreadFunction(void*);
 
+// Functions called on the main thread are queued in one lane per priority. Each dispatch runs the
+// oldest function of the highest priority non-empty lane, unless a lower lane's oldest function has
+// been waiting longer than that lane allows. Lower lanes also yield to the run loop sooner.
+enum MainThreadPriority {
+    MainThreadInputPriority,
+    MainThreadRenderingPriority,
+    MainThreadLoadingPriority,
+    MainThreadIdlePriority,
+    MainThreadPriorityCount
+};
+
+struct MainThreadLaneStatistics {
+    MainThreadLaneStatistics()
+        : pendingFunctions(0)
+        , dispatchedFunctions(0)
+        , totalLatency(0)
+        , maxLatency(0)
+    {
+    }
+
+    unsigned pendingFunctions;
+    unsigned long long dispatchedFunctions;
+    double totalLatency; // Seconds between queueing and dispatch, summed over dispatched functions.
+    double maxLatency;
+};
+
 // Must be called from the main thread.
 void initializeMainThread();
 
+// Functions queued without a priority go into the loading lane.
 void callOnMainThread(MainThreadFunction*, void* context);
+void callOnMainThread(MainThreadFunction*, void* context, MainThreadPriority);
+// Runs in the loading lane, after the functions the caller queued there before it.
 void callOnMainThreadAndWait(MainThreadFunction*, void* context);
 void cancelCallOnMainThread(MainThreadFunction*, void* context);
 
+MainThreadLaneStatistics mainThreadLaneStatistics(MainThreadPriority);
+void resetMainThreadLaneStatistics();
+
 void setMainThreadCallbacksPaused(bool paused);
 
 bool isMainThread();
@@ -63,6 +95,11 @@ void initializeMainThreadToProcessMainThreadPlatform();
 
 } // namespace WTF
 
+using WTF::MainThreadPriority;
+using WTF::MainThreadInputPriority;
+using WTF::MainThreadRenderingPriority;
+using WTF::MainThreadLoadingPriority;
+using WTF::MainThreadIdlePriority;
 using WTF::callOnMainThread;
 using WTF::callOnMainThreadAndWait;
 using WTF::cancelCallOnMainThread;
@@ -745,6 +745,9 @@
 // Enable scrollable divs in separate layers.  This might be upstreamed to
 // webkit.org but for now, it is just an Android feature.
 #define ENABLE_ANDROID_OVERFLOW_SCROLL 1
+// Keep the encoded data of dead scripts and style sheets zlib-compressed in the
+// memory cache instead of evicting it.
+#define ENABLE_COMPRESSED_RESOURCE_DATA 1
 
 // Other Android guards not present upstream
 #define ANDROID_FLATTEN_FRAMESET
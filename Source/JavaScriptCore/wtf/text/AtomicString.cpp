@@ -35,6 +35,10 @@ using namespace Unicode;
 
 COMPILE_ASSERT(sizeof(AtomicString) == sizeof(String), atomic_string_and_string_must_be_same_size);
 
+// Each thread has its own table, so atomic strings can only be compared by pointer on the
+// thread that made them. Sharing one table between threads would also need StringImpl ref
+// counts to be atomic for the shared strings, which would slow down ref() and deref() for
+// every string; strings passed between threads go through crossThreadString() instead.
 class AtomicStringTable {
 public:
     static AtomicStringTable* create()
@@ -93,7 +97,15 @@ struct CStringTranslator {
     static bool equal(StringImpl* r, const char* s)
     {
         int length = r->length();
-        const UChar* d = r->characters();
+        if (r->is8Bit()) {
+            const LChar* d = r->characters8();
+            for (int i = 0; i != length; ++i) {
+                if (d[i] != static_cast<LChar>(s[i]))
+                    return false;
+            }
+            return !s[length];
+        }
+        const UChar* d = r->characters16();
         for (int i = 0; i != length; ++i) {
             unsigned char c = s[i];
             if (d[i] != c)
@@ -113,9 +125,10 @@ struct CStringTranslator {
 bool operator==(const AtomicString& a, const char* b)
 { 
     StringImpl* impl = a.impl();
-    if ((!impl || !impl->characters()) && !b)
+    bool isNull = !impl || (!impl->is8Bit() && !impl->characters());
+    if (isNull && !b)
         return true;
-    if ((!impl || !impl->characters()) || !b)
+    if (isNull || !b)
         return false;
     return CStringTranslator::equal(impl, b); 
 }
@@ -140,10 +153,13 @@ static inline bool equal(StringImpl* string, const UChar* characters, unsigned l
     if (string->length() != length)
         return false;
 
+    if (string->is8Bit())
+        return WTF::equal(string->characters8(), characters, length);
+
     // FIXME: perhaps we should have a more abstract macro that indicates when
     // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS) || CPU(SPARC)
-    const UChar* stringCharacters = string->characters();
+    const UChar* stringCharacters = string->characters16();
     for (unsigned i = 0; i != length; ++i) {
         if (*stringCharacters++ != *characters++)
             return false;
@@ -152,7 +168,7 @@ static inline bool equal(StringImpl* string, const UChar* characters, unsigned l
 #else
     /* Do it 4-bytes-at-a-time on architectures where it's safe */
 
-    const uint32_t* stringCharacters = reinterpret_cast<const uint32_t*>(string->characters());
+    const uint32_t* stringCharacters = reinterpret_cast<const uint32_t*>(string->characters16());
     const uint32_t* bufferCharacters = reinterpret_cast<const uint32_t*>(characters);
 
     unsigned halfLength = length >> 1;
@@ -186,7 +202,7 @@ struct UCharBufferTranslator {
 
     static void translate(StringImpl*& location, const UCharBuffer& buf, unsigned hash)
     {
-        location = StringImpl::create(buf.s, buf.length).leakRef();
+        location = StringImpl::create8BitIfPossible(buf.s, buf.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -212,7 +228,7 @@ struct HashAndCharactersTranslator {
 
     static void translate(StringImpl*& location, const HashAndCharacters& buffer, unsigned hash)
     {
-        location = StringImpl::create(buffer.characters, buffer.length).leakRef();
+        location = StringImpl::create8BitIfPossible(buffer.characters, buffer.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -236,11 +252,15 @@ struct HashAndUTF8CharactersTranslator {
         if (buffer.utf16Length != string->length())
             return false;
 
-        const UChar* stringCharacters = string->characters();
+        // An 8-bit string can only match an all-ASCII buffer without widening.
+        if (string->is8Bit() && buffer.utf16Length == buffer.length)
+            return !memcmp(string->characters8(), buffer.characters, buffer.length);
+
+        StringImpl::UpconvertedCharacters stringCharacters(string);
 
         // If buffer contains only ASCII characters UTF-8 and UTF16 length are the same.
         if (buffer.utf16Length != buffer.length)
-            return equalUTF16WithUTF8(stringCharacters, stringCharacters + string->length(), buffer.characters, buffer.characters + buffer.length);
+            return equalUTF16WithUTF8(stringCharacters.get(), stringCharacters.get() + string->length(), buffer.characters, buffer.characters + buffer.length);
 
         for (unsigned i = 0; i < buffer.length; ++i) {
             ASSERT(isASCII(buffer.characters[i]));
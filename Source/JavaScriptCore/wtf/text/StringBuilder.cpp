@@ -62,7 +62,7 @@ void StringBuilder::resize(unsigned newSize)
     // If there is a buffer, we only need to duplicate it if it has more than one ref.
     if (m_buffer) {
         if (!m_buffer->hasOneRef())
-            allocateBuffer(m_buffer->characters(), m_buffer->length());
+            allocateBuffer(m_buffer.get(), m_buffer->length());
         m_length = newSize;
         m_string = String();
         return;
@@ -81,21 +81,22 @@ void StringBuilder::reserveCapacity(unsigned newCapacity)
     if (m_buffer) {
         // If there is already a buffer, then grow if necessary.
         if (newCapacity > m_buffer->length())
-            allocateBuffer(m_buffer->characters(), newCapacity);
+            allocateBuffer(m_buffer.get(), newCapacity);
     } else {
         // Grow the string, if necessary.
         if (newCapacity > m_length)
-            allocateBuffer(m_string.characters(), newCapacity);
+            allocateBuffer(m_string.impl(), newCapacity);
     }
 }
 
 // Allocate a new buffer, copying in currentCharacters (these may come from either m_string
 // or m_buffer,  neither will be reassigned until the copy has completed).
-void StringBuilder::allocateBuffer(const UChar* currentCharacters, unsigned requiredLength)
+void StringBuilder::allocateBuffer(const StringImpl* currentCharacters, unsigned requiredLength)
 {
     // Copy the existing data into a new buffer, set result to point to the end of the existing data.
     RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters);
-    memcpy(m_bufferCharacters, currentCharacters, static_cast<size_t>(m_length) * sizeof(UChar)); // This can't overflow.
+    if (m_length)
+        currentCharacters->copyCharactersTo(m_bufferCharacters, 0, m_length);
 
     // Update the builder state.
     m_buffer = buffer.release();
@@ -126,10 +127,10 @@ UChar* StringBuilder::appendUninitialized(unsigned length)
         }
 
         // We need to realloc the buffer.
-        allocateBuffer(m_buffer->characters(), std::max(requiredLength, m_buffer->length() * 2));
+        allocateBuffer(m_buffer.get(), std::max(requiredLength, m_buffer->length() * 2));
     } else {
         ASSERT(m_string.length() == m_length);
-        allocateBuffer(m_string.characters(), std::max(requiredLength, requiredLength * 2));
+        allocateBuffer(m_string.impl(), std::max(requiredLength, requiredLength * 2));
     }
 
     UChar* result = m_bufferCharacters + m_length;
@@ -51,6 +51,10 @@ public:
             m_length = string.length();
             return;
         }
+        if (string.is8Bit()) {
+            append(reinterpret_cast<const char*>(string.impl()->characters8()), string.length());
+            return;
+        }
         append(string.characters(), string.length());
     }
 
@@ -122,7 +126,7 @@ public:
     }
 
 private:
-    void allocateBuffer(const UChar* currentCharacters, unsigned requiredLength);
+    void allocateBuffer(const StringImpl* currentCharacters, unsigned requiredLength);
     UChar* appendUninitialized(unsigned length);
     void reifyString();
 
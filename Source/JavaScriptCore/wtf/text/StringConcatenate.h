@@ -174,10 +174,9 @@ public:
 
     void writeTo(UChar* destination)
     {
-        const UChar* data = m_buffer.characters();
         unsigned length = m_buffer.length();
-        for (unsigned i = 0; i < length; ++i)
-            destination[i] = data[i];
+        if (length)
+            m_buffer.impl()->copyCharactersTo(destination, 0, length);
     }
 
 private:
@@ -53,11 +53,15 @@ namespace WTF {
             if (aLength != bLength)
                 return false;
 
+            // Compare 8-bit strings without widening them.
+            if (a->is8Bit() || b->is8Bit())
+                return equalWithMixedWidths(a, b, aLength);
+
             // FIXME: perhaps we should have a more abstract macro that indicates when
             // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS)
-            const UChar* aChars = a->characters();
-            const UChar* bChars = b->characters();
+            const UChar* aChars = a->characters16();
+            const UChar* bChars = b->characters16();
             for (unsigned i = 0; i != aLength; ++i) {
                 if (*aChars++ != *bChars++)
                     return false;
@@ -65,8 +69,8 @@ namespace WTF {
             return true;
 #else
             /* Do it 4-bytes-at-a-time on architectures where it's safe */
-            const uint32_t* aChars = reinterpret_cast<const uint32_t*>(a->characters());
-            const uint32_t* bChars = reinterpret_cast<const uint32_t*>(b->characters());
+            const uint32_t* aChars = reinterpret_cast<const uint32_t*>(a->characters16());
+            const uint32_t* bChars = reinterpret_cast<const uint32_t*>(b->characters16());
 
             unsigned halfLength = aLength >> 1;
             for (unsigned i = 0; i != halfLength; ++i)
@@ -109,7 +113,9 @@ namespace WTF {
 
         static unsigned hash(StringImpl* str)
         {
-            return hash(str->characters(), str->length());
+            if (str->is8Bit())
+                return StringHasher::computeHash<LChar, foldCase<LChar> >(str->characters8(), str->length());
+            return hash(str->characters16(), str->length());
         }
 
         static unsigned hash(const char* data, unsigned length)
@@ -126,7 +132,16 @@ namespace WTF {
             unsigned length = a->length();
             if (length != b->length())
                 return false;
-            return WTF::Unicode::umemcasecmp(a->characters(), b->characters(), length) == 0;
+            if (a->is8Bit() || b->is8Bit()) {
+                for (unsigned i = 0; i != length; ++i) {
+                    UChar aCharacter = a->is8Bit() ? a->characters8()[i] : a->characters16()[i];
+                    UChar bCharacter = b->is8Bit() ? b->characters8()[i] : b->characters16()[i];
+                    if (foldCase(aCharacter) != foldCase(bCharacter))
+                        return false;
+                }
+                return true;
+            }
+            return WTF::Unicode::umemcasecmp(a->characters16(), b->characters16(), length) == 0;
         }
 
         static unsigned hash(const RefPtr<StringImpl>& key) 
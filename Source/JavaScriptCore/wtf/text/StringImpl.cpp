@@ -31,6 +31,10 @@
 #include <wtf/StdLibExtras.h>
 #include <wtf/WTFThreadData.h>
 
+#if STRING_STATS
+#include <stdio.h>
+#endif
+
 using namespace std;
 
 namespace WTF {
@@ -41,6 +45,47 @@ static const unsigned minLengthToShare = 20;
 
 COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 3 * sizeof(void*), StringImpl_should_stay_small);
 
+#if STRING_STATS
+static unsigned s_live8BitStrings;
+static unsigned s_live8BitCharacters;
+static unsigned s_liveUpconvertedCopies;
+static unsigned s_liveUpconvertedCharacters;
+static unsigned s_totalUpconvertedCopies;
+
+void StringStats::add8BitString(unsigned length)
+{
+    ++s_live8BitStrings;
+    s_live8BitCharacters += length;
+}
+
+void StringStats::remove8BitString(unsigned length, bool hadUpconvertedCopy)
+{
+    --s_live8BitStrings;
+    s_live8BitCharacters -= length;
+    if (hadUpconvertedCopy) {
+        --s_liveUpconvertedCopies;
+        s_liveUpconvertedCharacters -= length;
+    }
+}
+
+void StringStats::addUpconvertedCopy(unsigned length)
+{
+    ++s_liveUpconvertedCopies;
+    s_liveUpconvertedCharacters += length;
+    ++s_totalUpconvertedCopies;
+}
+
+void StringStats::printStats()
+{
+    // Each 8-bit character saves one byte over UTF-16; each upconverted copy costs two bytes a character.
+    long long saved = static_cast<long long>(s_live8BitCharacters) - 2LL * s_liveUpconvertedCharacters;
+    printf("8-bit strings: %u live holding %u characters\n", s_live8BitStrings, s_live8BitCharacters);
+    printf("UTF-16 copies of 8-bit strings: %u live holding %u characters, %u made in total\n",
+        s_liveUpconvertedCopies, s_liveUpconvertedCharacters, s_totalUpconvertedCopies);
+    printf("Bytes saved over storing every string as UTF-16: %lld\n", saved);
+}
+#endif
+
 StringImpl::~StringImpl()
 {
     ASSERT(!isStatic());
@@ -54,6 +99,16 @@ StringImpl::~StringImpl()
     }
 #endif
 
+    if (is8Bit()) {
+        ASSERT(bufferOwnership() == BufferInternal);
+#if STRING_STATS
+        StringStats::remove8BitString(m_length, m_buffer);
+#endif
+        if (m_buffer)
+            fastFree(m_buffer);
+        return;
+    }
+
     BufferOwnership ownership = bufferOwnership();
     if (ownership != BufferInternal) {
         if (ownership == BufferOwned) {
@@ -90,6 +145,27 @@ PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, UChar*&
     return adoptRef(new (string) StringImpl(length));
 }
 
+PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, LChar*& data)
+{
+    if (!length) {
+        data = 0;
+        return empty();
+    }
+
+    // Allocate a single buffer large enough to contain the StringImpl
+    // struct as well as the data which it contains.
+    if (length > ((std::numeric_limits<unsigned>::max() - sizeof(StringImpl)) / sizeof(LChar)))
+        CRASH();
+    size_t size = sizeof(StringImpl) + length * sizeof(LChar);
+    StringImpl* string = static_cast<StringImpl*>(fastMalloc(size));
+
+    data = reinterpret_cast<LChar*>(string + 1);
+#if STRING_STATS
+    StringStats::add8BitString(length);
+#endif
+    return adoptRef(new (string) StringImpl(length, Force8BitConstructor));
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
@@ -101,20 +177,55 @@ PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned leng
     return string.release();
 }
 
+PassRefPtr<StringImpl> StringImpl::create(const LChar* characters, unsigned length)
+{
+    if (!characters || !length)
+        return empty();
+
+    LChar* data;
+    RefPtr<StringImpl> string = createUninitialized(length, data);
+    memcpy(data, characters, length * sizeof(LChar));
+    return string.release();
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const char* characters, unsigned length)
+{
+    return create(reinterpret_cast<const LChar*>(characters), length);
+}
+
+PassRefPtr<StringImpl> StringImpl::create8BitIfPossible(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
         return empty();
 
-    UChar* data;
+    LChar* data;
     RefPtr<StringImpl> string = createUninitialized(length, data);
     for (unsigned i = 0; i != length; ++i) {
-        unsigned char c = characters[i];
-        data[i] = c;
+        UChar c = characters[i];
+        if (c > 0xFF)
+            return create(characters, length);
+        data[i] = static_cast<LChar>(c);
     }
     return string.release();
 }
 
+const UChar* StringImpl::cacheUpconvertedCharacters() const
+{
+    ASSERT(is8Bit());
+    ASSERT(!m_buffer);
+    // Like the ref count, the copy is only ever touched by the thread that owns the string.
+    // Static strings, which are used by every thread, are never 8-bit.
+    ASSERT(!isStatic());
+
+    UChar* data = static_cast<UChar*>(fastMalloc(m_length * sizeof(UChar)));
+    copyChars(data, m_data8, m_length);
+#if STRING_STATS
+    StringStats::addUpconvertedCopy(m_length);
+#endif
+    const_cast<StringImpl*>(this)->m_buffer = data;
+    return data;
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const char* string)
 {
     if (!string)
@@ -161,6 +272,12 @@ bool StringImpl::containsOnlyWhitespace()
     // FIXME: The definition of whitespace here includes a number of characters
     // that are not whitespace from the point of view of RenderText; I wonder if
     // that's a problem in practice.
+    if (is8Bit()) {
+        for (unsigned i = 0; i < m_length; i++)
+            if (!isASCIISpace(m_data8[i]))
+                return false;
+        return true;
+    }
     for (unsigned i = 0; i < m_length; i++)
         if (!isASCIISpace(m_data[i]))
             return false;
@@ -177,11 +294,15 @@ PassRefPtr<StringImpl> StringImpl::substring(unsigned start, unsigned length)
             return this;
         length = maxLength;
     }
+    if (is8Bit())
+        return create(m_data8 + start, length);
     return create(m_data + start, length);
 }
 
 UChar32 StringImpl::characterStartingAt(unsigned i)
 {
+    if (is8Bit())
+        return m_data8[i];
     if (U16_IS_SINGLE(m_data[i]))
         return m_data[i];
     if (i + 1 < m_length && U16_IS_LEAD(m_data[i]) && U16_IS_TRAIL(m_data[i + 1]))
@@ -195,10 +316,30 @@ PassRefPtr<StringImpl> StringImpl::lower()
     // no-op code path up through the first 'return' statement.
     
     // First scan the string for uppercase and non-ASCII characters:
+    if (is8Bit()) {
+        LChar ored = 0;
+        bool noUpper = true;
+        for (unsigned i = 0; i < m_length; ++i) {
+            if (UNLIKELY(isASCIIUpper(m_data8[i])))
+                noUpper = false;
+            ored |= m_data8[i];
+        }
+        if (!(ored & ~0x7F)) {
+            if (noUpper)
+                return this;
+            LChar* data8;
+            RefPtr<StringImpl> newImpl = createUninitialized(m_length, data8);
+            for (unsigned i = 0; i < m_length; ++i)
+                data8[i] = toASCIILower(m_data8[i]);
+            return newImpl.release();
+        }
+    }
+
+    UpconvertedCharacters characters(this);
     UChar ored = 0;
     bool noUpper = true;
-    const UChar *end = m_data + m_length;
-    for (const UChar* chp = m_data; chp != end; chp++) {
+    const UChar *end = characters + m_length;
+    for (const UChar* chp = characters; chp != end; chp++) {
         if (UNLIKELY(isASCIIUpper(*chp)))
             noUpper = false;
         ored |= *chp;
@@ -218,7 +359,7 @@ PassRefPtr<StringImpl> StringImpl::lower()
     if (!(ored & ~0x7F)) {
         // Do a faster loop for the case where all the characters are ASCII.
         for (int i = 0; i < length; i++) {
-            UChar c = m_data[i];
+            UChar c = characters[i];
             data[i] = toASCIILower(c);
         }
         return newImpl;
@@ -226,11 +367,11 @@ PassRefPtr<StringImpl> StringImpl::lower()
     
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toLower(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toLower(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toLower(data, realLength, m_data, m_length, &error);
+    Unicode::toLower(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl;
@@ -241,6 +382,19 @@ PassRefPtr<StringImpl> StringImpl::upper()
     // This function could be optimized for no-op cases the way lower() is,
     // but in empirical testing, few actual calls to upper() are no-ops, so
     // it wouldn't be worth the extra time for pre-scanning.
+    if (is8Bit()) {
+        LChar ored = 0;
+        for (unsigned i = 0; i < m_length; ++i)
+            ored |= m_data8[i];
+        if (!(ored & ~0x7F)) {
+            LChar* data8;
+            RefPtr<StringImpl> newImpl = createUninitialized(m_length, data8);
+            for (unsigned i = 0; i < m_length; ++i)
+                data8[i] = toASCIIUpper(m_data8[i]);
+            return newImpl.release();
+        }
+    }
+
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
@@ -249,9 +403,10 @@ PassRefPtr<StringImpl> StringImpl::upper()
     int32_t length = m_length;
 
     // Do a faster loop for the case where all the characters are ASCII.
+    UpconvertedCharacters characters(this);
     UChar ored = 0;
     for (int i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIIUpper(c);
     }
@@ -260,11 +415,11 @@ PassRefPtr<StringImpl> StringImpl::upper()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toUpper(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toUpper(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toUpper(data, realLength, m_data, m_length, &error);
+    Unicode::toUpper(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -280,12 +435,25 @@ PassRefPtr<StringImpl> StringImpl::secure(UChar character, LastCharacterBehavior
     unsigned lastCharacterIndex = m_length - 1;
     for (unsigned i = 0; i < lastCharacterIndex; ++i)
         data[i] = character;
-    data[lastCharacterIndex] = (behavior == ObscureLastCharacter) ? character : m_data[lastCharacterIndex];
+    data[lastCharacterIndex] = (behavior == ObscureLastCharacter) ? character : (*this)[lastCharacterIndex];
     return newImpl.release();
 }
 
 PassRefPtr<StringImpl> StringImpl::foldCase()
 {
+    if (is8Bit()) {
+        LChar ored = 0;
+        for (unsigned i = 0; i < m_length; ++i)
+            ored |= m_data8[i];
+        if (!(ored & ~0x7F)) {
+            LChar* data8;
+            RefPtr<StringImpl> newImpl = createUninitialized(m_length, data8);
+            for (unsigned i = 0; i < m_length; ++i)
+                data8[i] = toASCIILower(m_data8[i]);
+            return newImpl.release();
+        }
+    }
+
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
@@ -294,9 +462,10 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
     int32_t length = m_length;
 
     // Do a faster loop for the case where all the characters are ASCII.
+    UpconvertedCharacters characters(this);
     UChar ored = 0;
     for (int32_t i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIILower(c);
     }
@@ -305,26 +474,24 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::foldCase(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::foldCase(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl.release();
     newImpl = createUninitialized(realLength, data);
-    Unicode::foldCase(data, realLength, m_data, m_length, &error);
+    Unicode::foldCase(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
 }
 
-PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
+template<typename CharacterType>
+inline PassRefPtr<StringImpl> StringImpl::stripWhiteSpace(const CharacterType* characters)
 {
-    if (!m_length)
-        return empty();
-
     unsigned start = 0;
     unsigned end = m_length - 1;
     
     // skip white space from start
-    while (start <= end && isSpaceOrNewline(m_data[start]))
+    while (start <= end && isSpaceOrNewline(characters[start]))
         start++;
     
     // only white space
@@ -332,17 +499,28 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
         return empty();
 
     // skip white space from end
-    while (end && isSpaceOrNewline(m_data[end]))
+    while (end && isSpaceOrNewline(characters[end]))
         end--;
 
     if (!start && end == m_length - 1)
         return this;
-    return create(m_data + start, end + 1 - start);
+    return create(characters + start, end + 1 - start);
+}
+
+PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
+{
+    if (!m_length)
+        return empty();
+
+    if (is8Bit())
+        return stripWhiteSpace(m_data8);
+    return stripWhiteSpace(m_data);
 }
 
 PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr findMatch)
 {
-    const UChar* from = m_data;
+    UpconvertedCharacters characters(this);
+    const UChar* from = characters;
     const UChar* fromend = from + m_length;
 
     // Assume the common case will not remove any characters
@@ -353,10 +531,10 @@ PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr fi
 
     StringBuffer data(m_length);
     UChar* to = data.characters();
-    unsigned outc = from - m_data;
+    unsigned outc = from - characters;
 
     if (outc)
-        memcpy(to, m_data, outc * sizeof(UChar));
+        memcpy(to, characters, outc * sizeof(UChar));
 
     while (true) {
         while (from != fromend && findMatch(*from))
@@ -376,7 +554,8 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 {
     StringBuffer data(m_length);
 
-    const UChar* from = m_data;
+    UpconvertedCharacters characters(this);
+    const UChar* from = characters;
     const UChar* fromend = from + m_length;
     int outc = 0;
     bool changedToSpace = false;
@@ -410,75 +589,123 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 
 int StringImpl::toIntStrict(bool* ok, int base)
 {
+    if (is8Bit())
+        return charactersToIntStrict(m_data8, m_length, ok, base);
     return charactersToIntStrict(m_data, m_length, ok, base);
 }
 
 unsigned StringImpl::toUIntStrict(bool* ok, int base)
 {
+    if (is8Bit())
+        return charactersToUIntStrict(m_data8, m_length, ok, base);
     return charactersToUIntStrict(m_data, m_length, ok, base);
 }
 
 int64_t StringImpl::toInt64Strict(bool* ok, int base)
 {
+    if (is8Bit())
+        return charactersToInt64Strict(m_data8, m_length, ok, base);
     return charactersToInt64Strict(m_data, m_length, ok, base);
 }
 
 uint64_t StringImpl::toUInt64Strict(bool* ok, int base)
 {
+    if (is8Bit())
+        return charactersToUInt64Strict(m_data8, m_length, ok, base);
     return charactersToUInt64Strict(m_data, m_length, ok, base);
 }
 
 intptr_t StringImpl::toIntPtrStrict(bool* ok, int base)
 {
+    if (is8Bit())
+        return charactersToIntPtrStrict(m_data8, m_length, ok, base);
     return charactersToIntPtrStrict(m_data, m_length, ok, base);
 }
 
 int StringImpl::toInt(bool* ok)
 {
+    if (is8Bit())
+        return charactersToInt(m_data8, m_length, ok);
     return charactersToInt(m_data, m_length, ok);
 }
 
 unsigned StringImpl::toUInt(bool* ok)
 {
+    if (is8Bit())
+        return charactersToUInt(m_data8, m_length, ok);
     return charactersToUInt(m_data, m_length, ok);
 }
 
 int64_t StringImpl::toInt64(bool* ok)
 {
+    if (is8Bit())
+        return charactersToInt64(m_data8, m_length, ok);
     return charactersToInt64(m_data, m_length, ok);
 }
 
 uint64_t StringImpl::toUInt64(bool* ok)
 {
+    if (is8Bit())
+        return charactersToUInt64(m_data8, m_length, ok);
     return charactersToUInt64(m_data, m_length, ok);
 }
 
 intptr_t StringImpl::toIntPtr(bool* ok)
 {
+    if (is8Bit())
+        return charactersToIntPtr(m_data8, m_length, ok);
     return charactersToIntPtr(m_data, m_length, ok);
 }
 
 double StringImpl::toDouble(bool* ok, bool* didReadNumber)
 {
+    if (is8Bit())
+        return charactersToDouble(m_data8, m_length, ok, didReadNumber);
     return charactersToDouble(m_data, m_length, ok, didReadNumber);
 }
 
 float StringImpl::toFloat(bool* ok, bool* didReadNumber)
 {
+    if (is8Bit())
+        return charactersToFloat(m_data8, m_length, ok, didReadNumber);
     return charactersToFloat(m_data, m_length, ok, didReadNumber);
 }
 
-static bool equal(const UChar* a, const char* b, int length)
+template<typename CharacterTypeA, typename CharacterTypeB>
+static inline bool equalCharacters(const CharacterTypeA* a, const CharacterTypeB* b, unsigned length)
 {
-    ASSERT(length >= 0);
-    while (length--) {
-        unsigned char bc = *b++;
-        if (*a++ != bc)
+    for (unsigned i = 0; i != length; ++i) {
+        if (a[i] != b[i])
             return false;
     }
     return true;
 }
 
+static inline bool equalCharacters(const UChar* a, const UChar* b, unsigned length)
+{
+    return !memcmp(a, b, length * sizeof(UChar));
+}
+
+static inline bool equalCharacters(const LChar* a, const LChar* b, unsigned length)
+{
+    return !memcmp(a, b, length);
+}
+
+template<typename CharacterTypeA, typename CharacterTypeB>
+static inline bool equalCharactersIgnoringCase(const CharacterTypeA* a, const CharacterTypeB* b, unsigned length)
+{
+    for (unsigned i = 0; i != length; ++i) {
+        if (foldCase(static_cast<UChar>(a[i])) != foldCase(static_cast<UChar>(b[i])))
+            return false;
+    }
+    return true;
+}
+
+static inline bool equalCharactersIgnoringCase(const UChar* a, const UChar* b, unsigned length)
+{
+    return !umemcasecmp(a, b, length);
+}
+
 bool equalIgnoringCase(const UChar* a, const char* b, unsigned length)
 {
     while (length--) {
@@ -489,19 +716,10 @@ bool equalIgnoringCase(const UChar* a, const char* b, unsigned length)
     return true;
 }
 
-static inline bool equalIgnoringCase(const UChar* a, const UChar* b, int length)
+template<typename CharacterType1, typename CharacterType2>
+static int codePointCompare(unsigned l1, unsigned l2, const CharacterType1* c1, const CharacterType2* c2)
 {
-    ASSERT(length >= 0);
-    return umemcasecmp(a, b, length) == 0;
-}
-
-int codePointCompare(const StringImpl* s1, const StringImpl* s2)
-{
-    const unsigned l1 = s1 ? s1->length() : 0;
-    const unsigned l2 = s2 ? s2->length() : 0;
     const unsigned lmin = l1 < l2 ? l1 : l2;
-    const UChar* c1 = s1 ? s1->characters() : 0;
-    const UChar* c2 = s2 ? s2->characters() : 0;
     unsigned pos = 0;
     while (pos < lmin && *c1 == *c2) {
         c1++;
@@ -518,44 +736,43 @@ int codePointCompare(const StringImpl* s1, const StringImpl* s2)
     return (l1 > l2) ? 1 : -1;
 }
 
+int codePointCompare(const StringImpl* s1, const StringImpl* s2)
+{
+    const unsigned l1 = s1 ? s1->length() : 0;
+    const unsigned l2 = s2 ? s2->length() : 0;
+    if (!l1 || !l2)
+        return codePointCompare(l1, l2, static_cast<const UChar*>(0), static_cast<const UChar*>(0));
+
+    if (s1->is8Bit()) {
+        if (s2->is8Bit())
+            return codePointCompare(l1, l2, s1->characters8(), s2->characters8());
+        return codePointCompare(l1, l2, s1->characters8(), s2->characters16());
+    }
+    if (s2->is8Bit())
+        return codePointCompare(l1, l2, s1->characters16(), s2->characters8());
+    return codePointCompare(l1, l2, s1->characters16(), s2->characters16());
+}
+
 size_t StringImpl::find(UChar c, unsigned start)
 {
+    if (is8Bit())
+        return WTF::find(m_data8, m_length, c, start);
     return WTF::find(m_data, m_length, c, start);
 }
 
 size_t StringImpl::find(CharacterMatchFunctionPtr matchFunction, unsigned start)
 {
+    if (is8Bit())
+        return WTF::find(m_data8, m_length, matchFunction, start);
     return WTF::find(m_data, m_length, matchFunction, start);
 }
 
-size_t StringImpl::find(const char* matchString, unsigned index)
+template<typename SearchCharacterType, typename MatchCharacterType>
+static inline size_t findInner(const SearchCharacterType* searchCharacters, const MatchCharacterType* matchCharacters, unsigned index, unsigned searchLength, unsigned matchLength)
 {
-    // Check for null or empty string to match against
-    if (!matchString)
-        return notFound;
-    size_t matchStringLength = strlen(matchString);
-    if (matchStringLength > numeric_limits<unsigned>::max())
-        CRASH();
-    unsigned matchLength = matchStringLength;
-    if (!matchLength)
-        return min(index, length());
-
-    // Optimization 1: fast case for strings of length 1.
-    if (matchLength == 1)
-        return WTF::find(characters(), length(), *(const unsigned char*)matchString, index);
-
-    // Check index & matchLength are in range.
-    if (index > length())
-        return notFound;
-    unsigned searchLength = length() - index;
-    if (matchLength > searchLength)
-        return notFound;
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = searchLength - matchLength;
 
-    const UChar* searchCharacters = characters() + index;
-    const unsigned char* matchCharacters = (const unsigned char*)matchString;
-
     // Optimization 2: keep a running hash of the strings,
     // only call memcmp if the hashes match.
     unsigned searchHash = 0;
@@ -567,7 +784,7 @@ size_t StringImpl::find(const char* matchString, unsigned index)
 
     unsigned i = 0;
     // keep looping until we match
-    while (searchHash != matchHash || !equal(searchCharacters + i, matchString, matchLength)) {
+    while (searchHash != matchHash || !equalCharacters(searchCharacters + i, matchCharacters, matchLength)) {
         if (i == delta)
             return notFound;
         searchHash += searchCharacters[i + matchLength];
@@ -577,7 +794,23 @@ size_t StringImpl::find(const char* matchString, unsigned index)
     return index + i;
 }
 
-size_t StringImpl::findIgnoringCase(const char* matchString, unsigned index)
+template<typename SearchCharacterType, typename MatchCharacterType>
+static inline size_t findIgnoringCaseInner(const SearchCharacterType* searchCharacters, const MatchCharacterType* matchCharacters, unsigned index, unsigned searchLength, unsigned matchLength)
+{
+    // delta is the number of additional times to test; delta == 0 means test only once.
+    unsigned delta = searchLength - matchLength;
+
+    unsigned i = 0;
+    // keep looping until we match
+    while (!equalCharactersIgnoringCase(searchCharacters + i, matchCharacters, matchLength)) {
+        if (i == delta)
+            return notFound;
+        ++i;
+    }
+    return index + i;
+}
+
+size_t StringImpl::find(const char* matchString, unsigned index)
 {
     // Check for null or empty string to match against
     if (!matchString)
@@ -589,25 +822,46 @@ size_t StringImpl::findIgnoringCase(const char* matchString, unsigned index)
     if (!matchLength)
         return min(index, length());
 
+    // Optimization 1: fast case for strings of length 1.
+    if (matchLength == 1)
+        return find(static_cast<UChar>(*reinterpret_cast<const LChar*>(matchString)), index);
+
     // Check index & matchLength are in range.
     if (index > length())
         return notFound;
     unsigned searchLength = length() - index;
     if (matchLength > searchLength)
         return notFound;
-    // delta is the number of additional times to test; delta == 0 means test only once.
-    unsigned delta = searchLength - matchLength;
 
-    const UChar* searchCharacters = characters() + index;
+    const LChar* matchCharacters = reinterpret_cast<const LChar*>(matchString);
+    if (is8Bit())
+        return findInner(m_data8 + index, matchCharacters, index, searchLength, matchLength);
+    return findInner(m_data + index, matchCharacters, index, searchLength, matchLength);
+}
 
-    unsigned i = 0;
-    // keep looping until we match
-    while (!equalIgnoringCase(searchCharacters + i, matchString, matchLength)) {
-        if (i == delta)
-            return notFound;
-        ++i;
-    }
-    return index + i;
+size_t StringImpl::findIgnoringCase(const char* matchString, unsigned index)
+{
+    // Check for null or empty string to match against
+    if (!matchString)
+        return notFound;
+    size_t matchStringLength = strlen(matchString);
+    if (matchStringLength > numeric_limits<unsigned>::max())
+        CRASH();
+    unsigned matchLength = matchStringLength;
+    if (!matchLength)
+        return min(index, length());
+
+    // Check index & matchLength are in range.
+    if (index > length())
+        return notFound;
+    unsigned searchLength = length() - index;
+    if (matchLength > searchLength)
+        return notFound;
+
+    const LChar* matchCharacters = reinterpret_cast<const LChar*>(matchString);
+    if (is8Bit())
+        return findIgnoringCaseInner(m_data8 + index, matchCharacters, index, searchLength, matchLength);
+    return findIgnoringCaseInner(m_data + index, matchCharacters, index, searchLength, matchLength);
 }
 
 size_t StringImpl::find(StringImpl* matchString, unsigned index)
@@ -621,7 +875,7 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::find(characters(), length(), matchString->characters()[0], index);
+        return find((*matchString)[0], index);
 
     // Check index & matchLength are in range.
     if (index > length())
@@ -629,31 +883,15 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
     unsigned searchLength = length() - index;
     if (matchLength > searchLength)
         return notFound;
-    // delta is the number of additional times to test; delta == 0 means test only once.
-    unsigned delta = searchLength - matchLength;
-
-    const UChar* searchCharacters = characters() + index;
-    const UChar* matchCharacters = matchString->characters();
 
-    // Optimization 2: keep a running hash of the strings,
-    // only call memcmp if the hashes match.
-    unsigned searchHash = 0;
-    unsigned matchHash = 0;
-    for (unsigned i = 0; i < matchLength; ++i) {
-        searchHash += searchCharacters[i];
-        matchHash += matchCharacters[i];
-    }
-
-    unsigned i = 0;
-    // keep looping until we match
-    while (searchHash != matchHash || memcmp(searchCharacters + i, matchCharacters, matchLength * sizeof(UChar))) {
-        if (i == delta)
-            return notFound;
-        searchHash += searchCharacters[i + matchLength];
-        searchHash -= searchCharacters[i];
-        ++i;
+    if (is8Bit()) {
+        if (matchString->is8Bit())
+            return findInner(m_data8 + index, matchString->m_data8, index, searchLength, matchLength);
+        return findInner(m_data8 + index, matchString->m_data, index, searchLength, matchLength);
     }
-    return index + i;
+    if (matchString->is8Bit())
+        return findInner(m_data + index, matchString->m_data8, index, searchLength, matchLength);
+    return findInner(m_data + index, matchString->m_data, index, searchLength, matchLength);
 }
 
 size_t StringImpl::findIgnoringCase(StringImpl* matchString, unsigned index)
@@ -671,25 +909,57 @@ size_t StringImpl::findIgnoringCase(StringImpl* matchString, unsigned index)
     unsigned searchLength = length() - index;
     if (matchLength > searchLength)
         return notFound;
-    // delta is the number of additional times to test; delta == 0 means test only once.
-    unsigned delta = searchLength - matchLength;
 
-    const UChar* searchCharacters = characters() + index;
-    const UChar* matchCharacters = matchString->characters();
+    if (is8Bit()) {
+        if (matchString->is8Bit())
+            return findIgnoringCaseInner(m_data8 + index, matchString->m_data8, index, searchLength, matchLength);
+        return findIgnoringCaseInner(m_data8 + index, matchString->m_data, index, searchLength, matchLength);
+    }
+    if (matchString->is8Bit())
+        return findIgnoringCaseInner(m_data + index, matchString->m_data8, index, searchLength, matchLength);
+    return findIgnoringCaseInner(m_data + index, matchString->m_data, index, searchLength, matchLength);
+}
+
+size_t StringImpl::reverseFind(UChar c, unsigned index)
+{
+    if (is8Bit())
+        return WTF::reverseFind(m_data8, m_length, c, index);
+    return WTF::reverseFind(m_data, m_length, c, index);
+}
+
+template<typename SearchCharacterType, typename MatchCharacterType>
+static inline size_t reverseFindInner(const SearchCharacterType* searchCharacters, const MatchCharacterType* matchCharacters, unsigned delta, unsigned matchLength)
+{
+    // Optimization 2: keep a running hash of the strings,
+    // only call memcmp if the hashes match.
+    unsigned searchHash = 0;
+    unsigned matchHash = 0;
+    for (unsigned i = 0; i < matchLength; ++i) {
+        searchHash += searchCharacters[delta + i];
+        matchHash += matchCharacters[i];
+    }
 
-    unsigned i = 0;
     // keep looping until we match
-    while (!equalIgnoringCase(searchCharacters + i, matchCharacters, matchLength)) {
-        if (i == delta)
+    while (searchHash != matchHash || !equalCharacters(searchCharacters + delta, matchCharacters, matchLength)) {
+        if (!delta)
             return notFound;
-        ++i;
+        delta--;
+        searchHash -= searchCharacters[delta + matchLength];
+        searchHash += searchCharacters[delta];
     }
-    return index + i;
+    return delta;
 }
 
-size_t StringImpl::reverseFind(UChar c, unsigned index)
+template<typename SearchCharacterType, typename MatchCharacterType>
+static inline size_t reverseFindIgnoringCaseInner(const SearchCharacterType* searchCharacters, const MatchCharacterType* matchCharacters, unsigned delta, unsigned matchLength)
 {
-    return WTF::reverseFind(m_data, m_length, c, index);
+    // keep looping until we match
+    while (!equalCharactersIgnoringCase(searchCharacters + delta, matchCharacters, matchLength)) {
+        if (!delta)
+            return notFound;
+        delta--;
+    }
+    return delta;
 }
 
 size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
@@ -703,7 +973,7 @@ size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::reverseFind(characters(), length(), matchString->characters()[0], index);
+        return reverseFind((*matchString)[0], index);
 
     // Check index & matchLength are in range.
     if (matchLength > length())
@@ -711,27 +981,14 @@ size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = min(index, length() - matchLength);
 
-    const UChar *searchCharacters = characters();
-    const UChar *matchCharacters = matchString->characters();
-
-    // Optimization 2: keep a running hash of the strings,
-    // only call memcmp if the hashes match.
-    unsigned searchHash = 0;
-    unsigned matchHash = 0;
-    for (unsigned i = 0; i < matchLength; ++i) {
-        searchHash += searchCharacters[delta + i];
-        matchHash += matchCharacters[i];
+    if (is8Bit()) {
+        if (matchString->is8Bit())
+            return reverseFindInner(m_data8, matchString->m_data8, delta, matchLength);
+        return reverseFindInner(m_data8, matchString->m_data, delta, matchLength);
     }
-
-    // keep looping until we match
-    while (searchHash != matchHash || memcmp(searchCharacters + delta, matchCharacters, matchLength * sizeof(UChar))) {
-        if (!delta)
-            return notFound;
-        delta--;
-        searchHash -= searchCharacters[delta + matchLength];
-        searchHash += searchCharacters[delta];
-    }
-    return delta;
+    if (matchString->is8Bit())
+        return reverseFindInner(m_data, matchString->m_data8, delta, matchLength);
+    return reverseFindInner(m_data, matchString->m_data, delta, matchLength);
 }
 
 size_t StringImpl::reverseFindIgnoringCase(StringImpl* matchString, unsigned index)
@@ -748,17 +1005,15 @@ size_t StringImpl::reverseFindIgnoringCase(StringImpl* matchString, unsigned ind
         return notFound;
     // delta is the number of additional times to test; delta == 0 means test only once.
     unsigned delta = min(index, length() - matchLength);
-    
-    const UChar *searchCharacters = characters();
-    const UChar *matchCharacters = matchString->characters();
 
-    // keep looping until we match
-    while (!equalIgnoringCase(searchCharacters + delta, matchCharacters, matchLength)) {
-        if (!delta)
-            return notFound;
-        delta--;
+    if (is8Bit()) {
+        if (matchString->is8Bit())
+            return reverseFindIgnoringCaseInner(m_data8, matchString->m_data8, delta, matchLength);
+        return reverseFindIgnoringCaseInner(m_data8, matchString->m_data, delta, matchLength);
     }
-    return delta;
+    if (matchString->is8Bit())
+        return reverseFindIgnoringCaseInner(m_data, matchString->m_data8, delta, matchLength);
+    return reverseFindIgnoringCaseInner(m_data, matchString->m_data, delta, matchLength);
 }
 
 bool StringImpl::endsWith(StringImpl* m_data, bool caseSensitive)
@@ -775,18 +1030,14 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
 {
     if (oldC == newC)
         return this;
-    unsigned i;
-    for (i = 0; i != m_length; ++i)
-        if (m_data[i] == oldC)
-            break;
-    if (i == m_length)
+    if (find(oldC) == notFound)
         return this;
 
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
-    for (i = 0; i != m_length; ++i) {
-        UChar ch = m_data[i];
+    for (unsigned i = 0; i != m_length; ++i) {
+        UChar ch = (*this)[i];
         if (ch == oldC)
             ch = newC;
         data[i] = ch;
@@ -808,11 +1059,10 @@ PassRefPtr<StringImpl> StringImpl::replace(unsigned position, unsigned lengthToR
 
     RefPtr<StringImpl> newImpl =
         createUninitialized(length() - lengthToReplace + lengthToInsert, data);
-    memcpy(data, characters(), position * sizeof(UChar));
+    copyCharactersTo(data, 0, position);
     if (str)
-        memcpy(data + position, str->characters(), lengthToInsert * sizeof(UChar));
-    memcpy(data + position + lengthToInsert, characters() + position + lengthToReplace,
-        (length() - position - lengthToReplace) * sizeof(UChar));
+        str->copyCharactersTo(data + position, 0, lengthToInsert);
+    copyCharactersTo(data + position + lengthToInsert, position + lengthToReplace, length() - position - lengthToReplace);
     return newImpl.release();
 }
 
@@ -856,15 +1106,15 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar pattern, StringImpl* replacemen
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        copyCharactersTo(data + dstOffset, srcSegmentStart, srcSegmentLength);
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        replacement->copyCharactersTo(data + dstOffset, 0, repStrLength);
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + 1;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    copyCharactersTo(data + dstOffset, srcSegmentStart, srcSegmentLength);
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -914,15 +1164,15 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        copyCharactersTo(data + dstOffset, srcSegmentStart, srcSegmentLength);
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        replacement->copyCharactersTo(data + dstOffset, 0, repStrLength);
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + patternLength;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    copyCharactersTo(data + dstOffset, srcSegmentStart, srcSegmentLength);
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -942,7 +1192,19 @@ bool equal(const StringImpl* a, const char* b)
         return !a;
 
     unsigned length = a->length();
-    const UChar* as = a->characters();
+    if (a->is8Bit()) {
+        const LChar* as = a->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            LChar bc = b[i];
+            if (!bc)
+                return false;
+            if (as[i] != bc)
+                return false;
+        }
+        return !b[length];
+    }
+
+    const UChar* as = a->characters16();
     for (unsigned i = 0; i != length; ++i) {
         unsigned char bc = b[i];
         if (!bc)
@@ -959,16 +1221,9 @@ bool equalIgnoringCase(StringImpl* a, StringImpl* b)
     return CaseFoldingHash::equal(a, b);
 }
 
-bool equalIgnoringCase(StringImpl* a, const char* b)
+template<typename CharacterType>
+static inline bool equalIgnoringCase(const CharacterType* as, unsigned length, const char* b)
 {
-    if (!a)
-        return !b;
-    if (!b)
-        return !a;
-
-    unsigned length = a->length();
-    const UChar* as = a->characters();
-
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     bool equal = true;
@@ -993,6 +1248,18 @@ bool equalIgnoringCase(StringImpl* a, const char* b)
     return equal && !b[length];
 }
 
+bool equalIgnoringCase(StringImpl* a, const char* b)
+{
+    if (!a)
+        return !b;
+    if (!b)
+        return !a;
+
+    if (a->is8Bit())
+        return equalIgnoringCase(a->characters8(), a->length(), b);
+    return equalIgnoringCase(a->characters16(), a->length(), b);
+}
+
 bool equalIgnoringNullity(StringImpl* a, StringImpl* b)
 {
     if (StringHash::equal(a, b))
@@ -1008,7 +1275,7 @@ bool equalIgnoringNullity(StringImpl* a, StringImpl* b)
 WTF::Unicode::Direction StringImpl::defaultWritingDirection(bool* hasStrongDirectionality)
 {
     for (unsigned i = 0; i < m_length; ++i) {
-        WTF::Unicode::Direction charDirection = WTF::Unicode::direction(m_data[i]);
+        WTF::Unicode::Direction charDirection = WTF::Unicode::direction((*this)[i]);
         if (charDirection == WTF::Unicode::LeftToRight) {
             if (hasStrongDirectionality)
                 *hasStrongDirectionality = true;
@@ -1056,7 +1323,7 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
     if (length >= numeric_limits<unsigned>::max())
         CRASH();
     RefPtr<StringImpl> terminatedString = createUninitialized(length + 1, data);
-    memcpy(data, string.m_data, length * sizeof(UChar));
+    string.copyCharactersTo(data, 0, length);
     data[length] = 0;
     terminatedString->m_length--;
     terminatedString->m_hash = string.m_hash;
@@ -1066,6 +1333,8 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
 
 PassRefPtr<StringImpl> StringImpl::threadsafeCopy() const
 {
+    if (is8Bit())
+        return create(m_data8, m_length);
     return create(m_data, m_length);
 }
 
@@ -42,6 +42,12 @@ typedef const struct __CFString * CFStringRef;
 @class NSString;
 #endif
 
+// Set to 1 to count 8-bit strings and the UTF-16 copies that characters() keeps of them.
+// StringStats::printStats() then reports how much memory the 8-bit storage saves.
+#ifndef STRING_STATS
+#define STRING_STATS 0
+#endif
+
 // FIXME: This is a temporary layering violation while we move string code to WTF.
 // Landing the file moves in one patch, will follow on with patches to change the namespaces.
 namespace JSC {
@@ -58,6 +64,16 @@ struct UCharBufferTranslator;
 
 enum TextCaseSensitivity { TextCaseSensitive, TextCaseInsensitive };
 
+#if STRING_STATS
+// The counters are not synchronized, so strings used on other threads make them approximate.
+struct StringStats {
+    static void add8BitString(unsigned length);
+    static void remove8BitString(unsigned length, bool hadUpconvertedCopy);
+    static void addUpconvertedCopy(unsigned length);
+    static void printStats();
+};
+#endif
+
 typedef OwnFastMallocPtr<const UChar> SharableUChar;
 typedef CrossThreadRefCounted<SharableUChar> SharedUChar;
 typedef bool (*CharacterMatchFunctionPtr)(UChar);
@@ -97,6 +113,20 @@ private:
         ASSERT(m_length);
     }
 
+    // Create a normal 8-bit string with internal storage (BufferInternal). The
+    // buffer slot holds the 16-bit copy made if characters() is ever called.
+    enum Force8Bit { Force8BitConstructor };
+    StringImpl(unsigned length, Force8Bit)
+        : StringImplBase(length, BufferInternal)
+        , m_data8(reinterpret_cast<const LChar*>(this + 1))
+        , m_buffer(0)
+        , m_hash(0)
+    {
+        ASSERT(m_data8);
+        ASSERT(m_length);
+        m_refCountAndFlags |= s_refCountFlagIs8Bit;
+    }
+
     // Create a StringImpl adopting ownership of the provided buffer (BufferOwned)
     StringImpl(const UChar* characters, unsigned length)
         : StringImplBase(length, BufferOwned)
@@ -136,7 +166,7 @@ private:
     {
         ASSERT(!isStatic());
         ASSERT(!m_hash);
-        ASSERT(hash == StringHasher::computeHash(m_data, m_length));
+        ASSERT(hash == (is8Bit() ? StringHasher::computeHash(m_data8, m_length) : StringHasher::computeHash(m_data, m_length)));
         m_hash = hash;
     }
 
@@ -144,6 +174,7 @@ public:
     ~StringImpl();
 
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length);
+    static PassRefPtr<StringImpl> create(const LChar*, unsigned length);
     static PassRefPtr<StringImpl> create(const char*, unsigned length);
     static PassRefPtr<StringImpl> create(const char*);
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length, PassRefPtr<SharedUChar> sharedBuffer);
@@ -155,11 +186,18 @@ public:
         if (!length)
             return empty();
 
+        // 8-bit strings keep their characters inline, so substrings of them are copies.
+        if (rep->is8Bit())
+            return create(rep->m_data8 + offset, length);
+
         StringImpl* ownerRep = (rep->bufferOwnership() == BufferSubstring) ? rep->m_substringBuffer : rep.get();
         return adoptRef(new StringImpl(rep->m_data + offset, length, ownerRep));
     }
 
     static PassRefPtr<StringImpl> createUninitialized(unsigned length, UChar*& data);
+    static PassRefPtr<StringImpl> createUninitialized(unsigned length, LChar*& data);
+    // Returns an 8-bit string if every character fits in Latin-1.
+    static PassRefPtr<StringImpl> create8BitIfPossible(const UChar*, unsigned length);
     static ALWAYS_INLINE PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, UChar*& output)
     {
         if (!length) {
@@ -181,6 +219,8 @@ public:
     }
 
     static unsigned dataOffset() { return OBJECT_OFFSETOF(StringImpl, m_data); }
+    static unsigned flagsOffset() { return OBJECT_OFFSETOF(StringImpl, m_refCountAndFlags); }
+    static unsigned flagIs8Bit() { return s_refCountFlagIs8Bit; }
     static PassRefPtr<StringImpl> createWithTerminatingNullCharacter(const StringImpl&);
     static PassRefPtr<StringImpl> createStrippingNullCharacters(const UChar*, unsigned length);
 
@@ -198,7 +238,46 @@ public:
     static PassRefPtr<StringImpl> adopt(StringBuffer&);
 
     SharedUChar* sharedBuffer();
-    const UChar* characters() const { return m_data; }
+    bool is8Bit() const { return m_refCountAndFlags & s_refCountFlagIs8Bit; }
+    const LChar* characters8() const { ASSERT(is8Bit()); return m_data8; }
+    const UChar* characters16() const { ASSERT(!is8Bit()); return m_data; }
+
+    // Calling this on an 8-bit string keeps a UTF-16 copy alongside the 8-bit characters
+    // for the rest of the string's life. Code that reads strings often should check
+    // is8Bit() and read characters8() or characters16(), or use copyCharactersTo() or
+    // UpconvertedCharacters, which do not keep a copy.
+    const UChar* characters() const
+    {
+        if (!is8Bit())
+            return m_data;
+        if (m_buffer)
+            return static_cast<const UChar*>(m_buffer);
+        return cacheUpconvertedCharacters();
+    }
+
+    // Copies characters [start, start + length) to destination, widening 8-bit characters.
+    void copyCharactersTo(UChar* destination, unsigned start, unsigned length) const
+    {
+        ASSERT(start + length <= m_length);
+        if (is8Bit())
+            copyChars(destination, m_data8 + start, length);
+        else
+            copyChars(destination, m_data + start, length);
+    }
+
+    // UTF-16 view of a string for code that cannot handle 8-bit characters. An 8-bit
+    // string is widened into a buffer owned by this object rather than by the string.
+    class UpconvertedCharacters {
+        WTF_MAKE_NONCOPYABLE(UpconvertedCharacters);
+    public:
+        explicit UpconvertedCharacters(const StringImpl*);
+        operator const UChar*() const { return m_characters; }
+        const UChar* get() const { return m_characters; }
+
+    private:
+        Vector<UChar, 32> m_upconvertedCharacters;
+        const UChar* m_characters;
+    };
 
     size_t cost()
     {
@@ -235,7 +314,12 @@ public:
             m_refCountAndFlags &= ~s_refCountFlagIsAtomic;
     }
 
-    unsigned hash() const { if (!m_hash) m_hash = StringHasher::computeHash(m_data, m_length); return m_hash; }
+    unsigned hash() const
+    {
+        if (!m_hash)
+            m_hash = is8Bit() ? StringHasher::computeHash(m_data8, m_length) : StringHasher::computeHash(m_data, m_length);
+        return m_hash;
+    }
     unsigned existingHash() const { ASSERT(m_hash); return m_hash; }
 
     ALWAYS_INLINE void deref() { m_refCountAndFlags -= s_refCountIncrement; if (!(m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic))) delete this; }
@@ -252,6 +336,12 @@ public:
             memcpy(destination, source, numCharacters * sizeof(UChar));
     }
 
+    static void copyChars(UChar* destination, const LChar* source, unsigned numCharacters)
+    {
+        for (unsigned i = 0; i < numCharacters; ++i)
+            destination[i] = source[i];
+    }
+
     // Returns a StringImpl suitable for use on another thread.
     PassRefPtr<StringImpl> crossThreadString();
     // Makes a deep copy. Helpful only if you need to use a String on another thread
@@ -261,7 +351,13 @@ public:
 
     PassRefPtr<StringImpl> substring(unsigned pos, unsigned len = UINT_MAX);
 
-    UChar operator[](unsigned i) { ASSERT(i < m_length); return m_data[i]; }
+    UChar operator[](unsigned i)
+    {
+        ASSERT(i < m_length);
+        if (is8Bit())
+            return m_data8[i];
+        return m_data[i];
+    }
     UChar32 characterStartingAt(unsigned);
 
     bool containsOnlyWhitespace();
@@ -327,11 +423,17 @@ private:
     static const unsigned s_copyCharsInlineCutOff = 20;
 
     static PassRefPtr<StringImpl> createStrippingNullCharactersSlowCase(const UChar*, unsigned length);
-    
+    const UChar* cacheUpconvertedCharacters() const;
+    template<typename CharacterType> PassRefPtr<StringImpl> stripWhiteSpace(const CharacterType*);
+
     BufferOwnership bufferOwnership() const { return static_cast<BufferOwnership>(m_refCountAndFlags & s_refCountMaskBufferOwnership); }
     bool isStatic() const { return m_refCountAndFlags & s_refCountFlagStatic; }
-    const UChar* m_data;
     union {
+        const UChar* m_data;
+        const LChar* m_data8;
+    };
+    union {
+        // For 8-bit strings, holds the 16-bit copy made by characters(), if any.
         void* m_buffer;
         StringImpl* m_substringBuffer;
         SharedUChar* m_sharedBuffer;
@@ -339,6 +441,17 @@ private:
     mutable unsigned m_hash;
 };
 
+inline StringImpl::UpconvertedCharacters::UpconvertedCharacters(const StringImpl* string)
+{
+    if (!string || !string->is8Bit()) {
+        m_characters = string ? string->characters16() : 0;
+        return;
+    }
+    m_upconvertedCharacters.resize(string->length());
+    string->copyCharactersTo(m_upconvertedCharacters.data(), 0, string->length());
+    m_characters = m_upconvertedCharacters.data();
+}
+
 bool equal(const StringImpl*, const StringImpl*);
 bool equal(const StringImpl*, const char*);
 inline bool equal(const char* a, StringImpl* b) { return equal(b, a); }
@@ -351,6 +464,15 @@ inline bool equalIgnoringCase(const char* a, const UChar* b, unsigned length) {
 
 bool equalIgnoringNullity(StringImpl*, StringImpl*);
 
+inline bool equal(const LChar* a, const UChar* b, unsigned length)
+{
+    for (unsigned i = 0; i != length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
 template<size_t inlineCapacity>
 bool equalIgnoringNullity(const Vector<UChar, inlineCapacity>& a, StringImpl* b)
 {
@@ -358,7 +480,20 @@ bool equalIgnoringNullity(const Vector<UChar, inlineCapacity>& a, StringImpl* b)
         return !a.size();
     if (a.size() != b->length())
         return false;
-    return !memcmp(a.data(), b->characters(), b->length());
+    if (b->is8Bit())
+        return equal(b->characters8(), a.data(), b->length());
+    return !memcmp(a.data(), b->characters16(), b->length());
+}
+
+// Compares two strings of the same length, at least one of which is 8-bit.
+inline bool equalWithMixedWidths(const StringImpl* a, const StringImpl* b, unsigned length)
+{
+    ASSERT(a->is8Bit() || b->is8Bit());
+    if (a->is8Bit() && b->is8Bit())
+        return !memcmp(a->characters8(), b->characters8(), length);
+    if (a->is8Bit())
+        return equal(a->characters8(), b->characters16(), length);
+    return equal(b->characters8(), a->characters16(), length);
 }
 
 int codePointCompare(const StringImpl*, const StringImpl*);
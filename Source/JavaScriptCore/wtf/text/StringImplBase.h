@@ -73,11 +73,12 @@ protected:
         ASSERT(!isStringImpl());
     }
 
-    // The bottom 7 bits hold flags, the top 25 bits hold the ref count.
+    // The bottom 8 bits hold flags, the top 24 bits hold the ref count.
     // When dereferencing StringImpls we check for the ref count AND the
     // static bit both being zero - static strings are never deleted.
-    static const unsigned s_refCountMask = 0xFFFFFF80;
-    static const unsigned s_refCountIncrement = 0x80;
+    static const unsigned s_refCountMask = 0xFFFFFF00;
+    static const unsigned s_refCountIncrement = 0x100;
+    static const unsigned s_refCountFlagIs8Bit = 0x80;
     static const unsigned s_refCountFlagStatic = 0x40;
     static const unsigned s_refCountFlagHasTerminatingNullCharacter = 0x20;
     static const unsigned s_refCountFlagIsAtomic = 0x10;
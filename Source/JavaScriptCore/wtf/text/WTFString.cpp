@@ -87,8 +87,8 @@ void String::append(const String& str)
             if (str.length() > numeric_limits<unsigned>::max() - m_impl->length())
                 CRASH();
             RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(m_impl->length() + str.length(), data);
-            memcpy(data, m_impl->characters(), m_impl->length() * sizeof(UChar));
-            memcpy(data + m_impl->length(), str.characters(), str.length() * sizeof(UChar));
+            m_impl->copyCharactersTo(data, 0, m_impl->length());
+            str.impl()->copyCharactersTo(data + m_impl->length(), 0, str.length());
             m_impl = newImpl.release();
         } else
             m_impl = str.m_impl;
@@ -106,7 +106,7 @@ void String::append(char c)
         if (m_impl->length() >= numeric_limits<unsigned>::max())
             CRASH();
         RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(m_impl->length() + 1, data);
-        memcpy(data, m_impl->characters(), m_impl->length() * sizeof(UChar));
+        m_impl->copyCharactersTo(data, 0, m_impl->length());
         data[m_impl->length()] = c;
         m_impl = newImpl.release();
     } else
@@ -124,7 +124,7 @@ void String::append(UChar c)
         if (m_impl->length() >= numeric_limits<unsigned>::max())
             CRASH();
         RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(m_impl->length() + 1, data);
-        memcpy(data, m_impl->characters(), m_impl->length() * sizeof(UChar));
+        m_impl->copyCharactersTo(data, 0, m_impl->length());
         data[m_impl->length()] = c;
         m_impl = newImpl.release();
     } else
@@ -166,7 +166,8 @@ void String::insert(const String& str, unsigned pos)
             m_impl = str.impl();
         return;
     }
-    insert(str.characters(), str.length(), pos);
+    StringImpl::UpconvertedCharacters characters(str.impl());
+    insert(characters, str.length(), pos);
 }
 
 void String::append(const UChar* charactersToAppend, unsigned lengthToAppend)
@@ -186,7 +187,7 @@ void String::append(const UChar* charactersToAppend, unsigned lengthToAppend)
     if (lengthToAppend > numeric_limits<unsigned>::max() - length())
         CRASH();
     RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(length() + lengthToAppend, data);
-    memcpy(data, characters(), length() * sizeof(UChar));
+    m_impl->copyCharactersTo(data, 0, length());
     memcpy(data + length(), charactersToAppend, lengthToAppend * sizeof(UChar));
     m_impl = newImpl.release();
 }
@@ -208,9 +209,9 @@ void String::insert(const UChar* charactersToInsert, unsigned lengthToInsert, un
     if (lengthToInsert > numeric_limits<unsigned>::max() - length())
         CRASH();
     RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(length() + lengthToInsert, data);
-    memcpy(data, characters(), position * sizeof(UChar));
+    m_impl->copyCharactersTo(data, 0, position);
     memcpy(data + position, charactersToInsert, lengthToInsert * sizeof(UChar));
-    memcpy(data + position + lengthToInsert, characters() + position, (length() - position) * sizeof(UChar));
+    m_impl->copyCharactersTo(data + position + lengthToInsert, position, length() - position);
     m_impl = newImpl.release();
 }
 
@@ -227,7 +228,7 @@ void String::truncate(unsigned position)
         return;
     UChar* data;
     RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(position, data);
-    memcpy(data, characters(), position * sizeof(UChar));
+    m_impl->copyCharactersTo(data, 0, position);
     m_impl = newImpl.release();
 }
 
@@ -241,9 +242,8 @@ void String::remove(unsigned position, int lengthToRemove)
         lengthToRemove = length() - position;
     UChar* data;
     RefPtr<StringImpl> newImpl = StringImpl::createUninitialized(length() - lengthToRemove, data);
-    memcpy(data, characters(), position * sizeof(UChar));
-    memcpy(data + position, characters() + position + lengthToRemove,
-        (length() - lengthToRemove - position) * sizeof(UChar));
+    m_impl->copyCharactersTo(data, 0, position);
+    m_impl->copyCharactersTo(data + position, position + lengthToRemove, length() - lengthToRemove - position);
     m_impl = newImpl.release();
 }
 
@@ -317,7 +317,10 @@ bool String::percentage(int& result) const
     if ((*m_impl)[m_impl->length() - 1] != '%')
        return false;
 
-    result = charactersToIntStrict(m_impl->characters(), m_impl->length() - 1);
+    if (m_impl->is8Bit())
+        result = charactersToIntStrict(m_impl->characters8(), m_impl->length() - 1);
+    else
+        result = charactersToIntStrict(m_impl->characters16(), m_impl->length() - 1);
     return true;
 }
 
@@ -645,13 +648,12 @@ CString String::ascii() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
     for (unsigned i = 0; i < length; ++i) {
-        UChar ch = characters[i];
+        UChar ch = (*m_impl)[i];
         characterBuffer[i] = ch && (ch < 0x20 || ch > 0x7f) ? '?' : ch;
     }
 
@@ -664,11 +666,16 @@ CString String::latin1() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
+    if (is8Bit()) {
+        memcpy(characterBuffer, m_impl->characters8(), length);
+        return result;
+    }
+
+    const UChar* characters = this->characters();
     for (unsigned i = 0; i < length; ++i) {
         UChar ch = characters[i];
         characterBuffer[i] = ch > 0xff ? '?' : ch;
@@ -689,6 +696,26 @@ static inline void putUTF8Triple(char*& buffer, UChar ch)
 CString String::utf8(bool strict) const
 {
     unsigned length = this->length();
+
+    if (is8Bit()) {
+        // Latin-1 characters take at most two UTF-8 bytes.
+        if (length > numeric_limits<unsigned>::max() / 2)
+            return CString();
+        Vector<char, 1024> bufferVector(length * 2);
+        char* buffer = bufferVector.data();
+        const LChar* characters = m_impl->characters8();
+        for (unsigned i = 0; i < length; ++i) {
+            LChar ch = characters[i];
+            if (ch < 0x80)
+                *buffer++ = ch;
+            else {
+                *buffer++ = static_cast<char>((ch >> 6) | 0xC0);
+                *buffer++ = static_cast<char>((ch & 0x3F) | 0x80);
+            }
+        }
+        return CString(bufferVector.data(), buffer - bufferVector.data());
+    }
+
     const UChar* characters = this->characters();
 
     // Allocate a buffer big enough to hold all the characters
@@ -792,8 +819,8 @@ static bool isCharacterAllowedInBase(UChar c, int base)
     return false;
 }
 
-template <typename IntegralType>
-static inline IntegralType toIntegralType(const UChar* data, size_t length, bool* ok, int base)
+template <typename IntegralType, typename CharacterType>
+static inline IntegralType toIntegralType(const CharacterType* data, size_t length, bool* ok, int base)
 {
     static const IntegralType integralMax = numeric_limits<IntegralType>::max();
     static const bool isSigned = numeric_limits<IntegralType>::is_signed;
@@ -868,7 +895,8 @@ bye:
     return isOk ? value : 0;
 }
 
-static unsigned lengthOfCharactersAsInteger(const UChar* data, size_t length)
+template <typename CharacterType>
+static unsigned lengthOfCharactersAsInteger(const CharacterType* data, size_t length)
 {
     size_t i = 0;
 
@@ -941,7 +969,58 @@ intptr_t charactersToIntPtr(const UChar* data, size_t length, bool* ok)
     return toIntegralType<intptr_t>(data, lengthOfCharactersAsInteger(data, length), ok, 10);
 }
 
-double charactersToDouble(const UChar* data, size_t length, bool* ok, bool* didReadNumber)
+int charactersToIntStrict(const LChar* data, size_t length, bool* ok, int base)
+{
+    return toIntegralType<int>(data, length, ok, base);
+}
+
+unsigned charactersToUIntStrict(const LChar* data, size_t length, bool* ok, int base)
+{
+    return toIntegralType<unsigned>(data, length, ok, base);
+}
+
+int64_t charactersToInt64Strict(const LChar* data, size_t length, bool* ok, int base)
+{
+    return toIntegralType<int64_t>(data, length, ok, base);
+}
+
+uint64_t charactersToUInt64Strict(const LChar* data, size_t length, bool* ok, int base)
+{
+    return toIntegralType<uint64_t>(data, length, ok, base);
+}
+
+intptr_t charactersToIntPtrStrict(const LChar* data, size_t length, bool* ok, int base)
+{
+    return toIntegralType<intptr_t>(data, length, ok, base);
+}
+
+int charactersToInt(const LChar* data, size_t length, bool* ok)
+{
+    return toIntegralType<int>(data, lengthOfCharactersAsInteger(data, length), ok, 10);
+}
+
+unsigned charactersToUInt(const LChar* data, size_t length, bool* ok)
+{
+    return toIntegralType<unsigned>(data, lengthOfCharactersAsInteger(data, length), ok, 10);
+}
+
+int64_t charactersToInt64(const LChar* data, size_t length, bool* ok)
+{
+    return toIntegralType<int64_t>(data, lengthOfCharactersAsInteger(data, length), ok, 10);
+}
+
+uint64_t charactersToUInt64(const LChar* data, size_t length, bool* ok)
+{
+    return toIntegralType<uint64_t>(data, lengthOfCharactersAsInteger(data, length), ok, 10);
+}
+
+intptr_t charactersToIntPtr(const LChar* data, size_t length, bool* ok)
+{
+    return toIntegralType<intptr_t>(data, lengthOfCharactersAsInteger(data, length), ok, 10);
+}
+
+template <typename CharacterType>
+static inline double toDouble(const CharacterType* data, size_t length, bool* ok, bool* didReadNumber)
 {
     if (!length) {
         if (ok)
@@ -965,12 +1044,28 @@ double charactersToDouble(const UChar* data, size_t length, bool* ok, bool* didR
     return val;
 }
 
+double charactersToDouble(const UChar* data, size_t length, bool* ok, bool* didReadNumber)
+{
+    return toDouble(data, length, ok, didReadNumber);
+}
+
+double charactersToDouble(const LChar* data, size_t length, bool* ok, bool* didReadNumber)
+{
+    return toDouble(data, length, ok, didReadNumber);
+}
+
 float charactersToFloat(const UChar* data, size_t length, bool* ok, bool* didReadNumber)
 {
     // FIXME: This will return ok even when the string fits into a double but not a float.
     return static_cast<float>(charactersToDouble(data, length, ok, didReadNumber));
 }
 
+float charactersToFloat(const LChar* data, size_t length, bool* ok, bool* didReadNumber)
+{
+    // FIXME: This will return ok even when the string fits into a double but not a float.
+    return static_cast<float>(charactersToDouble(data, length, ok, didReadNumber));
+}
+
 } // namespace WTF
 
 #ifndef NDEBUG
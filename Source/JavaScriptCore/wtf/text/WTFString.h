@@ -66,6 +66,7 @@ struct StringHash;
 // Declarations of string operations
 
 bool charactersAreAllASCII(const UChar*, size_t);
+bool charactersAreAllASCII(const LChar*, size_t);
 bool charactersAreAllLatin1(const UChar*, size_t);
 int charactersToIntStrict(const UChar*, size_t, bool* ok = 0, int base = 10);
 unsigned charactersToUIntStrict(const UChar*, size_t, bool* ok = 0, int base = 10);
@@ -73,15 +74,30 @@ int64_t charactersToInt64Strict(const UChar*, size_t, bool* ok = 0, int base = 1
 uint64_t charactersToUInt64Strict(const UChar*, size_t, bool* ok = 0, int base = 10);
 intptr_t charactersToIntPtrStrict(const UChar*, size_t, bool* ok = 0, int base = 10);
 
+int charactersToIntStrict(const LChar*, size_t, bool* ok = 0, int base = 10);
+unsigned charactersToUIntStrict(const LChar*, size_t, bool* ok = 0, int base = 10);
+int64_t charactersToInt64Strict(const LChar*, size_t, bool* ok = 0, int base = 10);
+uint64_t charactersToUInt64Strict(const LChar*, size_t, bool* ok = 0, int base = 10);
+intptr_t charactersToIntPtrStrict(const LChar*, size_t, bool* ok = 0, int base = 10);
+
 int charactersToInt(const UChar*, size_t, bool* ok = 0); // ignores trailing garbage
 unsigned charactersToUInt(const UChar*, size_t, bool* ok = 0); // ignores trailing garbage
 int64_t charactersToInt64(const UChar*, size_t, bool* ok = 0); // ignores trailing garbage
 uint64_t charactersToUInt64(const UChar*, size_t, bool* ok = 0); // ignores trailing garbage
 intptr_t charactersToIntPtr(const UChar*, size_t, bool* ok = 0); // ignores trailing garbage
 
+int charactersToInt(const LChar*, size_t, bool* ok = 0); // ignores trailing garbage
+unsigned charactersToUInt(const LChar*, size_t, bool* ok = 0); // ignores trailing garbage
+int64_t charactersToInt64(const LChar*, size_t, bool* ok = 0); // ignores trailing garbage
+uint64_t charactersToUInt64(const LChar*, size_t, bool* ok = 0); // ignores trailing garbage
+intptr_t charactersToIntPtr(const LChar*, size_t, bool* ok = 0); // ignores trailing garbage
+
 double charactersToDouble(const UChar*, size_t, bool* ok = 0, bool* didReadNumber = 0);
 float charactersToFloat(const UChar*, size_t, bool* ok = 0, bool* didReadNumber = 0);
 
+double charactersToDouble(const LChar*, size_t, bool* ok = 0, bool* didReadNumber = 0);
+float charactersToFloat(const LChar*, size_t, bool* ok = 0, bool* didReadNumber = 0);
+
 template<bool isSpecialCharacter(UChar)> bool isAllSpecialCharacters(const UChar*, size_t);
 
 class String {
@@ -139,6 +155,8 @@ public:
         return m_impl->characters();
     }
 
+    bool is8Bit() const { return m_impl && m_impl->is8Bit(); }
+
     CString ascii() const;
     CString latin1() const;
     CString utf8(bool strict = false) const;
@@ -147,7 +165,7 @@ public:
     {
         if (!m_impl || index >= m_impl->length())
             return 0;
-        return m_impl->characters()[index];
+        return (*m_impl)[index];
     }
 
     static String number(short);
@@ -252,6 +270,13 @@ public:
     // into the buffer returned in data before the returned string is used.
     // Failure to do this will have unpredictable results.
     static String createUninitialized(unsigned length, UChar*& data) { return StringImpl::createUninitialized(length, data); }
+    // Like String(const UChar*, unsigned), but stores Latin-1 content in an 8-bit buffer.
+    static String make8BitIfPossible(const UChar* characters, unsigned length)
+    {
+        if (!characters)
+            return String();
+        return StringImpl::create8BitIfPossible(characters, length);
+    }
 
     void split(const String& separator, Vector<String>& result) const;
     void split(const String& separator, bool allowEmptyEntries, Vector<String>& result) const;
@@ -340,8 +365,13 @@ public:
         return WTF::Unicode::LeftToRight;
     }
 
-    bool containsOnlyASCII() const { return charactersAreAllASCII(characters(), length()); }
-    bool containsOnlyLatin1() const { return charactersAreAllLatin1(characters(), length()); }
+    bool containsOnlyASCII() const
+    {
+        if (is8Bit())
+            return charactersAreAllASCII(m_impl->characters8(), m_impl->length());
+        return charactersAreAllASCII(characters(), length());
+    }
+    bool containsOnlyLatin1() const { return is8Bit() || charactersAreAllLatin1(characters(), length()); }
 
     // Hash table deleted values, which are only constructed and never copied or destroyed.
     String(WTF::HashTableDeletedValueType) : m_impl(WTF::HashTableDeletedValue) { }
@@ -411,6 +441,14 @@ inline bool charactersAreAllASCII(const UChar* characters, size_t length)
     return !(ored & 0xFF80);
 }
 
+inline bool charactersAreAllASCII(const LChar* characters, size_t length)
+{
+    LChar ored = 0;
+    for (size_t i = 0; i < length; ++i)
+        ored |= characters[i];
+    return !(ored & 0x80);
+}
+
 inline bool charactersAreAllLatin1(const UChar* characters, size_t length)
 {
     UChar ored = 0;
@@ -431,6 +469,18 @@ inline size_t find(const UChar* characters, unsigned length, UChar matchCharacte
     return notFound;
 }
 
+inline size_t find(const LChar* characters, unsigned length, UChar matchCharacter, unsigned index = 0)
+{
+    if (matchCharacter > 0xFF)
+        return notFound;
+    while (index < length) {
+        if (characters[index] == matchCharacter)
+            return index;
+        ++index;
+    }
+    return notFound;
+}
+
 inline size_t find(const UChar* characters, unsigned length, CharacterMatchFunctionPtr matchFunction, unsigned index = 0)
 {
     while (index < length) {
@@ -441,6 +491,16 @@ inline size_t find(const UChar* characters, unsigned length, CharacterMatchFunct
     return notFound;
 }
 
+inline size_t find(const LChar* characters, unsigned length, CharacterMatchFunctionPtr matchFunction, unsigned index = 0)
+{
+    while (index < length) {
+        if (matchFunction(characters[index]))
+            return index;
+        ++index;
+    }
+    return notFound;
+}
+
 inline size_t reverseFind(const UChar* characters, unsigned length, UChar matchCharacter, unsigned index = UINT_MAX)
 {
     if (!length)
@@ -454,9 +514,28 @@ inline size_t reverseFind(const UChar* characters, unsigned length, UChar matchC
     return index;
 }
 
+inline size_t reverseFind(const LChar* characters, unsigned length, UChar matchCharacter, unsigned index = UINT_MAX)
+{
+    if (!length || matchCharacter > 0xFF)
+        return notFound;
+    if (index >= length)
+        index = length - 1;
+    while (characters[index] != matchCharacter) {
+        if (!index--)
+            return notFound;
+    }
+    return index;
+}
+
 inline void append(Vector<UChar>& vector, const String& string)
 {
-    vector.append(string.characters(), string.length());
+    if (!string.is8Bit()) {
+        vector.append(string.characters(), string.length());
+        return;
+    }
+    size_t oldSize = vector.size();
+    vector.grow(oldSize + string.length());
+    string.impl()->copyCharactersTo(vector.data() + oldSize, 0, string.length());
 }
 
 inline void appendNumber(Vector<UChar>& vector, unsigned char number)
@@ -490,6 +569,14 @@ template<bool isSpecialCharacter(UChar)> inline bool isAllSpecialCharacters(cons
 
 template<bool isSpecialCharacter(UChar)> inline bool String::isAllSpecialCharacters() const
 {
+    if (is8Bit()) {
+        const LChar* characters = m_impl->characters8();
+        for (unsigned i = 0; i < m_impl->length(); ++i) {
+            if (!isSpecialCharacter(characters[i]))
+                return false;
+        }
+        return true;
+    }
     return WTF::isAllSpecialCharacters<isSpecialCharacter>(characters(), length());
 }
 
@@ -41,4 +41,7 @@
 
 COMPILE_ASSERT(sizeof(UChar) == 2, UCharIsTwoBytes);
 
+// Latin-1 character, used by 8-bit StringImpl backing storage.
+typedef unsigned char LChar;
+
 #endif // WTF_UNICODE_H
@@ -636,6 +636,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/android/GLWebViewState.cpp \
 	platform/graphics/android/ImageAndroid.cpp \
 	platform/graphics/android/ImageBufferAndroid.cpp \
+	platform/graphics/android/ImageDecodeService.cpp \
 	platform/graphics/android/ImageSourceAndroid.cpp \
 	platform/graphics/android/PathAndroid.cpp \
 	platform/graphics/android/PatternAndroid.cpp \
@@ -777,6 +778,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/network/ResourceResponseBase.cpp \
 	\
 	platform/network/android/CookieJarAndroid.cpp \
+	platform/network/android/DNSAndroid.cpp \
 	platform/network/android/ProxyServerAndroid.cpp \
 	platform/network/android/ResourceHandleAndroid.cpp \
 	platform/network/android/ResourceRequestAndroid.cpp \
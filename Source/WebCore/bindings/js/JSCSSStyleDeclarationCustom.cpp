@@ -74,14 +74,14 @@ static bool hasCSSPropertyNamePrefix(const Identifier& propertyName, const char*
     ASSERT(propertyName.length());
 #endif
 
-    if (toASCIILower(propertyName.characters()[0]) != prefix[0])
+    if (toASCIILower(propertyName.ustring()[0]) != prefix[0])
         return false;
 
     unsigned length = propertyName.length();
     for (unsigned i = 1; i < length; ++i) {
         if (!prefix[i])
-            return isASCIIUpper(propertyName.characters()[i]);
-        if (propertyName.characters()[i] != prefix[i])
+            return isASCIIUpper(propertyName.ustring()[i]);
+        if (propertyName.ustring()[i] != prefix[i])
             return false;
     }
     return false;
@@ -116,14 +116,14 @@ static String cssPropertyName(const Identifier& propertyName, bool* hadPixelOrPo
             || hasCSSPropertyNamePrefix(propertyName, "apple"))
         builder.append('-');
     else {
-        if (isASCIIUpper(propertyName.characters()[0]))
+        if (isASCIIUpper(propertyName.ustring()[0]))
             return String();
     }
 
-    builder.append(toASCIILower(propertyName.characters()[i++]));
+    builder.append(toASCIILower(propertyName.ustring()[i++]));
 
     for (; i < length; ++i) {
-        UChar c = propertyName.characters()[i];
+        UChar c = propertyName.ustring()[i];
         if (!isASCIIUpper(c))
             builder.append(c);
         else
@@ -207,7 +207,8 @@ void CSSParser::setupParser(const char* prefix, const String& string, const char
     for (unsigned i = 0; i < strlen(prefix); i++)
         m_data[i] = prefix[i];
 
-    memcpy(m_data + strlen(prefix), string.characters(), string.length() * sizeof(UChar));
+    if (StringImpl* impl = string.impl())
+        impl->copyCharactersTo(m_data + strlen(prefix), 0, string.length());
 
     unsigned start = strlen(prefix) + string.length();
     unsigned end = start + strlen(suffix);
@@ -72,6 +72,7 @@ PassRefPtr<Attr> Attribute::createAttrIfNeeded(Element* e)
 void Attribute::bindAttr(Attr* attr)
 {
     ASSERT(!m_hasAttr);
+    ASSERT(!isShared());
     ASSERT(!attributeAttrMap().contains(this));
     attributeAttrMap().set(this, attr);
     m_hasAttr = true;
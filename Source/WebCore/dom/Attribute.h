@@ -73,7 +73,7 @@ public:
     // An extension to get the style information for presentational attributes.
     CSSStyleDeclaration* style() const { return m_styleDecl.get(); }
     CSSMappedAttributeDeclaration* decl() const { return m_styleDecl.get(); }
-    void setDecl(PassRefPtr<CSSMappedAttributeDeclaration> decl) { m_styleDecl = decl; }
+    void setDecl(PassRefPtr<CSSMappedAttributeDeclaration> decl) { ASSERT(!m_isShared || !decl); m_styleDecl = decl; }
 
     void setValue(const AtomicString& value) { m_value = value; }
     void setPrefix(const AtomicString& prefix) { m_name.setPrefix(prefix); }
@@ -85,10 +85,17 @@ public:
 
     bool isMappedAttribute() { return m_isMappedAttribute; }
 
+    // The HTML parser hands out the same Attribute to every element that has an identical
+    // shareable attribute, such as a repeated class="x". A shared attribute must not be
+    // modified in place; see NamedNodeMap::unsharedAttributeItem().
+    bool isShared() const { return m_isShared && !hasOneRef(); }
+    void setIsShared() { m_isShared = true; }
+
 private:
     Attribute(const QualifiedName& name, const AtomicString& value, bool isMappedAttribute, CSSMappedAttributeDeclaration* styleDecl)
         : m_isMappedAttribute(isMappedAttribute)
         , m_hasAttr(false)
+        , m_isShared(false)
         , m_name(name)
         , m_value(value)
         , m_styleDecl(styleDecl)
@@ -98,6 +105,7 @@ private:
     Attribute(const AtomicString& name, const AtomicString& value, bool isMappedAttribute, CSSMappedAttributeDeclaration* styleDecl)
         : m_isMappedAttribute(isMappedAttribute)
         , m_hasAttr(false)
+        , m_isShared(false)
         , m_name(nullAtom, name, nullAtom)
         , m_value(value)
         , m_styleDecl(styleDecl)
@@ -110,6 +118,7 @@ private:
     // These booleans will go into the spare 32-bits of padding from RefCounted in 64-bit.
     bool m_isMappedAttribute;
     bool m_hasAttr;
+    bool m_isShared;
     
     QualifiedName m_name;
     AtomicString m_value;
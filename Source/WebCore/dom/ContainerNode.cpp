@@ -492,6 +492,7 @@ void ContainerNode::parserRemoveChild(Node* oldChild)
     Node* prev = oldChild->previousSibling();
     Node* next = oldChild->nextSibling();
 
+    document()->incDOMTreeVersion();
     removeBetween(prev, next, oldChild);
 
     childrenChanged(true, prev, next, -1);
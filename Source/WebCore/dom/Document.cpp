@@ -59,6 +59,7 @@
 #include "Element.h"
 #include "EntityReference.h"
 #include "Event.h"
+#include "EventDispatcher.h"
 #include "EventHandler.h"
 #include "EventListener.h"
 #include "EventNames.h"
@@ -131,6 +132,7 @@
 #include "ScriptRunner.h"
 #include "SecurityOrigin.h"
 #include "SegmentedString.h"
+#include "SelectorNodeList.h"
 #include "SelectionController.h"
 #include "Settings.h"
 #include "StaticHashSetNodeList.h"
@@ -587,6 +589,7 @@ void Document::removedLastRef()
         m_activeNode = 0;
         m_titleElement = 0;
         m_documentElement = 0;
+        m_selectorQueryResultCache.clear();
 #if ENABLE(FULLSCREEN_API)
         m_fullScreenElement = 0;
 #endif
@@ -1745,6 +1748,8 @@ void Document::detach()
     clearAXObjectCache();
     stopActiveDOMObjects();
     m_eventQueue->cancelQueuedEvents();
+    m_selectorQueryResultCache.clear();
+    EventDispatcher::documentDetached(this);
 
 #if ENABLE(REQUEST_ANIMATION_FRAME)
     // FIXME: consider using ActiveDOMObject.
@@ -3392,8 +3397,18 @@ void Document::nodeChildrenChanged(ContainerNode* container)
     }
 }
 
+SelectorQueryResultCache* Document::ensureSelectorQueryResultCache()
+{
+    if (!m_selectorQueryResultCache)
+        m_selectorQueryResultCache = SelectorQueryResultCache::create();
+    return m_selectorQueryResultCache.get();
+}
+
 void Document::nodeChildrenWillBeRemoved(ContainerNode* container)
 {
+    if (m_selectorQueryResultCache)
+        m_selectorQueryResultCache->clear();
+
     if (!disableRangeMutation(page()) && !m_ranges.isEmpty()) {
         HashSet<Range*>::const_iterator end = m_ranges.end();
         for (HashSet<Range*>::const_iterator it = m_ranges.begin(); it != end; ++it)
@@ -3416,6 +3431,9 @@ void Document::nodeChildrenWillBeRemoved(ContainerNode* container)
 
 void Document::nodeWillBeRemoved(Node* n)
 {
+    if (m_selectorQueryResultCache)
+        m_selectorQueryResultCache->clear();
+
     HashSet<NodeIterator*>::const_iterator nodeIteratorsEnd = m_nodeIterators.end();
     for (HashSet<NodeIterator*>::const_iterator it = m_nodeIterators.begin(); it != nodeIteratorsEnd; ++it)
         (*it)->nodeWillBeRemoved(n);
@@ -3666,6 +3684,25 @@ void Document::addListenerTypeIfNeeded(const AtomicString& eventType)
 #endif
 }
 
+void Document::didAddEventListeners(const AtomicString& eventType, unsigned count)
+{
+    pair<HashMap<AtomicString, unsigned>::iterator, bool> result = m_eventListenerCounts.add(eventType, count);
+    if (!result.second)
+        result.first->second += count;
+}
+
+void Document::didRemoveEventListeners(const AtomicString& eventType, unsigned count)
+{
+    HashMap<AtomicString, unsigned>::iterator it = m_eventListenerCounts.find(eventType);
+    ASSERT(it != m_eventListenerCounts.end() && it->second >= count);
+    if (it == m_eventListenerCounts.end())
+        return;
+    if (it->second > count)
+        it->second -= count;
+    else
+        m_eventListenerCounts.remove(it);
+}
+
 CSSStyleDeclaration* Document::getOverrideStyle(Element*, const String&)
 {
     return 0;
@@ -113,6 +113,7 @@ class ScriptableDocumentParser;
 class ScriptElementData;
 class ScriptRunner;
 class SecurityOrigin;
+class SelectorQueryResultCache;
 class SerializedScriptValue;
 class SegmentedString;
 class Settings;
@@ -752,6 +753,12 @@ public:
     void addListenerType(ListenerType listenerType) { m_listenerTypes = m_listenerTypes | listenerType; }
     void addListenerTypeIfNeeded(const AtomicString& eventType);
 
+    // Number of event listeners of each type registered on nodes of this document. Event dispatch
+    // uses this to skip visiting the nodes on the propagation path when nothing can be listening.
+    bool hasEventListenersOfType(const AtomicString& eventType) const { return m_eventListenerCounts.contains(eventType); }
+    void didAddEventListeners(const AtomicString& eventType, unsigned count = 1);
+    void didRemoveEventListeners(const AtomicString& eventType, unsigned count = 1);
+
     CSSStyleDeclaration* getOverrideStyle(Element*, const String& pseudoElt);
 
     /**
@@ -905,6 +912,10 @@ public:
     void incDOMTreeVersion() { m_domTreeVersion = ++s_globalTreeVersion; }
     uint64_t domTreeVersion() const { return m_domTreeVersion; }
 
+    // querySelector() and querySelectorAll() results for nodes of this document.
+    SelectorQueryResultCache* selectorQueryResultCache() const { return m_selectorQueryResultCache.get(); }
+    SelectorQueryResultCache* ensureSelectorQueryResultCache();
+
     void setDocType(PassRefPtr<DocumentType>);
 
 #if ENABLE(XPATH)
@@ -1218,11 +1229,14 @@ private:
 
     uint64_t m_domTreeVersion;
     static uint64_t s_globalTreeVersion;
+
+    OwnPtr<SelectorQueryResultCache> m_selectorQueryResultCache;
     
     HashSet<NodeIterator*> m_nodeIterators;
     HashSet<Range*> m_ranges;
 
     unsigned short m_listenerTypes;
+    HashMap<AtomicString, unsigned> m_eventListenerCounts;
 
     RefPtr<StyleSheetList> m_styleSheets; // All of the stylesheets that are currently in effect for our media type and stylesheet set.
     
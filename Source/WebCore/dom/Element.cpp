@@ -680,8 +680,10 @@ void Element::setAttribute(const AtomicString& name, const AtomicString& value,
     else if (old && !value.isNull()) {
         if (Attr* attrNode = old->attr())
             attrNode->setValue(value);
-        else
+        else {
+            old = m_attributeMap->unsharedAttributeItem(old);
             old->setValue(value);
+        }
         attributeChanged(old);
     }
 
@@ -713,8 +715,10 @@ void Element::setAttribute(const QualifiedName& name, const AtomicString& value,
     else if (old) {
         if (Attr* attrNode = old->attr())
             attrNode->setValue(value);
-        else
+        else {
+            old = m_attributeMap->unsharedAttributeItem(old);
             old->setValue(value);
+        }
         attributeChanged(old);
     }
 
@@ -739,6 +743,9 @@ void Element::attributeChanged(Attribute* attr, bool)
 
 void Element::updateAfterAttributeChanged(Attribute* attr)
 {
+    if (document()->hasNodeListCaches())
+        notifyNodeListsAttributeChanged(attr->name());
+
     if (!AXObjectCache::accessibilityEnabled())
         return;
 
@@ -832,7 +839,7 @@ void Element::setAttributeMap(PassRefPtr<NamedNodeMap> list, FragmentScriptingPe
                 }
 
                 if (isAttributeToRemove(attributeName, m_attributeMap->m_attributes[i]->value()))
-                    m_attributeMap->m_attributes[i]->setValue(nullAtom);
+                    m_attributeMap->unsharedAttributeItem(i)->setValue(nullAtom);
                 i++;
             }
         }
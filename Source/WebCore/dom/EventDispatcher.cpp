@@ -26,6 +26,7 @@
 #include "config.h"
 #include "EventDispatcher.h"
 
+#include "Document.h"
 #include "Event.h"
 #include "EventContext.h"
 #include "EventTarget.h"
@@ -51,6 +52,102 @@ namespace WebCore {
 
 static HashSet<Node*>* gNodesDispatchingSimulatedClicks = 0;
 
+// Streams of events such as mousemove, touchmove and scroll tend to hit the same few targets over
+// and over, so the ancestor chains of recent targets are kept around. An entry is only valid for
+// the DOM tree version it was recorded at; every tree mutation bumps that version. Paths that
+// cross shadow boundaries or involve SVG are never cached, since their retargeting depends on
+// more than the tree structure. The cached nodes are referenced so that a freed target whose
+// address gets reused can never match a stale entry; the entries of a document are dropped when
+// it is detached so that the cache does not keep it alive.
+struct CachedEventPath {
+    RefPtr<Node> target;
+    uint64_t domTreeVersion;
+    Vector<RefPtr<Node> > ancestors;
+};
+
+static const size_t eventPathCacheCapacity = 4;
+static Vector<CachedEventPath>* gEventPathCache = 0;
+static size_t gNextEventPathCacheVictim = 0;
+
+static bool findCachedEventPath(Node* target, Vector<EventContext>& ancestors)
+{
+    if (!gEventPathCache)
+        return false;
+
+    uint64_t domTreeVersion = target->document()->domTreeVersion();
+    size_t cacheSize = gEventPathCache->size();
+    for (size_t i = 0; i < cacheSize; ++i) {
+        const CachedEventPath& path = gEventPathCache->at(i);
+        if (path.target != target || path.domTreeVersion != domTreeVersion)
+            continue;
+
+        size_t size = path.ancestors.size();
+        ancestors.reserveInitialCapacity(size);
+        for (size_t j = 0; j < size; ++j) {
+            Node* ancestor = path.ancestors[j].get();
+            ancestors.append(EventContext(ancestor, ancestor, target));
+        }
+        return true;
+    }
+    return false;
+}
+
+static void cacheEventPath(Node* target, const Vector<EventContext>& ancestors)
+{
+    if (!gEventPathCache)
+        gEventPathCache = new Vector<CachedEventPath>;
+
+    // Prefer to overwrite a stale entry for the same target so that one busy target
+    // does not push everything else out of the cache.
+    size_t slot = notFound;
+    size_t cacheSize = gEventPathCache->size();
+    for (size_t i = 0; i < cacheSize; ++i) {
+        if (gEventPathCache->at(i).target == target) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == notFound) {
+        if (cacheSize < eventPathCacheCapacity) {
+            slot = cacheSize;
+            gEventPathCache->grow(cacheSize + 1);
+        } else {
+            slot = gNextEventPathCacheVictim;
+            gNextEventPathCacheVictim = (gNextEventPathCacheVictim + 1) % eventPathCacheCapacity;
+        }
+    }
+
+    CachedEventPath& path = gEventPathCache->at(slot);
+    path.target = target;
+    path.domTreeVersion = target->document()->domTreeVersion();
+    path.ancestors.resize(ancestors.size());
+    for (size_t i = 0; i < ancestors.size(); ++i)
+        path.ancestors[i] = ancestors[i].node();
+}
+
+void EventDispatcher::documentDetached(Document* document)
+{
+    if (!gEventPathCache)
+        return;
+
+    for (size_t i = gEventPathCache->size(); i > 0; --i) {
+        if (gEventPathCache->at(i - 1).target->document() == document)
+            gEventPathCache->remove(i - 1);
+    }
+    gNextEventPathCacheVictim = 0;
+}
+
+// Whether any node of the document may have a listener for the event. HTMLFormElement::handleLocalEvents()
+// stops submit and reset events from propagating out of nested forms even when nothing listens for them,
+// so those are always delivered to every node on the path.
+static inline bool nodesMayHaveListeners(Document* document, Event* event)
+{
+    const AtomicString& eventType = event->type();
+    if (eventType == eventNames().submitEvent || eventType == eventNames().resetEvent)
+        return true;
+    return document->hasEventListenersOfType(eventType);
+}
+
 bool EventDispatcher::dispatchEvent(Node* node, const EventDispatchMediator& mediator)
 {
     ASSERT(!eventDispatchForbidden());
@@ -244,12 +341,17 @@ void EventDispatcher::ensureEventAncestors(Event* event)
 
     m_ancestorsInitialized = true;
 
+    if (findCachedEventPath(m_node.get(), m_ancestors))
+        return;
+
     Node* ancestor = m_node.get();
     EventTarget* target = eventTargetRespectingSVGTargetRules(ancestor);
     bool shouldSkipNextAncestor = false;
+    bool pathIsCacheable = !ancestor->isSVGElement();
     while (true) {
         bool isSVGShadowRoot = ancestor->isSVGShadowRoot();
         if (isSVGShadowRoot || ancestor->isShadowRoot()) {
+            pathIsCacheable = false;
             if (behavior == StayInsideShadowDOM)
                 return;
 #if ENABLE(SVG)
@@ -262,8 +364,14 @@ void EventDispatcher::ensureEventAncestors(Event* event)
         } else
             ancestor = ancestor->parentNodeGuaranteedHostFree();
 
-        if (!ancestor)
+        if (!ancestor) {
+            if (pathIsCacheable)
+                cacheEventPath(m_node.get(), m_ancestors);
             return;
+        }
+
+        if (ancestor->isSVGElement())
+            pathIsCacheable = false;
 
 #if ENABLE(SVG)
         // Skip SVGShadowTreeRootElement.
@@ -287,6 +395,12 @@ bool EventDispatcher::dispatchEvent(PassRefPtr<Event> event)
     RefPtr<EventTarget> originalTarget = event->target();
     ensureEventAncestors(event.get());
 
+    // Every node on the path belongs to this document. Only event handlers can add listeners, so the
+    // answer needs to be refreshed only after handlers that actually ran: the window's ones, or the
+    // nodes' own, which are only visited when the answer was already yes.
+    RefPtr<Document> document = m_node->document();
+    bool mayHaveListeners;
+
     WindowEventContext windowContext(event.get(), m_node.get(), topEventContext());
 
     InspectorInstrumentationCookie cookie = InspectorInstrumentation::willDispatchEvent(m_node->document(), *event, windowContext.window(), m_node.get(), m_ancestors);
@@ -302,7 +416,8 @@ bool EventDispatcher::dispatchEvent(PassRefPtr<Event> event)
     if (windowContext.handleLocalEvents(event.get()) && event->propagationStopped())
         goto doneDispatching;
 
-    for (size_t i = m_ancestors.size(); i; --i) {
+    mayHaveListeners = nodesMayHaveListeners(document.get(), event.get());
+    for (size_t i = m_ancestors.size(); i && mayHaveListeners; --i) {
         m_ancestors[i - 1].handleLocalEvents(event.get());
         if (event->propagationStopped())
             goto doneDispatching;
@@ -311,7 +426,8 @@ bool EventDispatcher::dispatchEvent(PassRefPtr<Event> event)
     event->setEventPhase(Event::AT_TARGET);
     event->setTarget(originalTarget.get());
     event->setCurrentTarget(eventTargetRespectingSVGTargetRules(m_node.get()));
-    m_node->handleLocalEvents(event.get());
+    if (mayHaveListeners || m_node->document() != document)
+        m_node->handleLocalEvents(event.get());
     if (event->propagationStopped())
         goto doneDispatching;
 
@@ -319,7 +435,7 @@ bool EventDispatcher::dispatchEvent(PassRefPtr<Event> event)
         // Trigger bubbling event handlers, starting at the bottom and working our way up.
         event->setEventPhase(Event::BUBBLING_PHASE);
 
-        size_t size = m_ancestors.size();
+        size_t size = mayHaveListeners ? m_ancestors.size() : 0;
         for (size_t i = 0; i < size; ++i) {
             m_ancestors[i].handleLocalEvents(event.get());
             if (event->propagationStopped() || event->cancelBubble())
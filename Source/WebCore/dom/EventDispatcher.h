@@ -31,6 +31,7 @@
 
 namespace WebCore {
 
+class Document;
 class Event;
 class EventContext;
 class EventDispatchMediator;
@@ -53,6 +54,9 @@ public:
 
     static void dispatchSimulatedClick(Node*, PassRefPtr<Event> underlyingEvent, bool sendMouseEvents, bool showPressedLook);
 
+    // Drops the cached event paths through the nodes of a document that is going away.
+    static void documentDetached(Document*);
+
     bool dispatchEvent(PassRefPtr<Event>);
     PassRefPtr<EventTarget> adjustRelatedTarget(Event*, PassRefPtr<EventTarget>);
     Node* node() const;
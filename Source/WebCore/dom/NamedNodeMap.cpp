@@ -60,7 +60,7 @@ PassRefPtr<Node> NamedNodeMap::getNamedItem(const String& name) const
     if (!a)
         return 0;
     
-    return a->createAttrIfNeeded(m_element);
+    return createAttrIfNeeded(a);
 }
 
 PassRefPtr<Node> NamedNodeMap::getNamedItemNS(const String& namespaceURI, const String& localName) const
@@ -90,7 +90,7 @@ PassRefPtr<Node> NamedNodeMap::getNamedItem(const QualifiedName& name) const
     if (!a)
         return 0;
 
-    return a->createAttrIfNeeded(m_element);
+    return createAttrIfNeeded(a);
 }
 
 PassRefPtr<Node> NamedNodeMap::setNamedItem(Node* arg, ExceptionCode& ec)
@@ -125,7 +125,7 @@ PassRefPtr<Node> NamedNodeMap::setNamedItem(Node* arg, ExceptionCode& ec)
     // ### slightly inefficient - resizes attribute array twice.
     RefPtr<Node> r;
     if (old) {
-        r = old->createAttrIfNeeded(m_element);
+        r = createAttrIfNeeded(old);
         removeAttribute(a->name());
     }
 
@@ -149,7 +149,7 @@ PassRefPtr<Node> NamedNodeMap::removeNamedItem(const QualifiedName& name, Except
         return 0;
     }
 
-    RefPtr<Attr> r = a->createAttrIfNeeded(m_element);
+    RefPtr<Attr> r = createAttrIfNeeded(a);
 
     if (r->isId())
         m_element->updateId(a->value(), nullAtom);
@@ -163,7 +163,35 @@ PassRefPtr<Node> NamedNodeMap::item(unsigned index) const
     if (index >= length())
         return 0;
 
-    return m_attributes[index]->createAttrIfNeeded(m_element);
+    return createAttrIfNeeded(m_attributes[index].get());
+}
+
+PassRefPtr<Attr> NamedNodeMap::createAttrIfNeeded(Attribute* attribute) const
+{
+    // An Attr modifies its Attribute directly, so it must own it.
+    if (attribute->isShared())
+        attribute = const_cast<NamedNodeMap*>(this)->unsharedAttributeItem(attribute);
+    return attribute->createAttrIfNeeded(m_element);
+}
+
+Attribute* NamedNodeMap::unsharedAttributeItem(unsigned index)
+{
+    Attribute* attribute = m_attributes[index].get();
+    if (!attribute->isShared())
+        return attribute;
+
+    m_attributes[index] = attribute->clone();
+    return m_attributes[index].get();
+}
+
+Attribute* NamedNodeMap::unsharedAttributeItem(Attribute* attribute)
+{
+    if (!attribute->isShared())
+        return attribute;
+
+    size_t index = m_attributes.find(attribute);
+    ASSERT(index != notFound);
+    return unsharedAttributeItem(index);
 }
 
 void NamedNodeMap::copyAttributesToVector(Vector<RefPtr<Attribute> >& copy)
@@ -282,6 +310,10 @@ void NamedNodeMap::removeAttribute(const QualifiedName& name)
 
     m_attributes.remove(index);
 
+    // Its value is cleared temporarily below, which must not be seen by other elements.
+    if (attr->isShared())
+        attr = attr->clone();
+
     // Notify the element that the attribute has been removed
     // dispatch appropriate mutation events
     if (m_element && !attr->m_value.isNull()) {
@@ -68,6 +68,12 @@ public:
     Attribute* attributeItem(unsigned index) const { return m_attributes[index].get(); }
     Attribute* getAttributeItem(const QualifiedName&) const;
 
+    // Parser-created attributes may be shared with other elements; see Attribute::isShared().
+    // These return the attribute after replacing it with a private copy if it is shared, and
+    // must be used before an attribute is modified in place.
+    Attribute* unsharedAttributeItem(unsigned index);
+    Attribute* unsharedAttributeItem(Attribute*);
+
     void copyAttributesToVector(Vector<RefPtr<Attribute> >&);
 
     void shrinkToLength() { m_attributes.shrinkCapacity(length()); }
@@ -81,6 +87,14 @@ public:
             addAttribute(newAttribute);
     }
 
+    // Used during parsing: swaps in an identical attribute that is shared with other elements.
+    void parserReplaceAttributeItem(unsigned index, PassRefPtr<Attribute> sharedAttribute)
+    {
+        ASSERT(!m_element);
+        ASSERT(sharedAttribute->name() == m_attributes[index]->name() && sharedAttribute->value() == m_attributes[index]->value());
+        m_attributes[index] = sharedAttribute;
+    }
+
     const AtomicString& idForStyleResolution() const { return m_idForStyleResolution; }
     void setIdForStyleResolution(const AtomicString& newId) { m_idForStyleResolution = newId; }
 
@@ -109,6 +123,7 @@ private:
     {
     }
 
+    PassRefPtr<Attr> createAttrIfNeeded(Attribute*) const;
     void detachAttributesFromElement();
     void detachFromElement();
     Attribute* getAttributeItem(const String& name, bool shouldIgnoreAttributeCase) const;
@@ -119,7 +134,8 @@ private:
     int m_mappedAttributeCount;
     SpaceSplitString m_classNames;
     Element* m_element;
-    Vector<RefPtr<Attribute> > m_attributes;
+    // Most elements have one or two attributes, which then live inside the map itself.
+    Vector<RefPtr<Attribute>, 2> m_attributes;
     AtomicString m_idForStyleResolution;
 };
 
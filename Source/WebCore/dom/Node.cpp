@@ -122,7 +122,16 @@
 #include <runtime/JSGlobalData.h>
 #endif
 
+#ifndef DUMP_NODE_STATISTICS
 #define DUMP_NODE_STATISTICS 0
+#endif
+
+#if DUMP_NODE_STATISTICS
+#include <algorithm>
+#if USE(SYSTEM_MALLOC) && OS(LINUX)
+#include <malloc.h>
+#endif
+#endif
 
 using namespace std;
 
@@ -137,6 +146,65 @@ bool Node::isSupported(const String& feature, const String& version)
 
 #if DUMP_NODE_STATISTICS
 static HashSet<Node*> liveNodeSet;
+
+#ifdef ANDROID_DOM_LOGGING
+#define NODE_STATISTICS_LOG(...) DUMP_DOM_LOGD(__VA_ARGS__)
+#else
+#define NODE_STATISTICS_LOG(...) printf(__VA_ARGS__)
+#endif
+
+// Number of bytes the allocator actually handed out for the block at p, or 0 if it cannot tell.
+static size_t allocationSize(const void* p)
+{
+    if (!p)
+        return 0;
+#if USE(SYSTEM_MALLOC) && OS(LINUX)
+    return malloc_usable_size(const_cast<void*>(p));
+#else
+    size_t size = fastMallocSize(p);
+    return size > 1 ? size : 0;
+#endif
+}
+
+struct NodeClassStatistics {
+    NodeClassStatistics()
+        : count(0)
+        , nodeBytes(0)
+        , nodesWithRareData(0)
+        , rareDataBytes(0)
+        , attributeBytes(0)
+    {
+    }
+
+    size_t totalBytes() const { return nodeBytes + rareDataBytes + attributeBytes; }
+
+    size_t count;
+    size_t nodeBytes;
+    size_t nodesWithRareData;
+    size_t rareDataBytes;
+    size_t attributeBytes;
+};
+
+typedef HashMap<String, NodeClassStatistics> NodeClassStatisticsMap;
+
+// Without RTTI, elements are told apart by namespace and tag name, which maps
+// closely enough to their C++ classes; other nodes go by their node name.
+static String statisticsClassName(Node* node)
+{
+    if (node->isElementNode()) {
+        Element* element = static_cast<Element*>(node);
+        const char* kind = element->isHTMLElement() ? "HTML" : element->isSVGElement() ? "SVG" : "XML";
+        return String(kind) + " <" + element->localName() + ">";
+    }
+    if (node->nodeType() == Node::DOCUMENT_TYPE_NODE)
+        return "#doctype";
+    return node->nodeName();
+}
+
+static bool totalBytesGreaterThan(const pair<String, NodeClassStatistics>& a, const pair<String, NodeClassStatistics>& b)
+{
+    return a.second.totalBytes() > b.second.totalBytes();
+}
 #endif
 
 void Node::dumpStatistics()
@@ -159,18 +227,30 @@ void Node::dumpStatistics()
     size_t xpathNSNodes = 0;
 
     HashMap<String, size_t> perTagCount;
+    NodeClassStatisticsMap perClassStatistics;
+    HashSet<Attribute*> countedAttributes;
 
     size_t attributes = 0;
     size_t mappedAttributes = 0;
     size_t mappedAttributesWithStyleDecl = 0;
     size_t attributesWithAttr = 0;
+    size_t sharedAttributes = 0;
     size_t attrMaps = 0;
 
     for (HashSet<Node*>::iterator it = liveNodeSet.begin(); it != liveNodeSet.end(); ++it) {
         Node* node = *it;
 
-        if (node->hasRareData())
+        NodeClassStatistics& classStatistics = perClassStatistics.add(statisticsClassName(node), NodeClassStatistics()).first->second;
+        ++classStatistics.count;
+        classStatistics.nodeBytes += allocationSize(node);
+
+        if (node->hasRareData()) {
             ++nodesWithRareData;
+            ++classStatistics.nodesWithRareData;
+            NodeRareData* rareData = node->rareData();
+            classStatistics.rareDataBytes += allocationSize(rareData) + allocationSize(rareData->nodeLists());
+        }
+        classStatistics.rareDataBytes += allocationSize(node->eventTargetData());
 
         switch (node->nodeType()) {
             case ELEMENT_NODE: {
@@ -186,8 +266,14 @@ void Node::dumpStatistics()
                 if (NamedNodeMap* attrMap = element->attributes(true)) {
                     attributes += attrMap->length();
                     ++attrMaps;
+                    classStatistics.attributeBytes += allocationSize(attrMap);
                     for (unsigned i = 0; i < attrMap->length(); ++i) {
                         Attribute* attr = attrMap->attributeItem(i);
+                        // Shared attributes are charged to the first element found holding them.
+                        if (countedAttributes.add(attr).second)
+                            classStatistics.attributeBytes += allocationSize(attr);
+                        else
+                            ++sharedAttributes;
                         if (attr->attr())
                             ++attributesWithAttr;
                         if (attr->isMappedAttribute()) {
@@ -250,34 +336,54 @@ void Node::dumpStatistics()
         }
     }
 
-    printf("Number of Nodes: %d\n\n", liveNodeSet.size());
-    printf("Number of Nodes with RareData: %zu\n\n", nodesWithRareData);
-
-    printf("NodeType distrubution:\n");
-    printf("  Number of Element nodes: %zu\n", elementNodes);
-    printf("  Number of Attribute nodes: %zu\n", attrNodes);
-    printf("  Number of Text nodes: %zu\n", textNodes);
-    printf("  Number of CDATASection nodes: %zu\n", cdataNodes);
-    printf("  Number of Comment nodes: %zu\n", commentNodes);
-    printf("  Number of EntityReference nodes: %zu\n", entityReferenceNodes);
-    printf("  Number of Entity nodes: %zu\n", entityNodes);
-    printf("  Number of ProcessingInstruction nodes: %zu\n", piNodes);
-    printf("  Number of Document nodes: %zu\n", documentNodes);
-    printf("  Number of DocumentType nodes: %zu\n", docTypeNodes);
-    printf("  Number of DocumentFragment nodes: %zu\n", fragmentNodes);
-    printf("  Number of Notation nodes: %zu\n", notationNodes);
-    printf("  Number of XPathNS nodes: %zu\n", xpathNSNodes);
-
-    printf("Element tag name distibution:\n");
+    NODE_STATISTICS_LOG("Number of Nodes: %zu\n\n", liveNodeSet.size());
+    NODE_STATISTICS_LOG("Number of Nodes with RareData: %zu [%zu]\n\n", nodesWithRareData, sizeof(NodeRareData));
+
+    NODE_STATISTICS_LOG("NodeType distrubution:\n");
+    NODE_STATISTICS_LOG("  Number of Element nodes: %zu\n", elementNodes);
+    NODE_STATISTICS_LOG("  Number of Attribute nodes: %zu\n", attrNodes);
+    NODE_STATISTICS_LOG("  Number of Text nodes: %zu\n", textNodes);
+    NODE_STATISTICS_LOG("  Number of CDATASection nodes: %zu\n", cdataNodes);
+    NODE_STATISTICS_LOG("  Number of Comment nodes: %zu\n", commentNodes);
+    NODE_STATISTICS_LOG("  Number of EntityReference nodes: %zu\n", entityReferenceNodes);
+    NODE_STATISTICS_LOG("  Number of Entity nodes: %zu\n", entityNodes);
+    NODE_STATISTICS_LOG("  Number of ProcessingInstruction nodes: %zu\n", piNodes);
+    NODE_STATISTICS_LOG("  Number of Document nodes: %zu\n", documentNodes);
+    NODE_STATISTICS_LOG("  Number of DocumentType nodes: %zu\n", docTypeNodes);
+    NODE_STATISTICS_LOG("  Number of DocumentFragment nodes: %zu\n", fragmentNodes);
+    NODE_STATISTICS_LOG("  Number of Notation nodes: %zu\n", notationNodes);
+    NODE_STATISTICS_LOG("  Number of XPathNS nodes: %zu\n", xpathNSNodes);
+
+    NODE_STATISTICS_LOG("Element tag name distibution:\n");
     for (HashMap<String, size_t>::iterator it = perTagCount.begin(); it != perTagCount.end(); ++it)
-        printf("  Number of <%s> tags: %zu\n", it->first.utf8().data(), it->second);
-
-    printf("Attribute Maps:\n");
-    printf("  Number of Attributes (non-Node and Node): %zu [%zu]\n", attributes, sizeof(Attribute));
-    printf("  Number of Attributes that are mapped: %zu\n", mappedAttributes);
-    printf("  Number of Attributes with a StyleDeclaration: %zu\n", mappedAttributesWithStyleDecl);
-    printf("  Number of Attributes with an Attr: %zu\n", attributesWithAttr);
-    printf("  Number of NamedNodeMaps: %zu [%zu]\n", attrMaps, sizeof(NamedNodeMap));
+        NODE_STATISTICS_LOG("  Number of <%s> tags: %zu\n", it->first.utf8().data(), it->second);
+
+    NODE_STATISTICS_LOG("Attribute Maps:\n");
+    NODE_STATISTICS_LOG("  Number of Attributes (non-Node and Node): %zu [%zu]\n", attributes, sizeof(Attribute));
+    NODE_STATISTICS_LOG("  Number of Attributes that are mapped: %zu\n", mappedAttributes);
+    NODE_STATISTICS_LOG("  Number of Attributes with a StyleDeclaration: %zu\n", mappedAttributesWithStyleDecl);
+    NODE_STATISTICS_LOG("  Number of Attributes with an Attr: %zu\n", attributesWithAttr);
+    NODE_STATISTICS_LOG("  Number of Attributes shared with another element: %zu\n", sharedAttributes);
+    NODE_STATISTICS_LOG("  Number of NamedNodeMaps: %zu [%zu]\n", attrMaps, sizeof(NamedNodeMap));
+
+    // Bytes are as reported by the allocator, so they include its rounding. Rare data covers
+    // NodeRareData with its node list and event listener tables; attributes cover the
+    // NamedNodeMap and its Attributes, but not mapped style declarations.
+    Vector<pair<String, NodeClassStatistics> > sortedStatistics;
+    for (NodeClassStatisticsMap::iterator it = perClassStatistics.begin(); it != perClassStatistics.end(); ++it)
+        sortedStatistics.append(make_pair(it->first, it->second));
+    std::sort(sortedStatistics.begin(), sortedStatistics.end(), totalBytesGreaterThan);
+
+    size_t totalBytes = 0;
+    NODE_STATISTICS_LOG("Memory by node class (count, bytes per node, node bytes, with rare data, rare data bytes, attribute bytes, total bytes):\n");
+    for (size_t i = 0; i < sortedStatistics.size(); ++i) {
+        const NodeClassStatistics& classStatistics = sortedStatistics[i].second;
+        totalBytes += classStatistics.totalBytes();
+        NODE_STATISTICS_LOG("  %s: %zu, %zu, %zu, %zu, %zu, %zu, %zu\n", sortedStatistics[i].first.utf8().data(),
+            classStatistics.count, classStatistics.totalBytes() / classStatistics.count, classStatistics.nodeBytes,
+            classStatistics.nodesWithRareData, classStatistics.rareDataBytes, classStatistics.attributeBytes, classStatistics.totalBytes());
+    }
+    NODE_STATISTICS_LOG("Total bytes for nodes: %zu\n", totalBytes);
 #endif
 }
 
@@ -372,6 +478,29 @@ void Node::trackForDebugging()
 #endif
 }
 
+// Event listeners are often added to nodes that need no other rare data, so their
+// tables are kept in a map of their own instead of in NodeRareData.
+typedef HashMap<const Node*, EventTargetData*> EventTargetDataMap;
+
+static EventTargetDataMap& eventTargetDataMap()
+{
+    static EventTargetDataMap* dataMap = new EventTargetDataMap;
+    return *dataMap;
+}
+
+// Keeps the per-type listener counts of the documents in sync when a node carrying
+// listeners changes owner document or is destroyed.
+static void updateEventListenerCounts(EventTargetData* data, Document* oldDocument, Document* newDocument)
+{
+    EventListenerMap::iterator end = data->eventListenerMap.end();
+    for (EventListenerMap::iterator it = data->eventListenerMap.begin(); it != end; ++it) {
+        if (oldDocument)
+            oldDocument->didRemoveEventListeners(it->first, it->second->size());
+        if (newDocument)
+            newDocument->didAddEventListeners(it->first, it->second->size());
+    }
+}
+
 Node::~Node()
 {
 #ifndef NDEBUG
@@ -399,6 +528,16 @@ Node::~Node()
         dataMap.remove(it);
     }
 
+    if (!hasEventTargetData())
+        ASSERT(!eventTargetDataMap().contains(this));
+    else {
+        EventTargetData* data = eventTargetDataMap().take(this);
+        ASSERT(data);
+        if (m_document)
+            updateEventListenerCounts(data, m_document, 0);
+        delete data;
+    }
+
     if (renderer())
         detach();
 
@@ -459,6 +598,9 @@ void Node::setDocument(Document* document)
         document->addNodeListCache();
     }
 
+    if (EventTargetData* data = eventTargetData())
+        updateEventListenerCounts(data, m_document, document);
+
     if (m_document) {
         m_document->moveNodeIteratorsToNewDocument(this, document);
         m_document->guardDeref();
@@ -586,7 +728,8 @@ void Node::setTabIndexExplicitly(short i)
 
 void Node::clearTabIndexExplicitly()
 {
-    ensureRareData()->clearTabIndexExplicitly();
+    if (hasRareData())
+        rareData()->clearTabIndexExplicitly();
 }
 
 String Node::nodeValue() const
@@ -613,6 +756,8 @@ PassRefPtr<NodeList> Node::childNodes()
         if (document())
             document()->addNodeListCache();
     }
+    if (!data->nodeLists()->m_childNodeListCaches)
+        data->nodeLists()->m_childNodeListCaches = DynamicNodeList::Caches::create();
 
     return ChildNodeList::create(this, data->nodeLists()->m_childNodeListCaches.get());
 }
@@ -923,14 +1068,7 @@ void Node::lazyAttach(ShouldSetAttached shouldSetAttached)
 
 void Node::setFocus(bool b)
 { 
-    if (b || hasRareData())
-        ensureRareData()->setFocused(b);
-}
-
-bool Node::rareDataFocused() const
-{
-    ASSERT(hasRareData());
-    return rareData()->isFocused();
+    setFlag(b, IsFocusedFlag);
 }
 
 bool Node::supportsFocus() const
@@ -1007,7 +1145,7 @@ void Node::unregisterDynamicNodeList(DynamicNodeList* list)
     }
 }
 
-void Node::notifyLocalNodeListsAttributeChanged()
+void Node::notifyLocalNodeListsAttributeChanged(const QualifiedName& attrName)
 {
     if (!hasRareData())
         return;
@@ -1015,10 +1153,7 @@ void Node::notifyLocalNodeListsAttributeChanged()
     if (!data->nodeLists())
         return;
 
-    if (!isAttributeNode())
-        data->nodeLists()->invalidateCachesThatDependOnAttributes();
-    else
-        data->nodeLists()->invalidateCaches();
+    data->nodeLists()->invalidateCachesThatDependOnAttribute(attrName);
 
     if (data->nodeLists()->isEmpty()) {
         data->clearNodeLists();
@@ -1026,10 +1161,11 @@ void Node::notifyLocalNodeListsAttributeChanged()
     }
 }
 
-void Node::notifyNodeListsAttributeChanged()
+void Node::notifyNodeListsAttributeChanged(const QualifiedName& attrName)
 {
-    for (Node *n = this; n; n = n->parentNode())
-        n->notifyLocalNodeListsAttributeChanged();
+    // A list never contains its own root, so only lists rooted at a proper ancestor can observe the change.
+    for (Node* n = parentNode(); n; n = n->parentNode())
+        n->notifyLocalNodeListsAttributeChanged(attrName);
 }
 
 void Node::notifyLocalNodeListsChildrenChanged()
@@ -1766,6 +1902,12 @@ PassRefPtr<Element> Node::querySelector(const String& selectors, ExceptionCode&
         ec = SYNTAX_ERR;
         return 0;
     }
+
+    SelectorQueryResultCache* cache = document()->selectorQueryResultCache();
+    RefPtr<Element> cachedResult;
+    if (cache && cache->findFirst(this, selectors, cachedResult))
+        return cachedResult.release();
+
     bool strictParsing = !document()->inQuirksMode();
     CSSParser p(strictParsing);
 
@@ -1783,28 +1925,10 @@ PassRefPtr<Element> Node::querySelector(const String& selectors, ExceptionCode&
         return 0;
     }
 
-    CSSStyleSelector::SelectorChecker selectorChecker(document(), strictParsing);
-
-    // FIXME: we could also optimize for the the [id="foo"] case
-    if (strictParsing && inDocument() && querySelectorList.hasOneSelector() && querySelectorList.first()->m_match == CSSSelector::Id) {
-        Element* element = document()->getElementById(querySelectorList.first()->value());
-        if (element && (isDocumentNode() || element->isDescendantOf(this)) && selectorChecker.checkSelector(querySelectorList.first(), element))
-            return element;
-        return 0;
-    }
-
-    // FIXME: We can speed this up by implementing caching similar to the one use by getElementById
-    for (Node* n = firstChild(); n; n = n->traverseNextNode(this)) {
-        if (n->isElementNode()) {
-            Element* element = static_cast<Element*>(n);
-            for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
-                if (selectorChecker.checkSelector(selector, element))
-                    return element;
-            }
-        }
-    }
-    
-    return 0;
+    Element* result = findFirstSelectorMatch(this, querySelectorList);
+    if (selectorListIsCacheable(querySelectorList))
+        document()->ensureSelectorQueryResultCache()->addFirst(this, selectors, result);
+    return result;
 }
 
 PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCode& ec)
@@ -1813,6 +1937,12 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         ec = SYNTAX_ERR;
         return 0;
     }
+
+    if (SelectorQueryResultCache* cache = document()->selectorQueryResultCache()) {
+        if (RefPtr<StaticNodeList> cachedResult = cache->findAll(this, selectors))
+            return cachedResult.release();
+    }
+
     bool strictParsing = !document()->inQuirksMode();
     CSSParser p(strictParsing);
 
@@ -1830,7 +1960,10 @@ PassRefPtr<NodeList> Node::querySelectorAll(const String& selectors, ExceptionCo
         return 0;
     }
 
-    return createSelectorNodeList(this, querySelectorList);
+    RefPtr<StaticNodeList> result = createSelectorNodeList(this, querySelectorList);
+    if (selectorListIsCacheable(querySelectorList))
+        document()->ensureSelectorQueryResultCache()->addAll(this, selectors, result.get());
+    return result.release();
 }
 
 Document *Node::ownerDocument() const
@@ -2425,7 +2558,8 @@ void Node::formatForDebugger(char* buffer, unsigned length) const
 
 void NodeListsNodeData::invalidateCaches()
 {
-    m_childNodeListCaches->reset();
+    if (m_childNodeListCaches)
+        m_childNodeListCaches->reset();
 
     if (m_labelsNodeListCache)
         m_labelsNodeListCache->invalidateCache();
@@ -2448,12 +2582,28 @@ void NodeListsNodeData::invalidateCachesThatDependOnAttributes()
         m_labelsNodeListCache->invalidateCache();
 }
 
+void NodeListsNodeData::invalidateCachesThatDependOnAttribute(const QualifiedName& attrName)
+{
+    if (attrName == classAttr) {
+        ClassNodeListCache::iterator classCacheEnd = m_classNodeListCache.end();
+        for (ClassNodeListCache::iterator it = m_classNodeListCache.begin(); it != classCacheEnd; ++it)
+            it->second->invalidateCache();
+    } else if (attrName == nameAttr) {
+        NameNodeListCache::iterator nameCacheEnd = m_nameNodeListCache.end();
+        for (NameNodeListCache::iterator it = m_nameNodeListCache.begin(); it != nameCacheEnd; ++it)
+            it->second->invalidateCache();
+    }
+    if (m_labelsNodeListCache)
+        m_labelsNodeListCache->invalidateCache();
+}
+
 bool NodeListsNodeData::isEmpty() const
 {
     if (!m_listsWithCaches.isEmpty())
         return false;
 
-    if (m_childNodeListCaches->refCount())
+    // The caches are shared by all ChildNodeLists of the node; only our own reference means none is alive.
+    if (m_childNodeListCaches && !m_childNodeListCaches->hasOneRef())
         return false;
     
     TagNodeListCache::const_iterator tagCacheEnd = m_tagNodeListCache.end();
@@ -2552,8 +2702,10 @@ static inline bool tryAddEventListener(Node* targetNode, const AtomicString& eve
     if (!targetNode->EventTarget::addEventListener(eventType, listener, useCapture))
         return false;
 
-    if (Document* document = targetNode->document())
+    if (Document* document = targetNode->document()) {
         document->addListenerTypeIfNeeded(eventType);
+        document->didAddEventListeners(eventType);
+    }
 
     return true;
 }
@@ -2597,8 +2749,10 @@ static inline bool tryRemoveEventListener(Node* targetNode, const AtomicString&
     if (!targetNode->EventTarget::removeEventListener(eventType, listener, useCapture))
         return false;
 
-    // FIXME: Notify Document that the listener has vanished. We need to keep track of a number of
-    // listeners for each type, not just a bool - see https://bugs.webkit.org/show_bug.cgi?id=33861
+    // FIXME: Document::m_listenerTypes is still a set of bits, so mutation event listeners are never
+    // forgotten - see https://bugs.webkit.org/show_bug.cgi?id=33861
+    if (Document* document = targetNode->document())
+        document->didRemoveEventListeners(eventType);
 
     return true;
 }
@@ -2684,17 +2838,24 @@ bool Node::removeEventListener(const AtomicString& eventType, EventListener* lis
 
 EventTargetData* Node::eventTargetData()
 {
-    return hasRareData() ? rareData()->eventTargetData() : 0;
+    return hasEventTargetData() ? eventTargetDataMap().get(this) : 0;
 }
 
 EventTargetData* Node::ensureEventTargetData()
 {
-    return ensureRareData()->ensureEventTargetData();
+    if (hasEventTargetData())
+        return eventTargetDataMap().get(this);
+
+    ASSERT(!eventTargetDataMap().contains(this));
+    EventTargetData* data = new EventTargetData;
+    eventTargetDataMap().set(this, data);
+    setFlag(HasEventTargetDataFlag);
+    return data;
 }
 
 void Node::handleLocalEvents(Event* event)
 {
-    if (!hasRareData() || !rareData()->eventTargetData())
+    if (!hasEventTargetData())
         return;
 
     if (disabled() && event->isMouseEvent())
@@ -2719,7 +2880,11 @@ void Node::dispatchSubtreeModifiedEvent()
     
     document()->incDOMTreeVersion();
 
-    notifyNodeListsAttributeChanged(); // FIXME: Can do better some day. Really only care about the name attribute changing.
+    // Child list changes invalidate node lists in childrenChanged() and attribute changes in
+    // Element::updateAfterAttributeChanged(). An Attr does not use ContainerNode::childrenChanged(),
+    // so edits to its text children are picked up here.
+    if (isAttributeNode())
+        notifyLocalNodeListsChildrenChanged();
     
     if (!document()->hasListenerType(Document::DOMSUBTREEMODIFIED_LISTENER))
         return;
@@ -289,7 +289,7 @@ public:
     bool inActiveChain() const { return getFlag(InActiveChainFlag); }
     bool inDetach() const { return getFlag(InDetachFlag); }
     bool hovered() const { return getFlag(IsHoveredFlag); }
-    bool focused() const { return hasRareData() ? rareDataFocused() : false; }
+    bool focused() const { return getFlag(IsFocusedFlag); }
     bool attached() const { return getFlag(IsAttachedFlag); }
     void setAttached() { setFlag(IsAttachedFlag); }
     bool needsStyleRecalc() const { return styleChangeType() != NoStyleChange; }
@@ -510,8 +510,8 @@ public:
     void unregisterDynamicNodeList(DynamicNodeList*);
     void notifyNodeListsChildrenChanged();
     void notifyLocalNodeListsChildrenChanged();
-    void notifyNodeListsAttributeChanged();
-    void notifyLocalNodeListsAttributeChanged();
+    void notifyNodeListsAttributeChanged(const QualifiedName&);
+    void notifyLocalNodeListsAttributeChanged(const QualifiedName&);
     void notifyLocalNodeListsLabelChanged();
     void removeCachedClassNodeList(ClassNodeList*, const String&);
     void removeCachedNameNodeList(NameNodeList*, const String&);
@@ -610,6 +610,9 @@ private:
 
         SelfOrAncestorHasDirAutoFlag = 1 << 27,
 
+        IsFocusedFlag = 1 << 28,
+        HasEventTargetDataFlag = 1 << 29,
+
 #if ENABLE(SVG)
         DefaultNodeFlags = IsParsingChildrenFinishedFlag | IsStyleAttributeValidFlag | AreSVGAttributesValidFlag
 #else
@@ -617,7 +620,7 @@ private:
 #endif
     };
 
-    // 4 bits remaining
+    // 2 bits remaining
 
     bool getFlag(NodeFlags mask) const { return m_nodeFlags & mask; }
     void setFlag(bool f, NodeFlags mask) const { m_nodeFlags = (m_nodeFlags & ~mask) | (-(int32_t)f & mask); } 
@@ -650,6 +653,7 @@ protected:
     void clearTabIndexExplicitly();
     
     bool hasRareData() const { return getFlag(HasRareDataFlag); }
+    bool hasEventTargetData() const { return getFlag(HasEventTargetDataFlag); }
 
     NodeRareData* rareData() const;
     NodeRareData* ensureRareData();
@@ -669,7 +673,6 @@ private:
     virtual void derefEventTarget();
 
     virtual NodeRareData* createRareData();
-    bool rareDataFocused() const;
 
     virtual RenderStyle* nonRendererRenderStyle() const;
 
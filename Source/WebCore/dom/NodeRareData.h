@@ -42,6 +42,7 @@ public:
     typedef HashSet<DynamicNodeList*> NodeListSet;
     NodeListSet m_listsWithCaches;
     
+    // Shared by the node's ChildNodeLists; created the first time childNodes() is asked for.
     RefPtr<DynamicNodeList::Caches> m_childNodeListCaches;
     
     typedef HashMap<String, ClassNodeList*> ClassNodeListCache;
@@ -62,11 +63,12 @@ public:
     
     void invalidateCaches();
     void invalidateCachesThatDependOnAttributes();
+    void invalidateCachesThatDependOnAttribute(const QualifiedName&);
     bool isEmpty() const;
 
 private:
     NodeListsNodeData()
-        : m_childNodeListCaches(DynamicNodeList::Caches::create()), m_labelsNodeListCache(0)
+        : m_labelsNodeListCache(0)
     {
     }
 };
@@ -78,7 +80,6 @@ public:
         : m_treeScope(0)
         , m_tabIndex(0)
         , m_tabIndexWasSetExplicitly(false)
-        , m_isFocused(false)
         , m_needsFocusAppearanceUpdateSoonAfterAttach(false)
     {
     }
@@ -112,17 +113,6 @@ public:
     bool tabIndexSetExplicitly() const { return m_tabIndexWasSetExplicitly; }
     void clearTabIndexExplicitly() { m_tabIndex = 0; m_tabIndexWasSetExplicitly = false; }
 
-    EventTargetData* eventTargetData() { return m_eventTargetData.get(); }
-    EventTargetData* ensureEventTargetData()
-    {
-        if (!m_eventTargetData)
-            m_eventTargetData.set(new EventTargetData);
-        return m_eventTargetData.get();
-    }
-
-    bool isFocused() const { return m_isFocused; }
-    void setFocused(bool focused) { m_isFocused = focused; }
-
 protected:
     // for ElementRareData
     bool needsFocusAppearanceUpdateSoonAfterAttach() const { return m_needsFocusAppearanceUpdateSoonAfterAttach; }
@@ -131,10 +121,8 @@ protected:
 private:
     TreeScope* m_treeScope;
     OwnPtr<NodeListsNodeData> m_nodeLists;
-    OwnPtr<EventTargetData> m_eventTargetData;
     short m_tabIndex;
     bool m_tabIndexWasSetExplicitly : 1;
-    bool m_isFocused : 1;
     bool m_needsFocusAppearanceUpdateSoonAfterAttach : 1;
 };
 
@@ -36,11 +36,53 @@
 #include "Element.h"
 #include "HTMLNames.h"
 #include "StaticNodeList.h"
+#include "StyledElement.h"
 
 namespace WebCore {
 
 using namespace HTMLNames;
 
+// A selector made of a single compound of tag, id and class tests can be checked without
+// going through the SelectorChecker.
+static bool isSimpleSelector(const CSSSelector* selector)
+{
+    if (selector->tagHistory())
+        return false;
+    return selector->m_match == CSSSelector::None || selector->m_match == CSSSelector::Id || selector->m_match == CSSSelector::Class;
+}
+
+// Must agree with SelectorChecker::checkOneSelector() for the selectors accepted by isSimpleSelector().
+static inline bool simpleSelectorMatches(const CSSSelector* selector, Element* element)
+{
+    if (selector->hasTag()) {
+        const QualifiedName& tag = selector->tag();
+        if (tag.localName() != starAtom && tag.localName() != element->localName())
+            return false;
+        if (tag.namespaceURI() != starAtom && tag.namespaceURI() != element->namespaceURI())
+            return false;
+    }
+    if (selector->m_match == CSSSelector::Class)
+        return element->hasClass() && static_cast<StyledElement*>(element)->classNames().contains(selector->value());
+    if (selector->m_match == CSSSelector::Id)
+        return element->hasID() && element->idForStyleResolution() == selector->value();
+    return true;
+}
+
+// Returns true and sets the result if the selector can be answered from the document's id map.
+static bool lookUpById(Node* rootNode, const CSSSelector* selector, const CSSStyleSelector::SelectorChecker& selectorChecker, bool strictParsing, Element*& result)
+{
+    Document* document = rootNode->document();
+    if (!strictParsing || !rootNode->inDocument() || selector->m_match != CSSSelector::Id || document->containsMultipleElementsWithId(selector->value()))
+        return false;
+
+    Element* element = document->getElementById(selector->value());
+    if (element && (rootNode->isDocumentNode() || element->isDescendantOf(rootNode)) && selectorChecker.checkSelector(const_cast<CSSSelector*>(selector), element))
+        result = element;
+    else
+        result = 0;
+    return true;
+}
+
 PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList& querySelectorList)
 {
     Vector<RefPtr<Node> > nodes;
@@ -50,10 +92,15 @@ PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelec
 
     CSSStyleSelector::SelectorChecker selectorChecker(document, strictParsing);
 
-    if (strictParsing && rootNode->inDocument() && onlySelector && onlySelector->m_match == CSSSelector::Id && !document->containsMultipleElementsWithId(onlySelector->value())) {
-        Element* element = document->getElementById(onlySelector->value());
-        if (element && (rootNode->isDocumentNode() || element->isDescendantOf(rootNode)) && selectorChecker.checkSelector(onlySelector, element))
-            nodes.append(element);
+    Element* elementWithId;
+    if (onlySelector && lookUpById(rootNode, onlySelector, selectorChecker, strictParsing, elementWithId)) {
+        if (elementWithId)
+            nodes.append(elementWithId);
+    } else if (onlySelector && isSimpleSelector(onlySelector)) {
+        for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
+            if (n->isElementNode() && simpleSelectorMatches(onlySelector, static_cast<Element*>(n)))
+                nodes.append(n);
+        }
     } else {
         for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
             if (n->isElementNode()) {
@@ -71,4 +118,143 @@ PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelec
     return StaticNodeList::adopt(nodes);
 }
 
+Element* findFirstSelectorMatch(Node* rootNode, const CSSSelectorList& querySelectorList)
+{
+    Document* document = rootNode->document();
+    CSSSelector* onlySelector = querySelectorList.hasOneSelector() ? querySelectorList.first() : 0;
+    bool strictParsing = !document->inQuirksMode();
+
+    CSSStyleSelector::SelectorChecker selectorChecker(document, strictParsing);
+
+    Element* elementWithId;
+    if (onlySelector && lookUpById(rootNode, onlySelector, selectorChecker, strictParsing, elementWithId))
+        return elementWithId;
+
+    if (onlySelector && isSimpleSelector(onlySelector)) {
+        for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
+            if (n->isElementNode() && simpleSelectorMatches(onlySelector, static_cast<Element*>(n)))
+                return static_cast<Element*>(n);
+        }
+        return 0;
+    }
+
+    for (Node* n = rootNode->firstChild(); n; n = n->traverseNextNode(rootNode)) {
+        if (n->isElementNode()) {
+            Element* element = static_cast<Element*>(n);
+            for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+                if (selectorChecker.checkSelector(selector, element))
+                    return element;
+            }
+        }
+    }
+
+    return 0;
+}
+
+bool selectorListIsCacheable(const CSSSelectorList& querySelectorList)
+{
+    for (CSSSelector* selector = querySelectorList.first(); selector; selector = CSSSelectorList::next(selector)) {
+        for (CSSSelector* component = selector; component; component = component->tagHistory()) {
+            if (component->m_match != CSSSelector::None && component->m_match != CSSSelector::Id && component->m_match != CSSSelector::Class)
+                return false;
+            if (component->relation() == CSSSelector::ShadowDescendant)
+                return false;
+        }
+    }
+    return true;
+}
+
+SelectorQueryResultCache::~SelectorQueryResultCache()
+{
+    deleteAllValues(m_entries);
+}
+
+void SelectorQueryResultCache::clear()
+{
+    deleteAllValues(m_entries);
+    m_entries.clear();
+    m_recentlyUsed.clear();
+}
+
+bool SelectorQueryResultCache::validate(Document* document)
+{
+    if (document->domTreeVersion() == m_domTreeVersion && document->inQuirksMode() == m_inQuirksMode)
+        return true;
+    clear();
+    m_domTreeVersion = document->domTreeVersion();
+    m_inQuirksMode = document->inQuirksMode();
+    return false;
+}
+
+SelectorQueryResultCache::Entry* SelectorQueryResultCache::find(Node* rootNode, const String& selectors)
+{
+    if (!validate(rootNode->document()))
+        return 0;
+    Key key(rootNode, selectors);
+    HashMap<Key, Entry*>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+        return 0;
+
+    // Move the key to the most recently used end.
+    m_recentlyUsed.remove(key);
+    m_recentlyUsed.add(key);
+    return it->second;
+}
+
+SelectorQueryResultCache::Entry* SelectorQueryResultCache::ensureEntry(Node* rootNode, const String& selectors)
+{
+    if (Entry* entry = find(rootNode, selectors))
+        return entry;
+
+    if (m_entries.size() >= maximumEntries) {
+        Key leastRecentlyUsed = m_recentlyUsed.first();
+        m_recentlyUsed.remove(leastRecentlyUsed);
+        delete m_entries.take(leastRecentlyUsed);
+    }
+
+    Key key(rootNode, selectors);
+    Entry* entry = new Entry(rootNode);
+    m_entries.set(key, entry);
+    m_recentlyUsed.add(key);
+    return entry;
+}
+
+PassRefPtr<StaticNodeList> SelectorQueryResultCache::findAll(Node* rootNode, const String& selectors)
+{
+    Entry* entry = find(rootNode, selectors);
+    if (!entry || !entry->hasAllMatches)
+        return 0;
+
+    // Each call returns a new list, so copy the matches rather than sharing them.
+    Vector<RefPtr<Node> > nodes(entry->allMatches);
+    return StaticNodeList::adopt(nodes);
+}
+
+void SelectorQueryResultCache::addAll(Node* rootNode, const String& selectors, StaticNodeList* list)
+{
+    Entry* entry = ensureEntry(rootNode, selectors);
+    unsigned length = list->length();
+    entry->allMatches.clear();
+    entry->allMatches.reserveInitialCapacity(length);
+    for (unsigned i = 0; i < length; ++i)
+        entry->allMatches.uncheckedAppend(list->item(i));
+    entry->hasAllMatches = true;
+}
+
+bool SelectorQueryResultCache::findFirst(Node* rootNode, const String& selectors, RefPtr<Element>& result)
+{
+    Entry* entry = find(rootNode, selectors);
+    if (!entry || !entry->hasFirstMatch)
+        return false;
+    result = entry->firstMatch;
+    return true;
+}
+
+void SelectorQueryResultCache::addFirst(Node* rootNode, const String& selectors, Element* element)
+{
+    Entry* entry = ensureEntry(rootNode, selectors);
+    entry->firstMatch = element;
+    entry->hasFirstMatch = true;
+}
+
 } // namespace WebCore
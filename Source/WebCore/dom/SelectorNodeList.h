@@ -29,15 +29,76 @@
 #ifndef SelectorNodeList_h
 #define SelectorNodeList_h
 
+#include <wtf/HashMap.h>
+#include <wtf/ListHashSet.h>
+#include <wtf/PassOwnPtr.h>
 #include <wtf/PassRefPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Vector.h>
+#include <wtf/text/StringHash.h>
 
 namespace WebCore {
 
     class CSSSelectorList;
+    class Document;
+    class Element;
     class Node;
     class StaticNodeList;
 
     PassRefPtr<StaticNodeList> createSelectorNodeList(Node* rootNode, const CSSSelectorList&);
+    Element* findFirstSelectorMatch(Node* rootNode, const CSSSelectorList&);
+
+    // True if the selector list only tests tag names, ids and classes, so that its matches can
+    // only change when the DOM tree version of the document changes.
+    bool selectorListIsCacheable(const CSSSelectorList&);
+
+    // Remembers querySelector() and querySelectorAll() results for the nodes of one document.
+    // Entries are keyed by the root node and the selector string, hold references to the root and
+    // to the matched nodes, and are valid only while the DOM tree version and parsing mode they
+    // were computed for are current. The document clears the cache whenever a node is removed, so
+    // it never keeps a removed subtree alive. When the cache is full the least recently used
+    // entry is evicted.
+    class SelectorQueryResultCache {
+        WTF_MAKE_NONCOPYABLE(SelectorQueryResultCache); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        static PassOwnPtr<SelectorQueryResultCache> create() { return adoptPtr(new SelectorQueryResultCache); }
+        ~SelectorQueryResultCache();
+
+        PassRefPtr<StaticNodeList> findAll(Node* rootNode, const String& selectors);
+        void addAll(Node* rootNode, const String& selectors, StaticNodeList*);
+
+        bool findFirst(Node* rootNode, const String& selectors, RefPtr<Element>&);
+        void addFirst(Node* rootNode, const String& selectors, Element*);
+
+        void clear();
+
+    private:
+        SelectorQueryResultCache() : m_domTreeVersion(0), m_inQuirksMode(false) { }
+
+        typedef std::pair<Node*, String> Key;
+
+        struct Entry {
+            Entry(Node* rootNode) : rootNode(rootNode), hasAllMatches(false), hasFirstMatch(false) { }
+
+            RefPtr<Node> rootNode;
+            bool hasAllMatches;
+            bool hasFirstMatch;
+            Vector<RefPtr<Node> > allMatches;
+            RefPtr<Element> firstMatch;
+        };
+
+        bool validate(Document*);
+        Entry* find(Node* rootNode, const String& selectors);
+        Entry* ensureEntry(Node* rootNode, const String& selectors);
+
+        static const unsigned maximumEntries = 32;
+
+        uint64_t m_domTreeVersion;
+        bool m_inQuirksMode;
+        HashMap<Key, Entry*> m_entries;
+        // Least recently used key first.
+        ListHashSet<Key, maximumEntries> m_recentlyUsed;
+    };
 
 } // namespace WebCore
 
@@ -29,12 +29,11 @@ using namespace WTF;
 
 namespace WebCore {
 
-static bool hasNonASCIIOrUpper(const String& string)
+template<typename CharacterType>
+static bool hasNonASCIIOrUpper(const CharacterType* characters, unsigned length)
 {
-    const UChar* characters = string.characters();
-    unsigned length = string.length();
     bool hasUpper = false;
-    UChar ored = 0;
+    CharacterType ored = 0;
     for (unsigned i = 0; i < length; i++) {
         UChar c = characters[i];
         hasUpper |= isASCIIUpper(c);
@@ -43,6 +42,13 @@ static bool hasNonASCIIOrUpper(const String& string)
     return hasUpper || (ored & ~0x7F);
 }
 
+static bool hasNonASCIIOrUpper(const String& string)
+{
+    if (string.is8Bit())
+        return hasNonASCIIOrUpper(string.impl()->characters8(), string.length());
+    return hasNonASCIIOrUpper(string.characters(), string.length());
+}
+
 void SpaceSplitStringData::createVector()
 {
     ASSERT(!m_createdVector);
@@ -51,7 +57,13 @@ void SpaceSplitStringData::createVector()
     if (m_shouldFoldCase && hasNonASCIIOrUpper(m_string))
         m_string = m_string.foldCase();
 
-    const UChar* characters = m_string.characters();
+    if (m_string.isNull()) {
+        m_createdVector = true;
+        return;
+    }
+
+    // Class attributes are usually 8-bit; widen them only for as long as it takes to split them.
+    StringImpl::UpconvertedCharacters characters(m_string.impl());
     unsigned length = m_string.length();
     unsigned start = 0;
     while (true) {
@@ -131,12 +131,16 @@ void XMLDocumentParser::append(const SegmentedString& s)
     if (isStopped() || m_sawXSLTransform)
         return;
 
+#if USE(QXMLSTREAM)
     if (m_parserPaused) {
+#else
+    if (m_parserPaused || isScheduledForResume()) {
+#endif
         m_pendingSrc.append(s);
         return;
     }
 
-    doWrite(s.toString());
+    doWrite(parseString);
 
     // After parsing, go ahead and dispatch image beforeload events.
     ImageLoader::dispatchPendingBeforeLoadEvents();
@@ -211,6 +215,9 @@ void XMLDocumentParser::exitText()
 
 void XMLDocumentParser::detach()
 {
+#if !USE(QXMLSTREAM)
+    m_continueParsingTimer.stop();
+#endif
     clearCurrentNodeStack();
     ScriptableDocumentParser::detach();
 }
@@ -248,7 +255,11 @@ void XMLDocumentParser::finish()
     // However, FrameLoader::stop calls Document::finishParsing unconditionally
     // which in turn calls m_parser->finish().
 
+#if USE(QXMLSTREAM)
     if (m_parserPaused)
+#else
+    if (m_parserPaused || isScheduledForResume())
+#endif
         m_finishCalled = true;
     else
         end();
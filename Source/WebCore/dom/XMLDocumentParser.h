@@ -139,6 +139,7 @@ bool parseXMLDocumentFragment(const String&, DocumentFragment*, Element* parent
 #include "FragmentScriptingPermission.h"
 #include "ScriptableDocumentParser.h"
 #include "SegmentedString.h"
+#include "Timer.h"
 #include <wtf/HashMap.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/text/StringHash.h>
@@ -286,6 +287,11 @@ public:
         void doWrite(const String&);
         void doEnd();
 
+#if !USE(QXMLSTREAM)
+        bool isScheduledForResume() const { return m_continueParsingTimer.isActive(); }
+        void continueParsingTimerFired(Timer<XMLDocumentParser>*);
+#endif
+
         FrameView* m_view;
 
         String m_originalSourceForTransform;
@@ -298,6 +304,8 @@ public:
         RefPtr<XMLParserContext> m_context;
         OwnPtr<PendingCallbacks> m_pendingCallbacks;
         Vector<xmlChar> m_bufferedText;
+        double m_parserTimeLimit;
+        Timer<XMLDocumentParser> m_continueParsingTimer;
 #endif
         Node* m_currentNode;
         Vector<Node*> m_currentNodeStack;
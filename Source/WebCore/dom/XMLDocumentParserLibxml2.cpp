@@ -42,6 +42,7 @@
 #include "HTMLLinkElement.h"
 #include "HTMLNames.h"
 #include "HTMLStyleElement.h"
+#include "Page.h"
 #include "ProcessingInstruction.h"
 #include "ResourceError.h"
 #include "ResourceHandle.h"
@@ -56,6 +57,7 @@
 #include "XMLDocumentParserScope.h"
 #include <libxml/parser.h>
 #include <libxml/parserInternals.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/text/CString.h>
 #include <wtf/StringExtras.h>
 #include <wtf/Threading.h>
@@ -74,12 +76,23 @@
 
 using namespace std;
 
+// Source is handed to libxml in slices of this many characters, so that parsing can
+// yield between slices and so that no more than one slice is turned into queued
+// callbacks while the parser is paused for a script.
+static const unsigned parserSliceLength = 8192;
+
+// Seconds the parser may run in one write() before yielding; matches HTMLParserScheduler.
+static const double defaultParserTimeLimit = 0.500;
+
 namespace WebCore {
 
 class PendingCallbacks {
     WTF_MAKE_NONCOPYABLE(PendingCallbacks);
 public:
-    PendingCallbacks() { }
+    PendingCallbacks()
+        : m_lastCharactersCallback(0)
+    {
+    }
     ~PendingCallbacks()
     {
         deleteAllValues(m_callbacks);
@@ -89,6 +102,7 @@ public:
                                       const xmlChar** namespaces, int nb_attributes, int nb_defaulted, const xmlChar** attributes)
     {
         PendingStartElementNSCallback* callback = new PendingStartElementNSCallback;
+        m_lastCharactersCallback = 0;
 
         callback->xmlLocalName = xmlStrdup(xmlLocalName);
         callback->xmlPrefix = xmlStrdup(xmlPrefix);
@@ -119,23 +133,33 @@ public:
     void appendEndElementNSCallback()
     {
         PendingEndElementNSCallback* callback = new PendingEndElementNSCallback;
+        m_lastCharactersCallback = 0;
 
         m_callbacks.append(callback);
     }
 
     void appendCharactersCallback(const xmlChar* s, int len)
     {
+        // libxml reports long runs of text in many small pieces; coalesce them so that
+        // replaying the queue appends to the text node once instead of once per piece.
+        if (m_lastCharactersCallback) {
+            m_lastCharactersCallback->append(s, len);
+            return;
+        }
+
         PendingCharactersCallback* callback = new PendingCharactersCallback;
 
         callback->s = xmlStrndup(s, len);
         callback->len = len;
 
         m_callbacks.append(callback);
+        m_lastCharactersCallback = callback;
     }
 
     void appendProcessingInstructionCallback(const xmlChar* target, const xmlChar* data)
     {
         PendingProcessingInstructionCallback* callback = new PendingProcessingInstructionCallback;
+        m_lastCharactersCallback = 0;
 
         callback->target = xmlStrdup(target);
         callback->data = xmlStrdup(data);
@@ -146,6 +170,7 @@ public:
     void appendCDATABlockCallback(const xmlChar* s, int len)
     {
         PendingCDATABlockCallback* callback = new PendingCDATABlockCallback;
+        m_lastCharactersCallback = 0;
 
         callback->s = xmlStrndup(s, len);
         callback->len = len;
@@ -156,6 +181,7 @@ public:
     void appendCommentCallback(const xmlChar* s)
     {
         PendingCommentCallback* callback = new PendingCommentCallback;
+        m_lastCharactersCallback = 0;
 
         callback->s = xmlStrdup(s);
 
@@ -165,6 +191,7 @@ public:
     void appendInternalSubsetCallback(const xmlChar* name, const xmlChar* externalID, const xmlChar* systemID)
     {
         PendingInternalSubsetCallback* callback = new PendingInternalSubsetCallback;
+        m_lastCharactersCallback = 0;
 
         callback->name = xmlStrdup(name);
         callback->externalID = xmlStrdup(externalID);
@@ -176,6 +203,7 @@ public:
     void appendErrorCallback(XMLDocumentParser::ErrorType type, const xmlChar* message, int lineNumber, int columnNumber)
     {
         PendingErrorCallback* callback = new PendingErrorCallback;
+        m_lastCharactersCallback = 0;
 
         callback->message = xmlStrdup(message);
         callback->type = type;
@@ -188,6 +216,8 @@ public:
     void callAndRemoveFirstCallback(XMLDocumentParser* parser)
     {
         OwnPtr<PendingCallback> callback(m_callbacks.takeFirst());
+        if (callback.get() == m_lastCharactersCallback)
+            m_lastCharactersCallback = 0;
         callback->call(parser);
     }
 
@@ -249,6 +279,14 @@ private:
             parser->characters(s, len);
         }
 
+        void append(const xmlChar* moreCharacters, int moreLength)
+        {
+            s = static_cast<xmlChar*>(xmlRealloc(s, len + moreLength + 1));
+            memcpy(s + len, moreCharacters, moreLength);
+            len += moreLength;
+            s[len] = 0;
+        }
+
         xmlChar* s;
         int len;
     };
@@ -334,6 +372,7 @@ private:
     };
 
     Deque<PendingCallback*> m_callbacks;
+    PendingCharactersCallback* m_lastCharactersCallback;
 };
 // --------------------------------
 
@@ -542,11 +581,21 @@ bool XMLDocumentParser::supportsXMLVersion(const String& version)
     return version == "1.0";
 }
 
+static double parserTimeLimit(Page* page)
+{
+    // Same setting the HTML parser uses to decide how long to run before yielding.
+    if (page && page->hasCustomHTMLTokenizerTimeDelay())
+        return page->customHTMLTokenizerTimeDelay();
+    return defaultParserTimeLimit;
+}
+
 XMLDocumentParser::XMLDocumentParser(Document* document, FrameView* frameView)
     : ScriptableDocumentParser(document)
     , m_view(frameView)
     , m_context(0)
     , m_pendingCallbacks(new PendingCallbacks)
+    , m_parserTimeLimit(parserTimeLimit(document->page()))
+    , m_continueParsingTimer(this, &XMLDocumentParser::continueParsingTimerFired)
     , m_currentNode(document)
     , m_sawError(false)
     , m_sawCSS(false)
@@ -574,6 +623,8 @@ XMLDocumentParser::XMLDocumentParser(DocumentFragment* fragment, Element* parent
     , m_view(0)
     , m_context(0)
     , m_pendingCallbacks(new PendingCallbacks)
+    , m_parserTimeLimit(parserTimeLimit(fragment->document()->page()))
+    , m_continueParsingTimer(this, &XMLDocumentParser::continueParsingTimerFired)
     , m_currentNode(fragment)
     , m_sawError(false)
     , m_sawCSS(false)
@@ -638,6 +689,7 @@ XMLDocumentParser::~XMLDocumentParser()
 {
     // The XMLDocumentParser will always be detached before being destroyed.
     ASSERT(m_currentNodeStack.isEmpty());
+    ASSERT(!isScheduledForResume());
     ASSERT(!m_currentNode);
 
     // FIXME: m_pendingScript handling should be moved into XMLDocumentParser.cpp!
@@ -662,12 +714,33 @@ void XMLDocumentParser::doWrite(const String& parseString)
 
         switchToUTF16(context->context());
         XMLDocumentParserScope scope(document()->cachedResourceLoader());
-        xmlParseChunk(context->context(), reinterpret_cast<const char*>(parseString.characters()), sizeof(UChar) * parseString.length(), 0);
 
-        // JavaScript (which may be run under the xmlParseChunk callstack) may
-        // cause the parser to be stopped or detached.
-        if (isStopped())
-            return;
+        double startTime = currentTime();
+        unsigned length = parseString.length();
+        unsigned offset = 0;
+        while (offset < length) {
+            unsigned sliceLength = min(length - offset, parserSliceLength);
+            xmlParseChunk(context->context(), reinterpret_cast<const char*>(parseString.characters() + offset), sizeof(UChar) * sliceLength, 0);
+            offset += sliceLength;
+
+            // JavaScript (which may be run under the xmlParseChunk callstack) may
+            // cause the parser to be stopped or detached.
+            if (isStopped())
+                return;
+
+            if (offset == length)
+                break;
+
+            // Keep the rest of the source unparsed while a script is pending, and give
+            // the event loop a turn if this write has run for too long.
+            bool needsYield = currentTime() - startTime > m_parserTimeLimit;
+            if (m_parserPaused || needsYield) {
+                m_pendingSrc.prepend(SegmentedString(parseString.substring(offset)));
+                if (!m_parserPaused)
+                    m_continueParsingTimer.startOneShot(0);
+                return;
+            }
+        }
     }
 
     // FIXME: Why is this here?  And why is it after we process the passed source?
@@ -1418,10 +1491,33 @@ TextPosition1 XMLDocumentParser::textPositionOneBased() const
 void XMLDocumentParser::stopParsing()
 {
     DocumentParser::stopParsing();
+    m_continueParsingTimer.stop();
     if (context())
         xmlStopParser(context());
 }
 
+void XMLDocumentParser::continueParsingTimerFired(Timer<XMLDocumentParser>* timer)
+{
+    ASSERT_UNUSED(timer, timer == &m_continueParsingTimer);
+    ASSERT(!isDetached());
+    ASSERT(!m_parserPaused);
+
+    // If a layout is scheduled, wait again to let the layout timer run first.
+    if (document()->isLayoutTimerActive()) {
+        m_continueParsingTimer.startOneShot(0);
+        return;
+    }
+
+    RefPtr<XMLDocumentParser> protect(this);
+
+    SegmentedString rest = m_pendingSrc;
+    m_pendingSrc.clear();
+    append(rest);
+
+    if (m_finishCalled && !isDetached() && !m_parserPaused && !isScheduledForResume())
+        end();
+}
+
 void XMLDocumentParser::resumeParsing()
 {
     ASSERT(!isDetached());
@@ -1443,9 +1539,9 @@ void XMLDocumentParser::resumeParsing()
     m_pendingSrc.clear();
     append(rest);
 
-    // Finally, if finish() has been called and write() didn't result
-    // in any further callbacks being queued, call end()
-    if (m_finishCalled && m_pendingCallbacks->isEmpty())
+    // Finally, if finish() has been called and write() neither queued
+    // further callbacks nor yielded, call end()
+    if (m_finishCalled && m_pendingCallbacks->isEmpty() && !m_parserPaused && !isScheduledForResume())
         end();
 }
 
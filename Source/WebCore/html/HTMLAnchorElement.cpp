@@ -25,6 +25,7 @@
 #include "HTMLAnchorElement.h"
 
 #include "Attribute.h"
+#include "DNS.h"
 #include "EventNames.h"
 #include "Frame.h"
 #include "FrameLoaderTypes.h"
@@ -215,7 +216,11 @@ void HTMLAnchorElement::parseMappedAttribute(Attribute* attr)
             String parsedURL = stripLeadingAndTrailingHTMLSpaces(attr->value());
             if (document()->isDNSPrefetchEnabled()) {
                 if (protocolIs(parsedURL, "http") || protocolIs(parsedURL, "https") || parsedURL.startsWith("//"))
+#if PLATFORM(ANDROID)
+                    prefetchDNS(document(), document()->completeURL(parsedURL).host());
+#else
                     ResourceHandle::prepareForURL(document()->completeURL(parsedURL));
+#endif
             }
             if (document()->page() && !document()->page()->javaScriptURLsAreAllowed() && protocolIsJavaScript(parsedURL)) {
                 clearIsLink();
@@ -29,6 +29,7 @@
 #include "CachedResource.h"
 #include "CachedResourceLoader.h"
 #include "CSSStyleSelector.h"
+#include "DNS.h"
 #include "Document.h"
 #include "Frame.h"
 #include "FrameLoader.h"
@@ -250,7 +251,11 @@ void HTMLLinkElement::process()
         // FIXME: The href attribute of the link element can be in "//hostname" form, and we shouldn't attempt
         // to complete that as URL <https://bugs.webkit.org/show_bug.cgi?id=48857>.
         if (settings && settings->dnsPrefetchingEnabled() && m_url.isValid() && !m_url.isEmpty())
+#if PLATFORM(ANDROID)
+            prefetchDNS(document(), m_url.host());
+#else
             ResourceHandle::prepareForURL(m_url);
+#endif
     }
 
 #if ENABLE(LINK_PREFETCH)
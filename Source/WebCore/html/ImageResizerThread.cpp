@@ -86,7 +86,7 @@ void* ImageResizerThread::imageResizerThread()
 {
     // FIXME: Do resizing, create blob, and catch any errors.
 
-    callOnMainThread(returnBlobOrError, static_cast<void*>(m_callbackInfo));
+    callOnMainThread(returnBlobOrError, static_cast<void*>(m_callbackInfo), MainThreadRenderingPriority);
     detachThread(m_threadID);
     delete this;
     return 0;
@@ -377,11 +377,45 @@ PassRefPtr<Element> HTMLConstructionSite::createHTMLElement(AtomicHTMLToken& tok
     // have to pass the current form element.  We should rework form association
     // to occur after construction to allow better code sharing here.
     RefPtr<Element> element = HTMLElementFactory::createHTMLElement(tagName, currentNode()->document(), form(), true);
-    element->setAttributeMap(token.takeAtributes(), m_fragmentScriptingPermission);
+    RefPtr<NamedNodeMap> attributes = token.takeAtributes();
+    if (attributes)
+        shareAttributes(attributes.get());
+    element->setAttributeMap(attributes.release(), m_fragmentScriptingPermission);
     ASSERT(element->isHTMLElement());
     return element.release();
 }
 
+// These attributes are never turned into presentational style or rewritten in place by an
+// HTML element, and tend to repeat across many elements of a page.
+static inline bool isShareableAttribute(const QualifiedName& name)
+{
+    return name == classAttr || name == styleAttr || name == relAttr || name == targetAttr;
+}
+
+static const unsigned maximumSharedAttributes = 1024;
+
+void HTMLConstructionSite::shareAttributes(NamedNodeMap* attributes)
+{
+    unsigned length = attributes->length();
+    for (unsigned i = 0; i < length; ++i) {
+        Attribute* attribute = attributes->attributeItem(i);
+        if (!isShareableAttribute(attribute->name()))
+            continue;
+
+        std::pair<AtomicStringImpl*, AtomicStringImpl*> key(attribute->localName().impl(), attribute->value().impl());
+        SharedAttributeMap::iterator it = m_sharedAttributes.find(key);
+        if (it != m_sharedAttributes.end()) {
+            attributes->parserReplaceAttributeItem(i, it->second);
+            continue;
+        }
+
+        if (m_sharedAttributes.size() < maximumSharedAttributes) {
+            attribute->setIsShared();
+            m_sharedAttributes.set(key, attribute);
+        }
+    }
+}
+
 PassRefPtr<Element> HTMLConstructionSite::createHTMLElementFromElementRecord(HTMLElementStack::ElementRecord* record)
 {
     return createHTMLElementFromSavedElement(record->element());
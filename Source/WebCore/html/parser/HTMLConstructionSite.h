@@ -31,6 +31,7 @@
 #include "HTMLElementStack.h"
 #include "HTMLFormattingElementList.h"
 #include "NotImplemented.h"
+#include <wtf/HashMap.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/PassRefPtr.h>
 #include <wtf/RefPtr.h>
@@ -38,8 +39,10 @@
 namespace WebCore {
 
 class AtomicHTMLToken;
+class Attribute;
 class Document;
 class Element;
+class NamedNodeMap;
 
 class HTMLConstructionSite {
     WTF_MAKE_NONCOPYABLE(HTMLConstructionSite);
@@ -130,6 +133,7 @@ private:
     PassRefPtr<Element> createElement(AtomicHTMLToken&, const AtomicString& namespaceURI);
 
     void mergeAttributesFromTokenIntoElement(AtomicHTMLToken&, Element*);
+    void shareAttributes(NamedNodeMap*);
     void dispatchDocumentElementAvailableIfNeeded();
 
     Document* m_document;
@@ -144,6 +148,11 @@ private:
     mutable HTMLElementStack m_openElements;
     mutable HTMLFormattingElementList m_activeFormattingElements;
 
+    // Attributes that have already been handed to an element, keyed by local name and value,
+    // so that elements with an identical attribute can share a single Attribute.
+    typedef HashMap<std::pair<AtomicStringImpl*, AtomicStringImpl*>, RefPtr<Attribute> > SharedAttributeMap;
+    SharedAttributeMap m_sharedAttributes;
+
     FragmentScriptingPermission m_fragmentScriptingPermission;
     bool m_isParsingFragment;
 
@@ -550,8 +550,8 @@ inline void AtomicHTMLToken::initializeAttributes(const HTMLToken::AttributeList
         ASSERT(attribute.m_valueRange.m_start);
         ASSERT(attribute.m_valueRange.m_end);
 
-        String name(attribute.m_name.data(), attribute.m_name.size());
-        String value(attribute.m_value.data(), attribute.m_value.size());
+        String name = String::make8BitIfPossible(attribute.m_name.data(), attribute.m_name.size());
+        String value = String::make8BitIfPossible(attribute.m_value.data(), attribute.m_value.size());
         m_attributes->insertAttribute(Attribute::createMapped(name, value), false);
     }
 }
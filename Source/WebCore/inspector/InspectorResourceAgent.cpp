@@ -177,6 +177,11 @@ PassRefPtr<SharedBuffer> InspectorResourceAgent::resourceData(Frame* frame, cons
             return 0;
     }
 
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    if (!cachedResource->uncompressEncodedData())
+        return 0;
+#endif
+
     *textEncodingName = cachedResource->encoding();
     return cachedResource->data();
 }
@@ -533,6 +533,11 @@ PassRefPtr<ArchiveResource> DocumentLoader::subresource(const KURL& url) const
     if (!resource->makePurgeable(false))
         return 0;
 
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    if (!resource->uncompressEncodedData())
+        return 0;
+#endif
+
     RefPtr<SharedBuffer> data = resource->data();
     if (!data)
         return 0;
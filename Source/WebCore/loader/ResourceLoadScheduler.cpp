@@ -35,6 +35,7 @@
 #include "ResourceLoader.h"
 #include "ResourceRequest.h"
 #include "SubresourceLoader.h"
+#include <algorithm>
 #include <wtf/text/CString.h>
 
 #define REQUEST_MANAGEMENT_ENABLED 1
@@ -45,9 +46,15 @@ namespace WebCore {
 static const unsigned maxRequestsInFlightForNonHTTPProtocols = 20;
 // Match the parallel connection count used by the networking layer.
 static unsigned maxRequestsInFlightPerHost;
+// Cap on http(s) loads in flight across all hosts. Loads below ResourceLoadPriorityMedium may not take
+// the last few slots, so that a page full of images cannot hold back the scripts and style sheets it finds later.
+static const unsigned maxRequestsInFlight = 24;
+static const unsigned requestsInFlightReservedForImportantLoads = 4;
 #else
 static const unsigned maxRequestsInFlightForNonHTTPProtocols = 10000;
 static const unsigned maxRequestsInFlightPerHost = 10000;
+static const unsigned maxRequestsInFlight = 10000;
+static const unsigned requestsInFlightReservedForImportantLoads = 0;
 #endif
 
 ResourceLoadScheduler::HostInformation* ResourceLoadScheduler::hostForURL(const KURL& url, CreateHostPolicy createHostPolicy)
@@ -75,6 +82,9 @@ ResourceLoadScheduler* resourceLoadScheduler()
 ResourceLoadScheduler::ResourceLoadScheduler()
     : m_nonHTTPProtocolHost(new HostInformation(String(), maxRequestsInFlightForNonHTTPProtocols))
     , m_requestTimer(this, &ResourceLoadScheduler::requestTimerFired)
+    , m_nextRequestOrder(0)
+    , m_httpLoadsInProgress(0)
+    , m_servePendingRequestsDepth(0)
     , m_isSuspendingPendingRequests(false)
     , m_isSerialLoadingEnabled(false)
 {
@@ -102,7 +112,7 @@ PassRefPtr<NetscapePlugInStreamLoader> ResourceLoadScheduler::schedulePluginStre
 
 void ResourceLoadScheduler::addMainResourceLoad(ResourceLoader* resourceLoader)
 {
-    hostForURL(resourceLoader->url(), CreateIfNotFound)->addLoadInProgress(resourceLoader);
+    addLoadInProgress(hostForURL(resourceLoader->url(), CreateIfNotFound), resourceLoader);
 }
 
 void ResourceLoadScheduler::scheduleLoad(ResourceLoader* resourceLoader, ResourceLoadPriority priority)
@@ -116,7 +126,7 @@ void ResourceLoadScheduler::scheduleLoad(ResourceLoader* resourceLoader, Resourc
     LOG(ResourceLoading, "ResourceLoadScheduler::load resource %p '%s'", resourceLoader, resourceLoader->url().string().latin1().data());
     HostInformation* host = hostForURL(resourceLoader->url(), CreateIfNotFound);    
     bool hadRequests = host->hasRequests();
-    host->schedule(resourceLoader, priority);
+    host->schedule(resourceLoader, priority, m_nextRequestOrder++);
 
     if (priority > ResourceLoadPriorityLow || !resourceLoader->url().protocolInHTTPFamily() || (priority == ResourceLoadPriorityLow && !hadRequests)) {
         // Try to request important resources immediately.
@@ -135,7 +145,23 @@ void ResourceLoadScheduler::remove(ResourceLoader* resourceLoader)
 
     HostInformation* host = hostForURL(resourceLoader->url());
     if (host)
-        host->remove(resourceLoader);
+        removeLoad(host, resourceLoader);
+    scheduleServePendingRequests();
+}
+
+void ResourceLoadScheduler::setPriority(ResourceLoader* resourceLoader, ResourceLoadPriority priority)
+{
+    ASSERT(resourceLoader);
+    ASSERT(priority != ResourceLoadPriorityUnresolved);
+#if !REQUEST_MANAGEMENT_ENABLED
+    priority = ResourceLoadPriorityHighest;
+#endif
+
+    HostInformation* host = hostForURL(resourceLoader->url());
+    if (!host || !host->reschedule(resourceLoader, priority))
+        return;
+
+    LOG(ResourceLoading, "ResourceLoadScheduler::setPriority resource %p '%s' priority=%d", resourceLoader, resourceLoader->url().string().latin1().data(), priority);
     scheduleServePendingRequests();
 }
 
@@ -148,8 +174,8 @@ void ResourceLoadScheduler::crossOriginRedirectReceived(ResourceLoader* resource
     if (oldHost->name() == newHost->name())
         return;
     
-    newHost->addLoadInProgress(resourceLoader);
-    oldHost->remove(resourceLoader);
+    addLoadInProgress(newHost, resourceLoader);
+    removeLoad(oldHost, resourceLoader);
 }
 
 void ResourceLoadScheduler::servePendingRequests(ResourceLoadPriority minimumPriority)
@@ -159,22 +185,102 @@ void ResourceLoadScheduler::servePendingRequests(ResourceLoadPriority minimumPri
         return;
 
     m_requestTimer.stop();
-    
-    servePendingRequests(m_nonHTTPProtocolHost, minimumPriority);
 
-    Vector<HostInformation*> hostsToServe;
+    // Start everything of one priority before anything of the next.
+    ++m_servePendingRequestsDepth;
+    for (int priority = ResourceLoadPriorityHighest; priority >= minimumPriority; --priority)
+        servePendingRequestsInOrder(ResourceLoadPriority(priority));
+    if (--m_servePendingRequestsDepth)
+        return;
+
+    Vector<HostInformation*> hostsToDelete;
     m_hosts.checkConsistency();
     HostMap::iterator end = m_hosts.end();
-    for (HostMap::iterator iter = m_hosts.begin(); iter != end; ++iter)
-        hostsToServe.append(iter->second);
-
-    int size = hostsToServe.size();
-    for (int i = 0; i < size; ++i) {
-        HostInformation* host = hostsToServe[i];
-        if (host->hasRequests())
-            servePendingRequests(host, minimumPriority);
-        else
-            delete m_hosts.take(host->name());
+    for (HostMap::iterator iter = m_hosts.begin(); iter != end; ++iter) {
+        if (!iter->second->hasRequests())
+            hostsToDelete.append(iter->second);
+    }
+
+    int size = hostsToDelete.size();
+    for (int i = 0; i < size; ++i)
+        delete m_hosts.take(hostsToDelete[i]->name());
+}
+
+void ResourceLoadScheduler::servePendingRequestsInOrder(ResourceLoadPriority priority)
+{
+    // Merge the pending queues of all hosts, each already in scheduling order, into one list in
+    // document order. Every load is then looked at once: a host that has to defer its first load
+    // defers the rest of them too, so it is skipped from then on.
+    Vector<PendingLoad> pendingLoads;
+    const HostInformation::RequestQueue& nonHTTPRequestsPending = m_nonHTTPProtocolHost->requestsPending(priority);
+    for (HostInformation::RequestQueue::const_iterator it = nonHTTPRequestsPending.begin(); it != nonHTTPRequestsPending.end(); ++it)
+        pendingLoads.append(PendingLoad(it->order, m_nonHTTPProtocolHost, it->resourceLoader.get()));
+    HostMap::const_iterator end = m_hosts.end();
+    for (HostMap::const_iterator iter = m_hosts.begin(); iter != end; ++iter) {
+        const HostInformation::RequestQueue& requestsPending = iter->second->requestsPending(priority);
+        for (HostInformation::RequestQueue::const_iterator it = requestsPending.begin(); it != requestsPending.end(); ++it)
+            pendingLoads.append(PendingLoad(it->order, iter->second, it->resourceLoader.get()));
+    }
+    if (pendingLoads.isEmpty())
+        return;
+    std::sort(pendingLoads.begin(), pendingLoads.end());
+
+    HashSet<HostInformation*> deferredHosts;
+    size_t size = pendingLoads.size();
+    for (size_t i = 0; i < size; ++i) {
+        HostInformation* host = pendingLoads[i].host;
+        if (deferredHosts.contains(host))
+            continue;
+
+        // Starting a load can add, remove or reprioritize others. Only start a load that is still
+        // first in its host's queue; anything that got ahead of it is served by another pass.
+        HostInformation::RequestQueue& requestsPending = host->requestsPending(priority);
+        if (requestsPending.isEmpty() || requestsPending.first().resourceLoader != pendingLoads[i].resourceLoader) {
+            if (!requestsPending.isEmpty())
+                scheduleServePendingRequests();
+            continue;
+        }
+
+        ResourceLoader* resourceLoader = pendingLoads[i].resourceLoader.get();
+        if (shouldDeferRequest(host, resourceLoader, priority)) {
+            deferredHosts.add(host);
+            continue;
+        }
+
+        requestsPending.removeFirst();
+        addLoadInProgress(host, resourceLoader);
+        resourceLoader->start();
+    }
+}
+
+bool ResourceLoadScheduler::shouldDeferRequest(HostInformation* host, ResourceLoader* resourceLoader, ResourceLoadPriority priority) const
+{
+    // For named hosts - which are only http(s) hosts - we should always enforce the connection limit.
+    // For non-named hosts - everything but http(s) - we should only enforce the limit if the document isn't done parsing 
+    // and we don't know all stylesheets yet.
+    Document* document = resourceLoader->frameLoader() ? resourceLoader->frameLoader()->frame()->document() : 0;
+    bool shouldLimitRequests = !host->name().isNull() || (document && (document->parsing() || !document->haveStylesheetsLoaded()));
+    if (shouldLimitRequests && host->limitRequests(priority))
+        return true;
+
+    // Only http(s) loads take network connections, so only they count against the total.
+    if (host->name().isNull())
+        return false;
+    unsigned limit = priority < ResourceLoadPriorityMedium ? maxRequestsInFlight - requestsInFlightReservedForImportantLoads : maxRequestsInFlight;
+    return m_httpLoadsInProgress >= limit;
+}
+
+void ResourceLoadScheduler::addLoadInProgress(HostInformation* host, ResourceLoader* resourceLoader)
+{
+    if (host->addLoadInProgress(resourceLoader) && !host->name().isNull())
+        ++m_httpLoadsInProgress;
+}
+
+void ResourceLoadScheduler::removeLoad(HostInformation* host, ResourceLoader* resourceLoader)
+{
+    if (host->remove(resourceLoader) && !host->name().isNull()) {
+        ASSERT(m_httpLoadsInProgress);
+        --m_httpLoadsInProgress;
     }
 }
 
@@ -186,18 +292,12 @@ void ResourceLoadScheduler::servePendingRequests(HostInformation* host, Resource
         HostInformation::RequestQueue& requestsPending = host->requestsPending(ResourceLoadPriority(priority));
 
         while (!requestsPending.isEmpty()) {
-            RefPtr<ResourceLoader> resourceLoader = requestsPending.first();
-
-            // For named hosts - which are only http(s) hosts - we should always enforce the connection limit.
-            // For non-named hosts - everything but http(s) - we should only enforce the limit if the document isn't done parsing 
-            // and we don't know all stylesheets yet.
-            Document* document = resourceLoader->frameLoader() ? resourceLoader->frameLoader()->frame()->document() : 0;
-            bool shouldLimitRequests = !host->name().isNull() || (document && (document->parsing() || !document->haveStylesheetsLoaded()));
-            if (shouldLimitRequests && host->limitRequests(ResourceLoadPriority(priority)))
+            RefPtr<ResourceLoader> resourceLoader = requestsPending.first().resourceLoader;
+            if (shouldDeferRequest(host, resourceLoader.get(), ResourceLoadPriority(priority)))
                 return;
 
             requestsPending.removeFirst();
-            host->addLoadInProgress(resourceLoader.get());
+            addLoadInProgress(host, resourceLoader.get());
             resourceLoader->start();
         }
     }
@@ -243,33 +343,61 @@ ResourceLoadScheduler::HostInformation::~HostInformation()
         ASSERT(m_requestsPending[p].isEmpty());
 }
     
-void ResourceLoadScheduler::HostInformation::schedule(ResourceLoader* resourceLoader, ResourceLoadPriority priority)
+void ResourceLoadScheduler::HostInformation::schedule(ResourceLoader* resourceLoader, ResourceLoadPriority priority, unsigned order)
 {
-    m_requestsPending[priority].append(resourceLoader);
+    m_requestsPending[priority].append(PendingRequest(resourceLoader, order));
+}
+
+bool ResourceLoadScheduler::HostInformation::reschedule(ResourceLoader* resourceLoader, ResourceLoadPriority newPriority)
+{
+    for (int priority = ResourceLoadPriorityHighest; priority >= ResourceLoadPriorityLowest; --priority) {
+        RequestQueue::iterator end = m_requestsPending[priority].end();
+        for (RequestQueue::iterator it = m_requestsPending[priority].begin(); it != end; ++it) {
+            if (it->resourceLoader != resourceLoader)
+                continue;
+            if (priority != newPriority) {
+                // Keep the original order and insert by it, so the queue stays in document order.
+                PendingRequest request = *it;
+                m_requestsPending[priority].remove(it);
+
+                RequestQueue& queue = m_requestsPending[newPriority];
+                RequestQueue reordered;
+                while (!queue.isEmpty() && queue.first().order < request.order)
+                    reordered.append(queue.takeFirst());
+                reordered.append(request);
+                while (!queue.isEmpty())
+                    reordered.append(queue.takeFirst());
+                queue.swap(reordered);
+            }
+            return true;
+        }
+    }
+    return false;
 }
     
-void ResourceLoadScheduler::HostInformation::addLoadInProgress(ResourceLoader* resourceLoader)
+bool ResourceLoadScheduler::HostInformation::addLoadInProgress(ResourceLoader* resourceLoader)
 {
     LOG(ResourceLoading, "HostInformation '%s' loading '%s'. Current count %d", m_name.latin1().data(), resourceLoader->url().string().latin1().data(), m_requestsLoading.size());
-    m_requestsLoading.add(resourceLoader);
+    return m_requestsLoading.add(resourceLoader).second;
 }
     
-void ResourceLoadScheduler::HostInformation::remove(ResourceLoader* resourceLoader)
+bool ResourceLoadScheduler::HostInformation::remove(ResourceLoader* resourceLoader)
 {
     if (m_requestsLoading.contains(resourceLoader)) {
         m_requestsLoading.remove(resourceLoader);
-        return;
+        return true;
     }
     
     for (int priority = ResourceLoadPriorityHighest; priority >= ResourceLoadPriorityLowest; --priority) {  
         RequestQueue::iterator end = m_requestsPending[priority].end();
         for (RequestQueue::iterator it = m_requestsPending[priority].begin(); it != end; ++it) {
-            if (*it == resourceLoader) {
+            if (it->resourceLoader == resourceLoader) {
                 m_requestsPending[priority].remove(it);
-                return;
+                return false;
             }
         }
     }
+    return false;
 }
 
 bool ResourceLoadScheduler::HostInformation::hasRequests() const
@@ -55,6 +55,10 @@ public:
     void addMainResourceLoad(ResourceLoader*);
     void remove(ResourceLoader*);
     void crossOriginRedirectReceived(ResourceLoader*, const KURL& redirectURL);
+
+    // Moves a load that has not started yet to another priority, for example when an image
+    // scrolls into view. Loads already handed to the network layer keep their place.
+    void setPriority(ResourceLoader*, ResourceLoadPriority);
     
     void servePendingRequests(ResourceLoadPriority minimumPriority = ResourceLoadPriorityVeryLow);
     void suspendPendingRequests();
@@ -78,13 +82,27 @@ private:
         ~HostInformation();
         
         const String& name() const { return m_name; }
-        void schedule(ResourceLoader*, ResourceLoadPriority = ResourceLoadPriorityVeryLow);
-        void addLoadInProgress(ResourceLoader*);
-        void remove(ResourceLoader*);
+        void schedule(ResourceLoader*, ResourceLoadPriority, unsigned order);
+        bool reschedule(ResourceLoader*, ResourceLoadPriority);
+        // Both return true if the set of loads in progress changed.
+        bool addLoadInProgress(ResourceLoader*);
+        bool remove(ResourceLoader*);
         bool hasRequests() const;
         bool limitRequests(ResourceLoadPriority) const;
 
-        typedef Deque<RefPtr<ResourceLoader> > RequestQueue;
+        struct PendingRequest {
+            PendingRequest(ResourceLoader* resourceLoader, unsigned order)
+                : resourceLoader(resourceLoader)
+                , order(order)
+            {
+            }
+
+            RefPtr<ResourceLoader> resourceLoader;
+            // Loads are scheduled as the document refers to them, so this follows document order across all hosts.
+            unsigned order;
+        };
+        // Each queue is kept in scheduling order.
+        typedef Deque<PendingRequest> RequestQueue;
         RequestQueue& requestsPending(ResourceLoadPriority priority) { return m_requestsPending[priority]; }
 
     private:                    
@@ -100,14 +118,38 @@ private:
         FindOnly
     };
     
+    struct PendingLoad {
+        PendingLoad() : order(0), host(0) { }
+        PendingLoad(unsigned order, HostInformation* host, ResourceLoader* resourceLoader)
+            : order(order)
+            , host(host)
+            , resourceLoader(resourceLoader)
+        {
+        }
+        bool operator<(const PendingLoad& other) const { return order < other.order; }
+
+        unsigned order;
+        HostInformation* host;
+        RefPtr<ResourceLoader> resourceLoader;
+    };
+
     HostInformation* hostForURL(const KURL&, CreateHostPolicy = FindOnly);
     void servePendingRequests(HostInformation*, ResourceLoadPriority);
+    void servePendingRequestsInOrder(ResourceLoadPriority);
+    bool shouldDeferRequest(HostInformation*, ResourceLoader*, ResourceLoadPriority) const;
+    void addLoadInProgress(HostInformation*, ResourceLoader*);
+    void removeLoad(HostInformation*, ResourceLoader*);
 
     typedef HashMap<String, HostInformation*, StringHash> HostMap;
     HostMap m_hosts;
     HostInformation* m_nonHTTPProtocolHost;
         
     Timer<ResourceLoadScheduler> m_requestTimer;
+    unsigned m_nextRequestOrder;
+    // http(s) loads in progress on all hosts, which is what maxRequestsInFlight limits.
+    unsigned m_httpLoadsInProgress;
+    // Hosts are only deleted once the outermost servePendingRequests() call is done with them.
+    unsigned m_servePendingRequestsDepth;
 
     bool m_isSuspendingPendingRequests;
     bool m_isSerialLoadingEnabled;
@@ -47,6 +47,9 @@
 
 namespace WebCore {
 
+// Smaller resources are not worth a file and a mapping of their own.
+static const unsigned minimumFileBackedResourceSize = 1024 * 1024;
+
 PassRefPtr<SharedBuffer> ResourceLoader::resourceData()
 {
     if (m_resourceData)
@@ -215,13 +218,25 @@ void ResourceLoader::addData(const char* data, int length, bool allAtOnce)
     if (ResourceHandle::supportsBufferedData()) {
         // Buffer data only if the connection has handed us the data because is has stopped buffering it.
         if (m_resourceData)
-            m_resourceData->append(data, length);
-    } else {
-        if (!m_resourceData)
-            m_resourceData = SharedBuffer::create(data, length);
-        else
-            m_resourceData->append(data, length);
+            appendToResourceData(data, length);
+    } else
+        appendToResourceData(data, length);
+}
+
+void ResourceLoader::appendToResourceData(const char* data, int length)
+{
+    if (!m_resourceData) {
+        m_resourceData = SharedBuffer::create();
+        // Private browsing must not leave resources on disk, even in unlinked files.
+        Settings* settings = m_frame ? m_frame->settings() : 0;
+        if (settings && !settings->privateBrowsingEnabled())
+            m_resourceData->setFileBacking(settings->resourceFileBackingPath(), minimumFileBackedResourceSize);
     }
+
+    if (m_dataSegmentBeingReceived && data == m_dataSegmentBeingReceived->data() && static_cast<unsigned>(length) == m_dataSegmentBeingReceived->size())
+        m_resourceData->append(m_dataSegmentBeingReceived);
+    else
+        m_resourceData->append(data, length);
 }
 
 void ResourceLoader::clearResourceData()
@@ -440,6 +455,18 @@ void ResourceLoader::didReceiveData(ResourceHandle*, const char* data, int lengt
     InspectorInstrumentation::didReceiveResourceData(cookie);
 }
 
+void ResourceLoader::didReceiveDataSegment(ResourceHandle*, PassRefPtr<SharedBuffer::DataSegment> segment, int encodedDataLength)
+{
+    RefPtr<ResourceLoader> protector(this);
+
+    // Subclasses still see the bytes through didReceiveData(); only the buffering in addData() changes.
+    InspectorInstrumentationCookie cookie = InspectorInstrumentation::willReceiveResourceData(m_frame.get(), identifier());
+    m_dataSegmentBeingReceived = segment;
+    didReceiveData(m_dataSegmentBeingReceived->data(), m_dataSegmentBeingReceived->size(), encodedDataLength, false);
+    m_dataSegmentBeingReceived = 0;
+    InspectorInstrumentation::didReceiveResourceData(cookie);
+}
+
 void ResourceLoader::didFinishLoading(ResourceHandle*, double finishTime)
 {
     didFinishLoading(finishTime);
@@ -105,6 +105,7 @@ namespace WebCore {
         virtual void didSendData(ResourceHandle*, unsigned long long bytesSent, unsigned long long totalBytesToBeSent);
         virtual void didReceiveResponse(ResourceHandle*, const ResourceResponse&);
         virtual void didReceiveData(ResourceHandle*, const char*, int, int encodedDataLength);
+        virtual void didReceiveDataSegment(ResourceHandle*, PassRefPtr<SharedBuffer::DataSegment>, int encodedDataLength);
         virtual void didReceiveCachedMetadata(ResourceHandle*, const char* data, int length) { didReceiveCachedMetadata(data, length); }
         virtual void didFinishLoading(ResourceHandle*, double finishTime);
         virtual void didFail(ResourceHandle*, const ResourceError&);
@@ -164,8 +165,12 @@ namespace WebCore {
         ResourceResponse m_response;
         
     private:
+        void appendToResourceData(const char*, int);
+
         ResourceRequest m_request;
         RefPtr<SharedBuffer> m_resourceData;
+        // Set while the bytes of a segment are passed through didReceiveData(), so that addData() can adopt it.
+        RefPtr<SharedBuffer::DataSegment> m_dataSegmentBeingReceived;
         
         unsigned long m_identifier;
 
@@ -28,6 +28,7 @@
 namespace WebCore {
 
 class HTMLMetaCharsetParser;
+class SharedBuffer;
 
 class TextResourceDecoder : public RefCounted<TextResourceDecoder> {
 public:
@@ -54,6 +55,9 @@ public:
     String decode(const char* data, size_t length);
     String flush();
 
+    // Decodes the whole buffer a segment at a time, so it never has to be flattened.
+    String decodeAndFlush(const SharedBuffer*);
+
     void setHintEncoding(const TextResourceDecoder* hintDecoder)
     {
         // hintEncoding is for use with autodetection, which should be 
@@ -56,6 +56,9 @@ namespace WebCore {
     private:
         bool canUseSheet(bool enforceMIMEType, bool* hasValidMIMEType) const;
         virtual PurgePriority purgePriority() const { return PurgeLast; }
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+        virtual bool shouldCompressEncodedData() const { return true; }
+#endif
 
     protected:
         RefPtr<TextResourceDecoder> m_decoder;
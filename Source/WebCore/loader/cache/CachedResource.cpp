@@ -44,6 +44,10 @@
 #include <wtf/StdLibExtras.h>
 #include <wtf/Vector.h>
 
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+#include <zlib.h>
+#endif
+
 using namespace WTF;
 
 namespace WebCore {
@@ -277,6 +281,10 @@ void CachedResource::addClientToSet(CachedResourceClient* client)
         else
             m_preloadResult = PreloadReferenced;
     }
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    // Uncompress before the resource is counted as live, so the size change lands in the dead total.
+    uncompressEncodedData();
+#endif
     if (!hasClients() && inCache())
         memoryCache()->addToLiveResourcesSize(this);
     m_clients.add(client);
@@ -593,6 +601,79 @@ bool CachedResource::wasPurged() const
     return m_purgeableData && m_purgeableData->wasPurged();
 }
 
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+// Smaller buffers are not worth the zlib stream overhead and the inflate on reuse.
+static const unsigned cMinimumCompressibleSize = 1024;
+
+bool CachedResource::compressEncodedData()
+{
+    if (!m_compressedData.isEmpty())
+        return true;
+
+    if (!shouldCompressEncodedData() || !isSafeToMakePurgeable())
+        return false;
+
+    if (!m_data || m_data->size() < cMinimumCompressibleSize || m_data->size() != m_encodedSize)
+        return false;
+
+    // Compressing a buffer that someone else still holds would leave two copies around.
+    if (!m_data->hasOneRef())
+        return false;
+
+    uLongf compressedSize = compressBound(m_data->size());
+    Vector<char> compressedData(compressedSize);
+    if (compress2(reinterpret_cast<Bytef*>(compressedData.data()), &compressedSize, reinterpret_cast<const Bytef*>(m_data->data()), m_data->size(), Z_BEST_SPEED) != Z_OK)
+        return false;
+
+    // Keep the plain data if the savings would not pay for uncompressing it again.
+    if (compressedSize > m_data->size() / 4 * 3)
+        return false;
+
+    compressedData.shrink(compressedSize);
+    compressedData.shrinkToFit();
+
+    // The object must now be moved to a different queue, since its size has been changed.
+    if (inCache())
+        memoryCache()->removeFromLRUList(this);
+
+    int delta = compressedData.size() - encodedSizeInMemory();
+    m_compressedData.swap(compressedData);
+    m_data.clear();
+
+    if (inCache()) {
+        memoryCache()->insertInLRUList(this);
+        memoryCache()->adjustSize(hasClients(), delta);
+    }
+    return true;
+}
+
+bool CachedResource::uncompressEncodedData()
+{
+    if (m_compressedData.isEmpty())
+        return true;
+
+    ASSERT(!m_data);
+
+    uLongf size = m_encodedSize;
+    Vector<char> data(size);
+    if (uncompress(reinterpret_cast<Bytef*>(data.data()), &size, reinterpret_cast<const Bytef*>(m_compressedData.data()), m_compressedData.size()) != Z_OK || size != m_encodedSize)
+        return false;
+
+    if (inCache())
+        memoryCache()->removeFromLRUList(this);
+
+    int delta = m_encodedSize - encodedSizeInMemory();
+    m_compressedData.clear();
+    m_data = SharedBuffer::adoptVector(data);
+
+    if (inCache()) {
+        memoryCache()->insertInLRUList(this);
+        memoryCache()->adjustSize(hasClients(), delta);
+    }
+    return true;
+}
+#endif
+
 unsigned CachedResource::overheadSize() const
 {
     return sizeof(CachedResource) + m_response.memoryUsage() + 576;
@@ -604,9 +685,11 @@ unsigned CachedResource::overheadSize() const
     
 void CachedResource::setLoadPriority(ResourceLoadPriority loadPriority) 
 { 
-    if (loadPriority == ResourceLoadPriorityUnresolved)
+    if (loadPriority == ResourceLoadPriorityUnresolved || loadPriority == m_loadPriority)
         return;
     m_loadPriority = loadPriority;
+    if (m_request)
+        m_request->setPriority(loadPriority);
 }
 
 }
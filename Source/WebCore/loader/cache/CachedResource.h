@@ -118,8 +118,10 @@ public:
     Status status() const { return static_cast<Status>(m_status); }
     void setStatus(Status status) { m_status = status; }
 
-    unsigned size() const { return encodedSize() + decodedSize() + overheadSize(); }
+    unsigned size() const { return encodedSizeInMemory() + decodedSize() + overheadSize(); }
     unsigned encodedSize() const { return m_encodedSize; }
+    // The bytes the encoded data actually occupies, which is less than encodedSize() while it is compressed.
+    unsigned encodedSizeInMemory() const;
     unsigned decodedSize() const { return m_decodedSize; }
     unsigned overheadSize() const;
     
@@ -158,7 +160,14 @@ public:
     
     void setRequest(CachedResourceRequest*);
 
-    SharedBuffer* data() const { ASSERT(!m_purgeableData); return m_data.get(); }
+    SharedBuffer* data() const
+    {
+        ASSERT(!m_purgeableData);
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+        ASSERT(m_compressedData.isEmpty());
+#endif
+        return m_data.get();
+    }
 
     void setResponse(const ResourceResponse&);
     const ResourceResponse& response() const { return m_response; }
@@ -210,6 +219,16 @@ public:
     // triggering a load. We should make it protected again if we can find a
     // better way to handle the archive case.
     bool makePurgeable(bool purgeable);
+
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    // The memory cache keeps the encoded data of dead text resources zlib-compressed when it needs
+    // room. Resources are uncompressed when they gain a client or are handed out by the memory cache;
+    // code that reads the data of a resource it holds no client for must call uncompressEncodedData()
+    // and check the return value first, as with makePurgeable(false).
+    bool isEncodedDataCompressed() const { return !m_compressedData.isEmpty(); }
+    bool compressEncodedData();
+    bool uncompressEncodedData();
+#endif
     
     // HTTP revalidation support methods for CachedResourceLoader.
     void setResourceToRevalidate(CachedResource*);
@@ -243,11 +262,17 @@ private:
     void addClientToSet(CachedResourceClient*);
 
     virtual PurgePriority purgePriority() const { return PurgeDefault; }
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    virtual bool shouldCompressEncodedData() const { return false; }
+#endif
 
     double currentAge() const;
     double freshnessLifetime() const;
 
     RefPtr<CachedMetadata> m_cachedMetadata;
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    Vector<char> m_compressedData;
+#endif
 
     double m_lastDecodedAccessTime; // Used as a "thrash guard" in the cache
 
@@ -295,6 +320,15 @@ private:
     HashSet<CachedResourceHandleBase*> m_handlesToRevalidate;
 };
 
+inline unsigned CachedResource::encodedSizeInMemory() const
+{
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    if (!m_compressedData.isEmpty())
+        return m_compressedData.size();
+#endif
+    return m_encodedSize;
+}
+
 }
 
 #endif
@@ -35,6 +35,7 @@
 #include "CachedXSLStyleSheet.h"
 #include "Console.h"
 #include "ContentSecurityPolicy.h"
+#include "DNS.h"
 #include "DOMWindow.h"
 #include "Document.h"
 #include "Frame.h"
@@ -681,6 +682,16 @@ void CachedResourceLoader::preload(CachedResource::Type type, const String& url,
     // FIXME: Rip this out when we are sure it is no longer necessary (even for mobile).
     UNUSED_PARAM(referencedFromBody);
 
+#if PLATFORM(ANDROID)
+    // Connect to other hosts now, while the request may still sit in the
+    // pending preloads or the load scheduler. Resources in the memory cache
+    // won't need a connection; the disk cache is checked by the port.
+    KURL fullURL = m_document->completeURL(url);
+    if (fullURL.protocolInHTTPFamily() && !protocolHostAndPortAreEqual(fullURL, m_document->url())
+            && !cachedResource(fullURL) && !memoryCache()->resourceForURL(fullURL))
+        preconnect(m_document, fullURL);
+#endif
+
     bool hasRendering = m_document->body() && m_document->body()->renderer();
     bool canBlockParser = type == CachedResource::Script || type == CachedResource::CSSStyleSheet;
     if (!hasRendering && !canBlockParser) {
@@ -137,6 +137,12 @@ PassRefPtr<CachedResourceRequest> CachedResourceRequest::load(CachedResourceLoad
     return request.release();
 }
 
+void CachedResourceRequest::setPriority(ResourceLoadPriority priority)
+{
+    if (m_loader)
+        resourceLoadScheduler()->setPriority(m_loader.get(), priority);
+}
+
 void CachedResourceRequest::willSendRequest(SubresourceLoader*, ResourceRequest&, const ResourceResponse&)
 {
     m_resource->setRequestedFromNetworkingLayer();
@@ -40,6 +40,7 @@ namespace WebCore {
         static PassRefPtr<CachedResourceRequest> load(CachedResourceLoader*, CachedResource*, bool incremental, SecurityCheckPolicy, bool sendResourceLoadCallbacks);
         ~CachedResourceRequest();
         void didFail(bool cancelled = false);
+        void setPriority(ResourceLoadPriority);
 
         CachedResourceLoader* cachedResourceLoader() const { return m_cachedResourceLoader; }
 
@@ -83,10 +83,11 @@ const String& CachedScript::script()
 {
     ASSERT(!isPurgeable());
 
-    if (!m_script && m_data) {
-        m_script = m_decoder->decode(m_data->data(), encodedSize());
-        m_script += m_decoder->flush();
-        setDecodedSize(m_script.length() * sizeof(UChar));
+    if (!m_script) {
+        if (SharedBuffer* encodedData = CachedResource::data()) {
+            m_script = m_decoder->decodeAndFlush(encodedData);
+            setDecodedSize(m_script.length() * sizeof(UChar));
+        }
     }
     m_decodedDataDeletionTimer.startOneShot(0);
     
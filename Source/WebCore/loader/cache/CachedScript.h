@@ -64,6 +64,9 @@ namespace WebCore {
     private:
         void decodedDataDeletionTimerFired(Timer<CachedScript>*);
         virtual PurgePriority purgePriority() const { return PurgeLast; }
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+        virtual bool shouldCompressEncodedData() const { return true; }
+#endif
 
         String m_script;
         RefPtr<TextResourceDecoder> m_decoder;
@@ -50,6 +50,8 @@ static const int cDefaultCacheCapacity = 8192 * 1024;
 static const double cMinDelayBeforeLiveDecodedPrune = 1; // Seconds.
 static const float cTargetPrunePercentage = .95f; // Percentage of capacity toward which we prune, to avoid immediately pruning again.
 static const double cDefaultDecodedDataDeletionInterval = 0;
+static const unsigned cProbationaryLRUListOffset = 33; // One more than the largest size bucket fastLog2() can return.
+static const unsigned cMaxDecodeCostWeight = 8;
 
 MemoryCache* memoryCache()
 {
@@ -90,7 +92,8 @@ bool MemoryCache::add(CachedResource* resource)
     
     m_resources.set(resource->url(), resource);
     resource->setInCache(true);
-    
+
+    recordLookup(resource, resource->resourceToRevalidate() ? LookupRevalidation : LookupMiss);
     resourceAccessed(resource);
     
     LOG(ResourceLoading, "MemoryCache::add Added '%s', resource %p\n", resource->url().latin1().data(), resource);
@@ -143,6 +146,13 @@ CachedResource* MemoryCache::resourceForURL(const KURL& resourceURL)
     // Add the size back since we had subtracted it when we marked the memory as purgeable.
     if (wasPurgeable)
         adjustSize(resource->hasClients(), resource->size());
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    if (resource && !resource->uncompressEncodedData()) {
+        ASSERT(!resource->hasClients());
+        evict(resource);
+        return 0;
+    }
+#endif
     return resource;
 }
 
@@ -249,6 +259,10 @@ void MemoryCache::pruneDeadResources()
                 // m_liveDecodedResources, and possibly move us to a different 
                 // LRU list in m_allResources.
                 current->destroyDecodedData();
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+                // Compressing the encoded data of text resources often frees enough to keep them cached.
+                current->compressEncodedData();
+#endif
                 
                 if (targetSize && m_deadSize <= targetSize) {
                     m_inPruneDeadResources = false;
@@ -365,10 +379,23 @@ static inline unsigned fastLog2(unsigned i)
     return log2;
 }
 
+// Decoding an image costs time roughly in proportion to its decoded size, so an image whose pixels
+// are much larger than its encoded data is expensive to bring back once evicted. Text resources
+// decode about as fast as they can be copied and are not weighted.
+static inline unsigned decodeCostWeight(CachedResource* resource)
+{
+    if (resource->type() != CachedResource::ImageResource || !resource->decodedSize())
+        return 1;
+    return min(1 + resource->decodedSize() / max(resource->encodedSize(), 1U), cMaxDecodeCostWeight);
+}
+
 MemoryCache::LRUList* MemoryCache::lruListFor(CachedResource* resource)
 {
     unsigned accessCount = max(resource->accessCount(), 1U);
-    unsigned queueIndex = fastLog2(resource->size() / accessCount);
+    unsigned queueIndex = fastLog2(resource->size() / (accessCount * decodeCostWeight(resource)));
+    // A resource is probationary until it is requested a second time.
+    if (accessCount == 1)
+        queueIndex += cProbationaryLRUListOffset;
 #ifndef NDEBUG
     resource->m_lruIndex = queueIndex;
 #endif
@@ -465,8 +492,11 @@ void MemoryCache::resourceAccessed(CachedResource* resource)
     removeFromLRUList(resource);
     
     // If this is the first time the resource has been accessed, adjust the size of the cache to account for its initial size.
+    // Otherwise it was requested again while in the cache.
     if (!resource->accessCount())
         adjustSize(resource->hasClients(), resource->size());
+    else
+        recordLookup(resource, LookupHit);
     
     // Add to our access count.
     resource->increaseAccessCount();
@@ -601,35 +631,62 @@ void MemoryCache::TypeStatistic::addResource(CachedResource* o)
     decodedSize += o->decodedSize();
     purgeableSize += purgeable ? pageSize : 0;
     purgedSize += purged ? pageSize : 0;
+#if ENABLE(COMPRESSED_RESOURCE_DATA)
+    if (o->isEncodedDataCompressed()) {
+        compressedSize += o->encodedSizeInMemory();
+        uncompressedSize += o->encodedSize();
+    }
+#endif
+}
+
+static MemoryCache::TypeStatistic* typeStatisticFor(MemoryCache::Statistics& stats, CachedResource* resource)
+{
+    switch (resource->type()) {
+    case CachedResource::ImageResource:
+        return &stats.images;
+    case CachedResource::CSSStyleSheet:
+        return &stats.cssStyleSheets;
+    case CachedResource::Script:
+        return &stats.scripts;
+#if ENABLE(XSLT)
+    case CachedResource::XSLStyleSheet:
+        return &stats.xslStyleSheets;
+#endif
+    case CachedResource::FontResource:
+        return &stats.fonts;
+    default:
+        return 0;
+    }
+}
+
+void MemoryCache::recordLookup(CachedResource* resource, LookupResult result)
+{
+    TypeStatistic* stat = typeStatisticFor(m_lookupStatistics, resource);
+    if (!stat)
+        return;
+
+    switch (result) {
+    case LookupHit:
+        stat->hits++;
+        break;
+    case LookupRevalidation:
+        stat->revalidations++;
+        break;
+    case LookupMiss:
+        stat->misses++;
+        break;
+    }
 }
 
 MemoryCache::Statistics MemoryCache::getStatistics()
 {
-    Statistics stats;
+    // Start from the lookup counts, which are kept as requests happen; the rest is collected now.
+    Statistics stats = m_lookupStatistics;
     CachedResourceMap::iterator e = m_resources.end();
     for (CachedResourceMap::iterator i = m_resources.begin(); i != e; ++i) {
         CachedResource* resource = i->second;
-        switch (resource->type()) {
-        case CachedResource::ImageResource:
-            stats.images.addResource(resource);
-            break;
-        case CachedResource::CSSStyleSheet:
-            stats.cssStyleSheets.addResource(resource);
-            break;
-        case CachedResource::Script:
-            stats.scripts.addResource(resource);
-            break;
-#if ENABLE(XSLT)
-        case CachedResource::XSLStyleSheet:
-            stats.xslStyleSheets.addResource(resource);
-            break;
-#endif
-        case CachedResource::FontResource:
-            stats.fonts.addResource(resource);
-            break;
-        default:
-            break;
-        }
+        if (TypeStatistic* stat = typeStatisticFor(stats, resource))
+            stat->addResource(resource);
     }
     return stats;
 }
@@ -658,33 +715,42 @@ void MemoryCache::evictResources()
 }
 
 #ifndef NDEBUG
+static void dumpTypeStatistic(const char* name, const MemoryCache::TypeStatistic& stat)
+{
+    float compressionRatio = stat.compressedSize ? static_cast<float>(stat.uncompressedSize) / stat.compressedSize : 0;
+    printf("%-13s %13d %13d %13d %13d %13d %13d %13d %13.2f %13d %13d %13d\n", name, stat.count, stat.size, stat.liveSize, stat.decodedSize, stat.purgeableSize, stat.purgedSize, stat.compressedSize, compressionRatio, stat.hits, stat.revalidations, stat.misses);
+}
+
 void MemoryCache::dumpStats()
 {
     Statistics s = getStatistics();
-    printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s\n", "", "Count", "Size", "LiveSize", "DecodedSize", "PurgeableSize", "PurgedSize");
-    printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s\n", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------");
-    printf("%-13s %13d %13d %13d %13d %13d %13d\n", "Images", s.images.count, s.images.size, s.images.liveSize, s.images.decodedSize, s.images.purgeableSize, s.images.purgedSize);
-    printf("%-13s %13d %13d %13d %13d %13d %13d\n", "CSS", s.cssStyleSheets.count, s.cssStyleSheets.size, s.cssStyleSheets.liveSize, s.cssStyleSheets.decodedSize, s.cssStyleSheets.purgeableSize, s.cssStyleSheets.purgedSize);
+    printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s\n", "", "Count", "Size", "LiveSize", "DecodedSize", "PurgeableSize", "PurgedSize", "Compressed", "CompressRatio", "Hits", "Revalidations", "Misses");
+    printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s\n", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------");
+    dumpTypeStatistic("Images", s.images);
+    dumpTypeStatistic("CSS", s.cssStyleSheets);
 #if ENABLE(XSLT)
-    printf("%-13s %13d %13d %13d %13d %13d %13d\n", "XSL", s.xslStyleSheets.count, s.xslStyleSheets.size, s.xslStyleSheets.liveSize, s.xslStyleSheets.decodedSize, s.xslStyleSheets.purgeableSize, s.xslStyleSheets.purgedSize);
+    dumpTypeStatistic("XSL", s.xslStyleSheets);
 #endif
-    printf("%-13s %13d %13d %13d %13d %13d %13d\n", "JavaScript", s.scripts.count, s.scripts.size, s.scripts.liveSize, s.scripts.decodedSize, s.scripts.purgeableSize, s.scripts.purgedSize);
-    printf("%-13s %13d %13d %13d %13d %13d %13d\n", "Fonts", s.fonts.count, s.fonts.size, s.fonts.liveSize, s.fonts.decodedSize, s.fonts.purgeableSize, s.fonts.purgedSize);
-    printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s\n\n", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------");
+    dumpTypeStatistic("JavaScript", s.scripts);
+    dumpTypeStatistic("Fonts", s.fonts);
+    printf("%-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s %-13s\n\n", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------", "-------------");
 }
 
 void MemoryCache::dumpLRULists(bool includeLive) const
 {
-    printf("LRU-SP lists in eviction order (Kilobytes decoded, Kilobytes encoded, Access count, Referenced, isPurgeable, wasPurged):\n");
+    printf("Segmented LRU-SP lists in eviction order (Kilobytes decoded, Kilobytes encoded, Access count, Decode cost weight, Referenced, isPurgeable, wasPurged):\n");
 
     int size = m_allResources.size();
     for (int i = size - 1; i >= 0; i--) {
-        printf("\n\nList %d: ", i);
+        if (i >= static_cast<int>(cProbationaryLRUListOffset))
+            printf("\n\nProbationary list %d: ", i - cProbationaryLRUListOffset);
+        else
+            printf("\n\nList %d: ", i);
         CachedResource* current = m_allResources[i].m_tail;
         while (current) {
             CachedResource* prev = current->m_prevInAllResourcesList;
             if (includeLive || !current->hasClients())
-                printf("(%.1fK, %.1fK, %uA, %dR, %d, %d); ", current->decodedSize() / 1024.0f, (current->encodedSize() + current->overheadSize()) / 1024.0f, current->accessCount(), current->hasClients(), current->isPurgeable(), current->wasPurged());
+                printf("(%.1fK, %.1fK, %uA, %uW, %dR, %d, %d); ", current->decodedSize() / 1024.0f, (current->encodedSize() + current->overheadSize()) / 1024.0f, current->accessCount(), decodeCostWeight(current), current->hasClients(), current->isPurgeable(), current->wasPurged());
 
             current = prev;
         }
@@ -72,6 +72,18 @@ struct SecurityOriginHash;
 // its member variables) are allocated in non-purgeable TC-malloc'd memory so we would see slightly
 // more memory use due to this.
 
+// Dead resources are evicted in segmented LRU order. Resources that have only been requested once
+// since they entered the cache are "probationary" and are all pruned, decoded data first, before any
+// resource that has been reused. Within a segment, the lists are bucketed by size divided by access
+// count and by the cost of decoding the resource again, and each list is in LRU order, so large,
+// rarely used and cheaply rebuilt resources go first. A page that loads many one-shot resources
+// therefore cannot push out the sprites, scripts and fonts that every page on a site shares.
+//
+// With ENABLE(COMPRESSED_RESOURCE_DATA), pruning first compresses the encoded data of dead scripts and
+// style sheets in each list, after destroying their decoded data and before evicting anything. Text
+// typically shrinks to a third or less, so more of it fits in the dead capacity; it is uncompressed
+// again when the resource is looked up or gets a client.
+
 class MemoryCache {
     WTF_MAKE_NONCOPYABLE(MemoryCache); WTF_MAKE_FAST_ALLOCATED;
 public:
@@ -92,7 +104,14 @@ public:
         int decodedSize;
         int purgeableSize;
         int purgedSize;
-        TypeStatistic() : count(0), size(0), liveSize(0), decodedSize(0), purgeableSize(0), purgedSize(0) { }
+        // Bytes of encoded data held compressed, and what they amount to uncompressed.
+        int compressedSize;
+        int uncompressedSize;
+        // Requests answered from the cache, by revalidating a cached resource, and by a new load.
+        int hits;
+        int revalidations;
+        int misses;
+        TypeStatistic() : count(0), size(0), liveSize(0), decodedSize(0), purgeableSize(0), purgedSize(0), compressedSize(0), uncompressedSize(0), hits(0), revalidations(0), misses(0) { }
         void addResource(CachedResource*);
     };
     
@@ -176,6 +195,9 @@ private:
     ~MemoryCache(); // Not implemented to make sure nobody accidentally calls delete -- WebCore does not delete singletons.
        
     LRUList* lruListFor(CachedResource*);
+
+    enum LookupResult { LookupHit, LookupRevalidation, LookupMiss };
+    void recordLookup(CachedResource*, LookupResult);
 #ifndef NDEBUG
     void dumpStats();
     void dumpLRULists(bool includeLive) const;
@@ -204,8 +226,9 @@ private:
 
     // Size-adjusted and popularity-aware LRU list collection for cache objects.  This collection can hold
     // more resources than the cached resource map, since it can also hold "stale" multiple versions of objects that are
-    // waiting to die when the clients referencing them go away.
-    Vector<LRUList, 32> m_allResources;
+    // waiting to die when the clients referencing them go away. Lists for probationary resources come after
+    // those for reused ones, so that pruning from the end reaches them first.
+    Vector<LRUList, 64> m_allResources;
     
     // List just for live resources with decoded data.  Access to this list is based off of painting the resource.
     LRUList m_liveDecodedResources;
@@ -213,6 +236,9 @@ private:
     // A URL-based map of all resources that are in the cache (including the freshest version of objects that are currently being 
     // referenced by a Web page).
     HashMap<String, CachedResource*> m_resources;
+
+    // Hit, revalidation and miss counts by resource type; the size fields are unused.
+    Statistics m_lookupStatistics;
 };
 
 inline bool MemoryCache::shouldMakeResourcePurgeableOnEviction()
@@ -1342,8 +1342,9 @@ void IconDatabase::performURLImport()
     // Notify the client that the URL import is complete in case it's managing its own pending notifications.
     dispatchDidFinishURLImportOnMainThread();
     
-    // Notify all DocumentLoaders that were waiting for an icon load decision on the main thread
-    callOnMainThread(notifyPendingLoadDecisionsOnMainThread, this);
+    // Notify all DocumentLoaders that were waiting for an icon load decision on the main thread.
+    // This goes in the same lane as the notifications above so that it runs after them.
+    callOnMainThread(notifyPendingLoadDecisionsOnMainThread, this, MainThreadIdlePriority);
 }
 
 void* IconDatabase::syncThreadMainLoop()
@@ -2216,7 +2217,7 @@ void IconDatabase::dispatchDidImportIconURLForPageURLOnMainThread(const String&
     ASSERT_ICON_SYNC_THREAD();
 
     ImportedIconURLForPageURLWorkItem* work = new ImportedIconURLForPageURLWorkItem(m_client, pageURL);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 void IconDatabase::dispatchDidImportIconDataForPageURLOnMainThread(const String& pageURL)
@@ -2224,7 +2225,7 @@ void IconDatabase::dispatchDidImportIconDataForPageURLOnMainThread(const String&
     ASSERT_ICON_SYNC_THREAD();
 
     ImportedIconDataForPageURLWorkItem* work = new ImportedIconDataForPageURLWorkItem(m_client, pageURL);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 void IconDatabase::dispatchDidRemoveAllIconsOnMainThread()
@@ -2232,7 +2233,7 @@ void IconDatabase::dispatchDidRemoveAllIconsOnMainThread()
     ASSERT_ICON_SYNC_THREAD();
 
     RemovedAllIconsWorkItem* work = new RemovedAllIconsWorkItem(m_client);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 void IconDatabase::dispatchDidFinishURLImportOnMainThread()
@@ -2240,7 +2241,7 @@ void IconDatabase::dispatchDidFinishURLImportOnMainThread()
     ASSERT_ICON_SYNC_THREAD();
 
     FinishedURLImport* work = new FinishedURLImport(m_client);
-    callOnMainThread(performWorkItem, work);
+    callOnMainThread(performWorkItem, work, MainThreadIdlePriority);
 }
 
 
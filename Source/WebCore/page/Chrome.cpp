@@ -359,7 +359,11 @@ void Chrome::mouseDidMoveOverElement(const HitTestResult& result, unsigned modif
     if (result.innerNode()) {
         Document* document = result.innerNode()->document();
         if (document && document->isDNSPrefetchEnabled())
+#if PLATFORM(ANDROID)
+            prefetchDNS(document, result.absoluteLinkURL().host());
+#else
             ResourceHandle::prepareForURL(result.absoluteLinkURL());
+#endif
     }
     m_client->mouseDidMoveOverElement(result, modifierFlags);
 
@@ -71,6 +71,8 @@ DOMTimer::DOMTimer(ScriptExecutionContext* context, PassOwnPtr<ScheduledAction>
     , m_shouldForwardUserGesture(shouldForwardUserGesture(interval, m_nestingLevel))
 {
     scriptExecutionContext()->addTimeout(m_timeoutId, this);
+    // Script timeouts promise no exact deadline, so their fire times may be coalesced.
+    setAllowsFireTimeCoalescing(true);
 
     double intervalMilliseconds = intervalClampedToMinimum(interval, context->minimumTimerInterval());
     if (singleShot)
@@ -319,6 +319,11 @@ namespace WebCore {
         void setLocalStorageDatabasePath(const String&);
         const String& localStorageDatabasePath() const { return m_localStorageDatabasePath; }
 
+        // Directory in which large resources are kept in memory-mapped files instead of the heap.
+        // Empty, the default, keeps them on the heap. Not used while private browsing is enabled.
+        void setResourceFileBackingPath(const String&);
+        const String& resourceFileBackingPath() const { return m_resourceFileBackingPath; }
+
         void setApplicationChromeMode(bool);
         bool inApplicationChromeMode() const { return m_inApplicationChromeMode; }
 
@@ -491,6 +496,7 @@ namespace WebCore {
         String m_defaultTextEncodingName;
         String m_ftpDirectoryTemplatePath;
         String m_localStorageDatabasePath;
+        String m_resourceFileBackingPath;
         KURL m_userStyleSheetLocation;
         AtomicString m_standardFontFamily;
         AtomicString m_fixedFontFamily;
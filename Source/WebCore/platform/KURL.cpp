@@ -366,14 +366,18 @@ void KURL::init(const KURL& base, const String& relative, const TextEncoding& en
 
     String* originalString = &rel;
 
-    bool allASCII = charactersAreAllASCII(rel.characters(), rel.length());
+    bool allASCII = rel.containsOnlyASCII();
     CharBuffer strBuffer;
     char* str;
     size_t len;
     if (allASCII) {
         len = rel.length();
         strBuffer.resize(len + 1);
-        copyASCII(rel.characters(), len, strBuffer.data());
+        // Attribute values are often 8-bit; do not make them keep a UTF-16 copy.
+        if (rel.is8Bit())
+            memcpy(strBuffer.data(), rel.impl()->characters8(), len);
+        else
+            copyASCII(rel.characters(), len, strBuffer.data());
         strBuffer[len] = 0;
         str = strBuffer.data();
     } else {
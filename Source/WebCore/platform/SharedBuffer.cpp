@@ -30,6 +30,14 @@
 #include "PurgeableBuffer.h"
 #include <wtf/PassOwnPtr.h>
 
+#if HAVE(MMAP)
+#include "FileSystem.h"
+#include <limits>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 namespace WebCore {
@@ -57,19 +65,168 @@ static inline void freeSegment(char* p)
     fastFree(p);
 }
 
+// Bytes copied in after adopted segments. Each one is filled up to its capacity
+// before the next is made, and never moves, so that pointers into it stay valid.
+class SharedBuffer::CopiedDataSegment : public SharedBuffer::DataSegment {
+public:
+    static PassRefPtr<CopiedDataSegment> create(unsigned capacity) { return adoptRef(new CopiedDataSegment(capacity)); }
+    virtual ~CopiedDataSegment() { fastFree(m_data); }
+
+    virtual const char* data() const { return m_data; }
+    virtual unsigned size() const { return m_size; }
+
+    // Returns the number of bytes that fitted.
+    unsigned append(const char* data, unsigned length)
+    {
+        unsigned bytesToCopy = min(length, m_capacity - m_size);
+        memcpy(m_data + m_size, data, bytesToCopy);
+        m_size += bytesToCopy;
+        return bytesToCopy;
+    }
+
+private:
+    CopiedDataSegment(unsigned capacity)
+        : m_data(static_cast<char*>(fastMalloc(capacity)))
+        , m_size(0)
+        , m_capacity(capacity)
+    {
+    }
+
+    char* m_data;
+    unsigned m_size;
+    unsigned m_capacity;
+};
+
+#if HAVE(MMAP)
+
+// An unlinked temporary file mapped shared, so that the kernel can write its
+// pages back to the file under memory pressure instead of keeping them resident.
+// The file is mapped into a larger range of reserved address space, where it
+// grows in place. Once it outgrows that, it moves to a new range and the old
+// one stays mapped, so that pointers into the mapping are never invalidated.
+class SharedBuffer::MappedFile {
+    WTF_MAKE_NONCOPYABLE(MappedFile); WTF_MAKE_FAST_ALLOCATED;
+public:
+    static PassOwnPtr<MappedFile> create(const CString& fileTemplate)
+    {
+        Vector<char> path;
+        path.append(fileTemplate.data(), fileTemplate.length() + 1);
+        int fileDescriptor = mkstemp(path.data());
+        if (fileDescriptor == -1)
+            return PassOwnPtr<MappedFile>();
+        unlink(path.data());
+        return adoptPtr(new MappedFile(fileDescriptor));
+    }
+
+    ~MappedFile()
+    {
+        if (m_data)
+            munmap(m_data, m_reservedSize);
+        for (size_t i = 0; i < m_previousMappings.size(); ++i)
+            munmap(m_previousMappings[i].first, m_previousMappings[i].second);
+        close(m_fileDescriptor);
+    }
+
+    char* data() const { return m_data; }
+    unsigned size() const { return m_size; }
+
+    // Keeps the current contents. Returns false, leaving the mapping as it was,
+    // if the file cannot grow.
+    bool resize(unsigned size)
+    {
+        if (size <= m_capacity) {
+            m_size = size;
+            return true;
+        }
+
+        size_t capacity = roundUpToPageSize(max<size_t>(size, m_capacity + m_capacity / 4));
+        if (ftruncate(m_fileDescriptor, capacity))
+            return false;
+
+        if (capacity <= m_reservedSize) {
+            // Mapping over the pages that are already there keeps their contents and addresses.
+            if (mmap(m_data, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, m_fileDescriptor, 0) == MAP_FAILED)
+                return false;
+        } else {
+            size_t reservedSize = roundUpToPageSize(min<size_t>(static_cast<size_t>(capacity) * reservationFactor, numeric_limits<unsigned>::max()));
+            void* reservation = mmap(0, reservedSize, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
+            if (reservation == MAP_FAILED)
+                return false;
+            if (mmap(reservation, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, m_fileDescriptor, 0) == MAP_FAILED) {
+                munmap(reservation, reservedSize);
+                return false;
+            }
+            if (m_data)
+                m_previousMappings.append(make_pair(m_data, m_reservedSize));
+            m_data = static_cast<char*>(reservation);
+            m_reservedSize = reservedSize;
+        }
+        m_capacity = capacity;
+        m_size = size;
+        return true;
+    }
+
+private:
+    // Address space is cheap next to the heap memory this saves, so reserve
+    // enough for the mapping to grow a few times in place.
+    static const size_t reservationFactor = 4;
+
+    MappedFile(int fileDescriptor)
+        : m_fileDescriptor(fileDescriptor)
+        , m_data(0)
+        , m_size(0)
+        , m_capacity(0)
+        , m_reservedSize(0)
+    {
+    }
+
+    static size_t roundUpToPageSize(size_t size)
+    {
+        size_t pageSize = getpagesize();
+        return (size + pageSize - 1) & ~(pageSize - 1);
+    }
+
+    int m_fileDescriptor;
+    char* m_data;
+    unsigned m_size;
+    size_t m_capacity;
+    size_t m_reservedSize;
+    Vector<pair<char*, size_t> > m_previousMappings;
+};
+
+#endif
+
 SharedBuffer::SharedBuffer()
     : m_size(0)
+    , m_dataSegmentsSize(0)
+    , m_lastCopiedDataSegment(0)
+    , m_fileBackingFailed(false)
+#if HAVE(MMAP)
+    , m_fileBackingMinimumSize(0)
+#endif
 {
 }
 
 SharedBuffer::SharedBuffer(const char* data, int size)
     : m_size(0)
+    , m_dataSegmentsSize(0)
+    , m_lastCopiedDataSegment(0)
+    , m_fileBackingFailed(false)
+#if HAVE(MMAP)
+    , m_fileBackingMinimumSize(0)
+#endif
 {
     append(data, size);
 }
 
 SharedBuffer::SharedBuffer(const unsigned char* data, int size)
     : m_size(0)
+    , m_dataSegmentsSize(0)
+    , m_lastCopiedDataSegment(0)
+    , m_fileBackingFailed(false)
+#if HAVE(MMAP)
+    , m_fileBackingMinimumSize(0)
+#endif
 {
     append(reinterpret_cast<const char*>(data), size);
 }
@@ -113,6 +270,11 @@ const char* SharedBuffer::data() const
     
     if (m_purgeableBuffer)
         return m_purgeableBuffer->data();
+
+#if HAVE(MMAP)
+    if (const char* mappedData = this->mappedData())
+        return mappedData;
+#endif
     
     return buffer().data();
 }
@@ -122,8 +284,13 @@ void SharedBuffer::append(const char* data, unsigned length)
     ASSERT(!m_purgeableBuffer);
 
     maybeTransferPlatformData();
+
+    if (!m_dataSegments.isEmpty()) {
+        appendCopiedDataSegments(data, length);
+        return;
+    }
     
-    unsigned positionInSegment = offsetInSegment(m_size - m_buffer.size());
+    unsigned positionInSegment = offsetInSegment(m_size - consecutiveSize());
     m_size += length;
 
     if (m_size <= segmentSize) {
@@ -155,6 +322,57 @@ void SharedBuffer::append(const char* data, unsigned length)
     }
 }
 
+void SharedBuffer::appendCopiedDataSegments(const char* data, unsigned length)
+{
+    // Adopted segments have to stay last, so the copy goes after them rather than into m_segments.
+    m_size += length;
+    m_dataSegmentsSize += length;
+    if (m_lastCopiedDataSegment) {
+        unsigned bytesCopied = m_lastCopiedDataSegment->append(data, length);
+        data += bytesCopied;
+        length -= bytesCopied;
+    }
+    if (!length)
+        return;
+
+    RefPtr<CopiedDataSegment> segment = CopiedDataSegment::create(max(length, segmentSize));
+    segment->append(data, length);
+    m_lastCopiedDataSegment = segment.get();
+    m_dataSegments.append(segment.release());
+}
+
+void SharedBuffer::append(PassRefPtr<DataSegment> prpSegment)
+{
+    ASSERT(!m_purgeableBuffer);
+
+    maybeTransferPlatformData();
+
+    RefPtr<DataSegment> segment = prpSegment;
+    if (!segment->size())
+        return;
+
+    m_size += segment->size();
+    m_dataSegmentsSize += segment->size();
+    m_dataSegments.append(segment.release());
+    m_lastCopiedDataSegment = 0;
+}
+
+void SharedBuffer::setFileBacking(const String& directory, unsigned minimumSize)
+{
+#if HAVE(MMAP)
+    if (directory.isEmpty()) {
+        m_fileBackingTemplate = CString();
+        m_fileBackingMinimumSize = 0;
+        return;
+    }
+    m_fileBackingTemplate = fileSystemRepresentation(pathByAppendingComponent(directory, "SharedBufferXXXXXX"));
+    m_fileBackingMinimumSize = max(minimumSize, segmentSize + 1);
+#else
+    UNUSED_PARAM(directory);
+    UNUSED_PARAM(minimumSize);
+#endif
+}
+
 void SharedBuffer::clear()
 {
     clearPlatformData();
@@ -163,10 +381,17 @@ void SharedBuffer::clear()
         freeSegment(m_segments[i]);
 
     m_segments.clear();
+    m_dataSegments.clear();
+    m_dataSegmentsSize = 0;
+    m_lastCopiedDataSegment = 0;
     m_size = 0;
 
     m_buffer.clear();
     m_purgeableBuffer.clear();
+#if HAVE(MMAP)
+    m_mappedFile.clear();
+    m_abandonedMappedFile.clear();
+#endif
 #if HAVE(CFNETWORK_DATA_ARRAY_CALLBACK)
     m_dataArray.clear();
 #endif
@@ -175,6 +400,10 @@ void SharedBuffer::clear()
 PassRefPtr<SharedBuffer> SharedBuffer::copy() const
 {
     RefPtr<SharedBuffer> clone(adoptRef(new SharedBuffer));
+#if HAVE(MMAP)
+    clone->m_fileBackingTemplate = m_fileBackingTemplate;
+    clone->m_fileBackingMinimumSize = m_fileBackingMinimumSize;
+#endif
     if (m_purgeableBuffer || hasPlatformData()) {
         clone->append(data(), size());
         return clone;
@@ -182,9 +411,12 @@ PassRefPtr<SharedBuffer> SharedBuffer::copy() const
 
     clone->m_size = m_size;
     clone->m_buffer.reserveCapacity(m_size);
-    clone->m_buffer.append(m_buffer.data(), m_buffer.size());
-    for (unsigned i = 0; i < m_segments.size(); ++i)
-        clone->m_buffer.append(m_segments[i], segmentSize);
+    const char* segment;
+    unsigned position = 0;
+    while (unsigned length = getSomeData(segment, position)) {
+        clone->m_buffer.append(segment, length);
+        position += length;
+    }
     return clone;
 }
 
@@ -196,24 +428,88 @@ PassOwnPtr<PurgeableBuffer> SharedBuffer::releasePurgeableBuffer()
 
 const Vector<char>& SharedBuffer::buffer() const
 {
+#if HAVE(MMAP)
+    ASSERT(!m_mappedFile);
+#endif
     unsigned bufferSize = m_buffer.size();
     if (m_size > bufferSize) {
         m_buffer.resize(m_size);
-        char* destination = m_buffer.data() + bufferSize;
-        unsigned bytesLeft = m_size - bufferSize;
-        for (unsigned i = 0; i < m_segments.size(); ++i) {
-            unsigned bytesToCopy = min(bytesLeft, segmentSize);
-            memcpy(destination, m_segments[i], bytesToCopy);
-            destination += bytesToCopy;
-            bytesLeft -= bytesToCopy;
-            freeSegment(m_segments[i]);
-        }
-        m_segments.clear();
+        copySegmentsAndClear(m_buffer.data() + bufferSize, m_size - bufferSize - m_dataSegmentsSize);
+    }
+    return m_buffer;
+}
+
+void SharedBuffer::copySegmentsAndClear(char* destination, unsigned bytesLeft) const
+{
+    for (unsigned i = 0; i < m_segments.size(); ++i) {
+        unsigned bytesToCopy = min(bytesLeft, segmentSize);
+        memcpy(destination, m_segments[i], bytesToCopy);
+        destination += bytesToCopy;
+        bytesLeft -= bytesToCopy;
+        freeSegment(m_segments[i]);
+    }
+    m_segments.clear();
+    for (unsigned i = 0; i < m_dataSegments.size(); ++i) {
+        unsigned bytesToCopy = m_dataSegments[i]->size();
+        memcpy(destination, m_dataSegments[i]->data(), bytesToCopy);
+        destination += bytesToCopy;
+    }
+    m_dataSegments.clear();
+    m_dataSegmentsSize = 0;
+    m_lastCopiedDataSegment = 0;
 #if HAVE(CFNETWORK_DATA_ARRAY_CALLBACK)
-        copyDataArrayAndClear(destination, bytesLeft);
+    copyDataArrayAndClear(destination, bytesLeft);
 #endif
+}
+
+#if HAVE(MMAP)
+const char* SharedBuffer::mappedData() const
+{
+    if (!m_mappedFile) {
+        if (!m_fileBackingMinimumSize || m_size < m_fileBackingMinimumSize || m_fileBackingFailed)
+            return 0;
+        m_mappedFile = MappedFile::create(m_fileBackingTemplate);
+        if (!m_mappedFile) {
+            m_fileBackingFailed = true;
+            return 0;
+        }
     }
-    return m_buffer;
+
+    unsigned mappedSize = m_mappedFile->size();
+    if (m_size > mappedSize) {
+        if (!m_mappedFile->resize(m_size)) {
+            // Fall back to the heap for the rest of this buffer's life.
+            m_buffer.append(m_mappedFile->data(), mappedSize);
+            m_abandonedMappedFile = m_mappedFile.release();
+            m_fileBackingFailed = true;
+            return 0;
+        }
+        char* destination = m_mappedFile->data() + mappedSize;
+        unsigned bufferSize = m_buffer.size();
+        memcpy(destination, m_buffer.data(), bufferSize);
+        m_buffer.clear();
+        copySegmentsAndClear(destination + bufferSize, m_size - mappedSize - bufferSize - m_dataSegmentsSize);
+    }
+    return m_mappedFile->data();
+}
+#endif
+
+const char* SharedBuffer::consecutiveData() const
+{
+#if HAVE(MMAP)
+    if (m_mappedFile)
+        return m_mappedFile->data();
+#endif
+    return m_buffer.data();
+}
+
+unsigned SharedBuffer::consecutiveSize() const
+{
+#if HAVE(MMAP)
+    if (m_mappedFile)
+        return m_mappedFile->size();
+#endif
+    return m_buffer.size();
 }
 
 unsigned SharedBuffer::getSomeData(const char*& someData, unsigned position) const
@@ -228,14 +524,29 @@ unsigned SharedBuffer::getSomeData(const char*& someData, unsigned position) con
         return 0;
     }
 
-    unsigned consecutiveSize = m_buffer.size();
+    unsigned consecutiveSize = this->consecutiveSize();
     if (position < consecutiveSize) {
-        someData = m_buffer.data() + position;
+        someData = consecutiveData() + position;
         return consecutiveSize - position;
     }
  
     position -= consecutiveSize;
-    unsigned segmentedSize = m_size - consecutiveSize;
+    unsigned segmentedSize = m_size - consecutiveSize - m_dataSegmentsSize;
+    if (position >= segmentedSize) {
+        position -= segmentedSize;
+        for (unsigned i = 0; i < m_dataSegments.size(); ++i) {
+            unsigned dataSegmentSize = m_dataSegments[i]->size();
+            if (position < dataSegmentSize) {
+                someData = m_dataSegments[i]->data() + position;
+                return dataSegmentSize - position;
+            }
+            position -= dataSegmentSize;
+        }
+        ASSERT_NOT_REACHED();
+        someData = 0;
+        return 0;
+    }
+
     unsigned segments = m_segments.size();
     unsigned segment = segmentIndex(position);
     ASSERT(segment < segments);
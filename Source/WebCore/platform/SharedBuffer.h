@@ -30,7 +30,9 @@
 #include <wtf/Forward.h>
 #include <wtf/OwnPtr.h>
 #include <wtf/RefCounted.h>
+#include <wtf/RefPtr.h>
 #include <wtf/Vector.h>
+#include <wtf/text/CString.h>
 
 #if USE(CF)
 #include <wtf/RetainPtr.h>
@@ -51,6 +53,15 @@ class PurgeableBuffer;
 
 class SharedBuffer : public RefCounted<SharedBuffer> {
 public:
+    // Bytes owned elsewhere, such as a network read buffer, that a SharedBuffer can
+    // keep a reference to instead of copying them.
+    class DataSegment : public RefCounted<DataSegment> {
+    public:
+        virtual ~DataSegment() { }
+        virtual const char* data() const = 0;
+        virtual unsigned size() const = 0;
+    };
+
     static PassRefPtr<SharedBuffer> create() { return adoptRef(new SharedBuffer); }
     static PassRefPtr<SharedBuffer> create(const char* c, int i) { return adoptRef(new SharedBuffer(c, i)); }
     static PassRefPtr<SharedBuffer> create(const unsigned char* c, int i) { return adoptRef(new SharedBuffer(c, i)); }
@@ -62,7 +73,7 @@ public:
     // The buffer must be in non-purgeable state before adopted to a SharedBuffer. 
     // It will stay that way until released.
     static PassRefPtr<SharedBuffer> adoptPurgeableBuffer(PassOwnPtr<PurgeableBuffer>);
-    
+
 #if PLATFORM(ANDROID)
     virtual
 #endif
@@ -93,7 +104,17 @@ public:
     bool isEmpty() const { return !size(); }
 
     void append(const char*, unsigned);
+    // Adopts the segment as the next part of the buffer without copying it.
+    void append(PassRefPtr<DataSegment>);
     void clear();
+
+    // Once this buffer holds at least minimumSize bytes, it is flattened into a
+    // memory-mapped, unlinked temporary file in directory instead of the heap.
+    // Passing an empty directory, the default, keeps the buffer on the heap.
+    // Once it is file-backed, pointers returned by data() stay valid as the
+    // buffer grows, until clear().
+    void setFileBacking(const String& directory, unsigned minimumSize);
+
     const char* platformData() const;
     unsigned platformDataSize() const;
 
@@ -134,6 +155,21 @@ private:
     // memory, which can be a source of bugs.
     const Vector<char>& buffer() const;
 
+    // The bytes in front of the segments: the mapped file when there is one,
+    // m_buffer otherwise.
+    const char* consecutiveData() const;
+    class CopiedDataSegment;
+    void appendCopiedDataSegments(const char*, unsigned);
+    unsigned consecutiveSize() const;
+    void copySegmentsAndClear(char* destination, unsigned bytesLeft) const;
+
+#if HAVE(MMAP)
+    class MappedFile;
+    // Flattens into the mapped file, creating it if the buffer is large enough.
+    // Returns 0 if the buffer is not file-backed.
+    const char* mappedData() const;
+#endif
+
     void clearPlatformData();
     void maybeTransferPlatformData();
     bool hasPlatformData() const;
@@ -141,7 +177,22 @@ private:
     unsigned m_size;
     mutable Vector<char> m_buffer;
     mutable Vector<char*> m_segments;
+    // Adopted segments always come after m_buffer and m_segments.
+    mutable Vector<RefPtr<DataSegment> > m_dataSegments;
+    mutable unsigned m_dataSegmentsSize;
+    // The last of m_dataSegments when it holds copied bytes and may have room for more.
+    mutable CopiedDataSegment* m_lastCopiedDataSegment;
+    // Set once the buffer could not be mapped, so that it stays on the heap.
+    mutable bool m_fileBackingFailed;
     OwnPtr<PurgeableBuffer> m_purgeableBuffer;
+#if HAVE(MMAP)
+    CString m_fileBackingTemplate;
+    unsigned m_fileBackingMinimumSize;
+    // When set, m_buffer is empty and the mapped file holds the flattened bytes.
+    mutable OwnPtr<MappedFile> m_mappedFile;
+    // A mapped file given up for the heap. Readers may still point into it, so it is kept until clear().
+    mutable OwnPtr<MappedFile> m_abandonedMappedFile;
+#endif
 #if HAVE(CFNETWORK_DATA_ARRAY_CALLBACK)
     mutable Vector<RetainPtr<CFDataRef> > m_dataArray;
     void copyDataArrayAndClear(char *destination, unsigned bytesToCopy) const;
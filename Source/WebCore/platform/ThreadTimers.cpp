@@ -30,7 +30,14 @@
 #include "SharedTimer.h"
 #include "ThreadGlobalData.h"
 #include "Timer.h"
+#include <algorithm>
+#include <limits.h>
+#include <limits>
+#include <math.h>
 #include <wtf/CurrentTime.h>
+#include <wtf/Vector.h>
+
+using namespace std;
 
 namespace WebCore {
 
@@ -39,8 +46,12 @@ namespace WebCore {
 // This is to prevent UI freeze when there are too many timers or machine performance is low.
 static const double maxDurationOfFiringTimers = 0.050;
 
+// Granularity of the timing wheel. Timers within the same tick are ordered by their exact fire time
+// when they expire, so this only affects how timers are bucketed.
+static const double ticksPerSecond = 1024;
+
 // Timers are created, started and fired on the same thread, and each thread has its own ThreadTimers
-// copy to keep the heap and a set of currently firing timers.
+// copy to keep the timing wheel and a set of currently firing timers.
 
 static MainThreadSharedTimer* mainThreadSharedTimer()
 {
@@ -48,10 +59,52 @@ static MainThreadSharedTimer* mainThreadSharedTimer()
     return timer;
 }
 
+static inline unsigned long long tickForTime(double time)
+{
+    if (time <= 0)
+        return 0;
+    return static_cast<unsigned long long>(time * ticksPerSecond);
+}
+
+static inline unsigned firstSetBit(unsigned long long bits)
+{
+    ASSERT(bits);
+#if COMPILER(GCC)
+    return __builtin_ctzll(bits);
+#else
+    unsigned index = 0;
+    while (!(bits & 1)) {
+        bits >>= 1;
+        ++index;
+    }
+    return index;
+#endif
+}
+
+ThreadTimers::Statistics::Statistics()
+    : activeTimers(0)
+    , peakActiveTimers(0)
+    , firedTimers(0)
+    , wakeups(0)
+    , cascadedTimers(0)
+    , totalFireLateness(0)
+    , maxFireLateness(0)
+{
+}
+
 ThreadTimers::ThreadTimers()
-    : m_sharedTimer(0)
+    : m_currentTick(0)
+    , m_timerCount(0)
+    , m_firstTimer(0)
+    , m_firstTimerIsValid(true)
+    , m_sharedTimer(0)
     , m_firingTimers(false)
 {
+    for (unsigned i = 0; i <= expiredSlot; ++i)
+        m_slots[i] = 0;
+    for (unsigned i = 0; i < wheelLevels; ++i)
+        m_occupiedSlots[i] = 0;
+
     if (isMainThread())
         setSharedTimer(mainThreadSharedTimer());
 }
@@ -78,10 +131,259 @@ void ThreadTimers::updateSharedTimer()
     if (!m_sharedTimer)
         return;
         
-    if (m_firingTimers || m_timerHeap.isEmpty())
+    TimerBase* first = m_firingTimers ? 0 : firstTimer();
+    if (!first)
         m_sharedTimer->stop();
     else
-        m_sharedTimer->setFireTime(m_timerHeap.first()->m_nextFireTime);
+        m_sharedTimer->setFireTime(first->m_nextFireTime);
+}
+
+double ThreadTimers::coalescedFireTime(double fireTime, double delay)
+{
+    // The windows are powers of two so that the rounded times are exact and line up across timers.
+    double window;
+    if (delay >= 1)
+        window = 1.0 / 16;
+    else if (delay >= 0.25)
+        window = 1.0 / 64;
+    else if (delay >= 1.0 / 16)
+        window = 1.0 / 256;
+    else
+        return fireTime;
+    return ceil(fireTime / window) * window;
+}
+
+void ThreadTimers::resetStatistics()
+{
+    m_statistics = Statistics();
+    m_statistics.activeTimers = m_timerCount;
+    m_statistics.peakActiveTimers = m_timerCount;
+}
+
+bool ThreadTimers::firesBefore(const TimerBase* a, const TimerBase* b)
+{
+    if (a->m_nextFireTime != b->m_nextFireTime)
+        return a->m_nextFireTime < b->m_nextFireTime;
+
+    // We need to look at the difference of the insertion orders instead of comparing the two 
+    // outright in case of overflow. 
+    unsigned difference = b->m_insertionOrder - a->m_insertionOrder;
+    return difference && difference < UINT_MAX / 2;
+}
+
+// A timer due at a tick in the same level 0 window as the current tick goes into the level 0 slot
+// for that tick. Otherwise it goes into the lowest level whose window still contains both ticks,
+// in the slot for the lower level window it falls in. Timers beyond the top level wait in a
+// separate overflow list.
+unsigned ThreadTimers::slotForTick(unsigned long long tick) const
+{
+    ASSERT(tick >= m_currentTick);
+    for (unsigned level = 0; level < wheelLevels; ++level) {
+        unsigned shift = bitsPerLevel * (level + 1);
+        if ((tick >> shift) == (m_currentTick >> shift))
+            return level * slotsPerLevel + static_cast<unsigned>((tick >> (shift - bitsPerLevel)) & slotMask);
+    }
+    return overflowSlot;
+}
+
+void ThreadTimers::linkTimer(TimerBase* timer, unsigned slot)
+{
+    TimerBase*& head = m_slots[slot];
+    timer->m_wheelPrevious = 0;
+    timer->m_wheelNext = head;
+    if (head)
+        head->m_wheelPrevious = timer;
+    head = timer;
+    timer->m_wheelSlot = slot;
+
+    if (slot < overflowSlot)
+        m_occupiedSlots[slot / slotsPerLevel] |= 1ULL << (slot % slotsPerLevel);
+}
+
+void ThreadTimers::unlinkTimer(TimerBase* timer)
+{
+    unsigned slot = timer->m_wheelSlot;
+    if (timer->m_wheelPrevious)
+        timer->m_wheelPrevious->m_wheelNext = timer->m_wheelNext;
+    else
+        m_slots[slot] = timer->m_wheelNext;
+    if (timer->m_wheelNext)
+        timer->m_wheelNext->m_wheelPrevious = timer->m_wheelPrevious;
+
+    timer->m_wheelPrevious = 0;
+    timer->m_wheelNext = 0;
+    timer->m_wheelSlot = -1;
+
+    if (slot < overflowSlot && !m_slots[slot])
+        m_occupiedSlots[slot / slotsPerLevel] &= ~(1ULL << (slot % slotsPerLevel));
+}
+
+bool ThreadTimers::insertTimer(TimerBase* timer)
+{
+    ASSERT(timer->m_nextFireTime);
+    ASSERT(!timer->inWheel());
+
+    // Nothing is positioned relative to the current tick while the wheel is empty, so catch up
+    // with the clock to keep new timers out of the higher levels.
+    if (!m_timerCount)
+        m_currentTick = max(m_currentTick, tickForTime(currentTime()));
+
+    linkTimer(timer, slotForTick(max(tickForTime(timer->m_nextFireTime), m_currentTick)));
+
+    ++m_timerCount;
+    m_statistics.activeTimers = m_timerCount;
+    m_statistics.peakActiveTimers = max(m_statistics.peakActiveTimers, m_timerCount);
+
+    if (!m_firstTimerIsValid)
+        return true;
+    if (m_firstTimer && !firesBefore(timer, m_firstTimer))
+        return false;
+    m_firstTimer = timer;
+    return true;
+}
+
+bool ThreadTimers::removeTimer(TimerBase* timer)
+{
+    ASSERT(timer->inWheel());
+    unlinkTimer(timer);
+
+    --m_timerCount;
+    m_statistics.activeTimers = m_timerCount;
+
+    if (m_firstTimerIsValid && m_firstTimer != timer)
+        return false;
+    m_firstTimer = 0;
+    m_firstTimerIsValid = false;
+    return true;
+}
+
+TimerBase* ThreadTimers::firstTimer()
+{
+    if (!m_firstTimerIsValid) {
+        m_firstTimer = computeFirstTimer();
+        m_firstTimerIsValid = true;
+    }
+    return m_firstTimer;
+}
+
+TimerBase* ThreadTimers::computeFirstTimer() const
+{
+    // The expired list is kept sorted.
+    TimerBase* first = m_slots[expiredSlot];
+
+    // Every timer on a level fires before every timer on the levels above it, so only the first
+    // occupied slot of the lowest occupied level needs to be searched.
+    for (unsigned level = 0; level < wheelLevels; ++level) {
+        unsigned shift = bitsPerLevel * level;
+        unsigned long long occupied = m_occupiedSlots[level] & (~0ULL << ((m_currentTick >> shift) & slotMask));
+        if (!occupied)
+            continue;
+        for (TimerBase* timer = m_slots[level * slotsPerLevel + firstSetBit(occupied)]; timer; timer = timer->m_wheelNext) {
+            if (!first || firesBefore(timer, first))
+                first = timer;
+        }
+        return first;
+    }
+
+    for (TimerBase* timer = m_slots[overflowSlot]; timer; timer = timer->m_wheelNext) {
+        if (!first || firesBefore(timer, first))
+            first = timer;
+    }
+    return first;
+}
+
+// Returns the first tick after the current one at which a level 0 slot has timers or an occupied
+// slot on a higher level has to be cascaded.
+unsigned long long ThreadTimers::nextEventTick() const
+{
+    for (unsigned level = 0; level < wheelLevels; ++level) {
+        unsigned shift = bitsPerLevel * level;
+        unsigned currentIndex = static_cast<unsigned>((m_currentTick >> shift) & slotMask);
+        unsigned long long occupied = m_occupiedSlots[level] & ~((2ULL << currentIndex) - 1);
+        if (!occupied)
+            continue;
+        unsigned long long windowStart = (m_currentTick >> (shift + bitsPerLevel)) << (shift + bitsPerLevel);
+        return windowStart | (static_cast<unsigned long long>(firstSetBit(occupied)) << shift);
+    }
+
+    if (m_slots[overflowSlot]) {
+        unsigned shift = bitsPerLevel * wheelLevels;
+        return ((m_currentTick >> shift) + 1) << shift;
+    }
+
+    return numeric_limits<unsigned long long>::max();
+}
+
+// Called when the wheel enters a new tick. On every level where the tick starts a new window, the
+// timers in the slot for that window are moved down, starting with the highest level.
+void ThreadTimers::cascade(unsigned long long tick)
+{
+    ASSERT(tick == m_currentTick);
+    for (unsigned level = wheelLevels; level >= 1; --level) {
+        unsigned shift = bitsPerLevel * level;
+        if (tick & ((1ULL << shift) - 1))
+            continue;
+
+        unsigned slot = level == wheelLevels ? overflowSlot : level * slotsPerLevel + static_cast<unsigned>((tick >> shift) & slotMask);
+        TimerBase* timer = m_slots[slot];
+        if (!timer)
+            continue;
+        m_slots[slot] = 0;
+        if (slot < overflowSlot)
+            m_occupiedSlots[level] &= ~(1ULL << (slot % slotsPerLevel));
+
+        while (timer) {
+            TimerBase* next = timer->m_wheelNext;
+            linkTimer(timer, slotForTick(max(tickForTime(timer->m_nextFireTime), m_currentTick)));
+            ++m_statistics.cascadedTimers;
+            timer = next;
+        }
+    }
+}
+
+// Advances the wheel through the given tick and moves every timer due up to then to the expired
+// list, sorted by fire time. Timers that are within the last tick but not yet due are put back by
+// rescheduleExpiredTimers().
+void ThreadTimers::collectExpiredTimers(unsigned long long throughTick)
+{
+    Vector<TimerBase*> expired;
+
+    // Timers left over from an interrupted pass are still expired.
+    for (TimerBase* timer = m_slots[expiredSlot]; timer; timer = timer->m_wheelNext)
+        expired.append(timer);
+    m_slots[expiredSlot] = 0;
+
+    throughTick = max(throughTick, m_currentTick);
+    while (true) {
+        unsigned slot = static_cast<unsigned>(m_currentTick & slotMask);
+        for (TimerBase* timer = m_slots[slot]; timer; timer = timer->m_wheelNext)
+            expired.append(timer);
+        m_slots[slot] = 0;
+        m_occupiedSlots[0] &= ~(1ULL << slot);
+
+        unsigned long long next = nextEventTick();
+        if (next > throughTick)
+            break;
+        m_currentTick = next;
+        cascade(next);
+    }
+    m_currentTick = throughTick;
+
+    std::sort(expired.begin(), expired.end(), firesBefore);
+    for (size_t i = expired.size(); i; --i)
+        linkTimer(expired[i - 1], expiredSlot);
+    m_firstTimerIsValid = false;
+}
+
+void ThreadTimers::rescheduleExpiredTimers()
+{
+    TimerBase* timer = m_slots[expiredSlot];
+    m_slots[expiredSlot] = 0;
+    while (timer) {
+        TimerBase* next = timer->m_wheelNext;
+        linkTimer(timer, slotForTick(max(tickForTime(timer->m_nextFireTime), m_currentTick)));
+        timer = next;
+    }
 }
 
 void ThreadTimers::sharedTimerFired()
@@ -96,17 +398,33 @@ void ThreadTimers::sharedTimerFiredInternal()
     if (m_firingTimers)
         return;
     m_firingTimers = true;
+    ++m_statistics.wakeups;
 
     double fireTime = currentTime();
     double timeToQuit = fireTime + maxDurationOfFiringTimers;
 
-    while (!m_timerHeap.isEmpty() && m_timerHeap.first()->m_nextFireTime <= fireTime) {
-        TimerBase* timer = m_timerHeap.first();
+    collectExpiredTimers(tickForTime(fireTime));
+
+    while (TimerBase* timer = m_slots[expiredSlot]) {
+        if (timer->m_nextFireTime > fireTime)
+            break;
+
+        double lateness = fireTime - timer->m_nextFireTime;
+        m_statistics.totalFireLateness += lateness;
+        m_statistics.maxFireLateness = max(m_statistics.maxFireLateness, lateness);
+        ++m_statistics.firedTimers;
+
+        removeTimer(timer);
         timer->m_nextFireTime = 0;
-        timer->heapDeleteMin();
 
         double interval = timer->repeatInterval();
-        timer->setNextFireTime(interval ? fireTime + interval : 0);
+        double nextFireTime = 0;
+        if (interval) {
+            nextFireTime = fireTime + interval;
+            if (timer->m_allowsFireTimeCoalescing)
+                nextFireTime = coalescedFireTime(nextFireTime, interval);
+        }
+        timer->setNextFireTime(nextFireTime);
 
         // Once the timer has been fired, it may be deleted, so do nothing else with it after this point.
         timer->fired();
@@ -116,6 +434,7 @@ void ThreadTimers::sharedTimerFiredInternal()
             break;
     }
 
+    rescheduleExpiredTimers();
     m_firingTimers = false;
 
     updateSharedTimer();
@@ -129,4 +448,3 @@ void ThreadTimers::fireTimersInNestedEventLoop()
 }
 
 } // namespace WebCore
-
@@ -27,9 +27,8 @@
 #ifndef ThreadTimers_h
 #define ThreadTimers_h
 
+#include <wtf/FastAllocBase.h>
 #include <wtf/Noncopyable.h>
-#include <wtf/HashSet.h>
-#include <wtf/Vector.h>
 
 namespace WebCore {
 
@@ -37,6 +36,11 @@ namespace WebCore {
     class TimerBase;
 
     // A collection of timers per thread. Kept in ThreadGlobalData.
+    //
+    // Timers are kept in a hierarchical timing wheel: wheelLevels levels of slotsPerLevel slots
+    // each, where a level 0 slot covers a single tick and a slot on each further level covers a
+    // whole lower level. Scheduling and cancelling a timer are constant time; a timer far in the
+    // future is moved down a level each time the wheel reaches its slot.
     class ThreadTimers {
         WTF_MAKE_NONCOPYABLE(ThreadTimers); WTF_MAKE_FAST_ALLOCATED;
     public:
@@ -45,20 +49,69 @@ namespace WebCore {
         // On a thread different then main, we should set the thread's instance of the SharedTimer.
         void setSharedTimer(SharedTimer*);
 
-        Vector<TimerBase*>& timerHeap() { return m_timerHeap; }
-
         void updateSharedTimer();
         void fireTimersInNestedEventLoop();
 
+        // Timers that allow it and are started this far ahead have their fire time rounded up to a
+        // coarser grid, so that timers with nearby fire times share a single wakeup.
+        static double coalescedFireTime(double fireTime, double delay);
+
+        struct Statistics {
+            Statistics();
+
+            unsigned activeTimers;
+            unsigned peakActiveTimers;
+            unsigned long long firedTimers;
+            unsigned long long wakeups;
+            unsigned long long cascadedTimers;
+            double totalFireLateness;
+            double maxFireLateness;
+        };
+
+        const Statistics& statistics() const { return m_statistics; }
+        void resetStatistics();
+
     private:
+        friend class TimerBase;
+
         static void sharedTimerFired();
+        static bool firesBefore(const TimerBase*, const TimerBase*);
 
         void sharedTimerFiredInternal();
-        void fireTimersInNestedEventLoopInternal();
 
-        Vector<TimerBase*> m_timerHeap;
+        // Called by TimerBase::setNextFireTime(). Both return true if the first timer may have changed.
+        bool insertTimer(TimerBase*);
+        bool removeTimer(TimerBase*);
+
+        TimerBase* firstTimer();
+        TimerBase* computeFirstTimer() const;
+
+        unsigned slotForTick(unsigned long long tick) const;
+        void linkTimer(TimerBase*, unsigned slot);
+        void unlinkTimer(TimerBase*);
+        void cascade(unsigned long long tick);
+        unsigned long long nextEventTick() const;
+        void collectExpiredTimers(unsigned long long throughTick);
+        void rescheduleExpiredTimers();
+
+        static const unsigned bitsPerLevel = 6;
+        static const unsigned slotsPerLevel = 1 << bitsPerLevel;
+        static const unsigned slotMask = slotsPerLevel - 1;
+        static const unsigned wheelLevels = 4;
+        static const unsigned overflowSlot = wheelLevels * slotsPerLevel;
+        static const unsigned expiredSlot = overflowSlot + 1;
+
+        TimerBase* m_slots[expiredSlot + 1];
+        unsigned long long m_occupiedSlots[wheelLevels];
+        unsigned long long m_currentTick;
+        unsigned m_timerCount;
+        TimerBase* m_firstTimer;
+        bool m_firstTimerIsValid;
+
         SharedTimer* m_sharedTimer; // External object, can be a run loop on a worker thread. Normally set/reset by worker thread.
         bool m_firingTimers; // Reentrancy guard.
+
+        Statistics m_statistics;
     };
 
 }
@@ -33,8 +33,6 @@ namespace WebCore {
 
 // Time intervals are all in seconds.
 
-class TimerHeapElement;
-
 class TimerBase {
     WTF_MAKE_NONCOPYABLE(TimerBase); WTF_MAKE_FAST_ALLOCATED;
 public:
@@ -57,36 +55,34 @@ public:
 
     static void fireTimersInNestedEventLoop();
 
+protected:
+    // Lets the fire time be rounded up so that the timer shares a wakeup with timers due
+    // shortly after it. Only timers that promise no exact deadline, such as script timeouts,
+    // should enable this. Takes effect the next time the timer is started.
+    void setAllowsFireTimeCoalescing(bool allows) { m_allowsFireTimeCoalescing = allows; }
+
 private:
     virtual void fired() = 0;
 
     void checkConsistency() const;
-    void checkHeapIndex() const;
 
     void setNextFireTime(double);
 
-    bool inHeap() const { return m_heapIndex != -1; }
-
-    void heapDecreaseKey();
-    void heapDelete();
-    void heapDeleteMin();
-    void heapIncreaseKey();
-    void heapInsert();
-    void heapPop();
-    void heapPopMin();
+    bool inWheel() const { return m_wheelSlot != -1; }
 
     double m_nextFireTime; // 0 if inactive
     double m_repeatInterval; // 0 if not repeating
-    int m_heapIndex; // -1 if not in heap
-    unsigned m_heapInsertionOrder; // Used to keep order among equal-fire-time timers
+    TimerBase* m_wheelPrevious;
+    TimerBase* m_wheelNext;
+    int m_wheelSlot; // -1 if not in the timing wheel
+    unsigned m_insertionOrder; // Used to keep order among equal-fire-time timers
+    bool m_allowsFireTimeCoalescing;
 
 #ifndef NDEBUG
     ThreadIdentifier m_thread;
 #endif
 
-    friend class TimerHeapElement;
     friend class ThreadTimers;
-    friend bool operator<(const TimerHeapElement&, const TimerHeapElement&);
 };
 
 template <typename TimerFiredClass> class Timer : public TimerBase {
@@ -107,6 +107,9 @@ public:
     static void setCookies(const Document*, const KURL&, const String& value);
     static String cookies(const Document*, const KURL&);
     static bool cookiesEnabled(const Document*);
+    // Network hints
+    static void prefetchDNS(const Document*, const String& hostname);
+    static void preconnect(const Document*, const KURL&);
     // Plugin
     static NPObject* pluginScriptableObject(Widget*);
     // Popups
@@ -34,6 +34,12 @@ namespace WebCore {
 
 SharedBuffer::SharedBuffer(CFDataRef cfData)
     : m_size(0)
+    , m_dataSegmentsSize(0)
+    , m_lastCopiedDataSegment(0)
+    , m_fileBackingFailed(false)
+#if HAVE(MMAP)
+    , m_fileBackingMinimumSize(0)
+#endif
     , m_cfData(cfData)
 {
 }
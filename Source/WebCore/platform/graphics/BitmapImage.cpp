@@ -93,9 +93,17 @@ void BitmapImage::destroyDecodedData(bool destroyAll)
 
 void BitmapImage::destroyDecodedDataIfNecessary(bool destroyAll)
 {
+#if PLATFORM(ANDROID)
+    // The frames held here share their pixels with the GIF decoder's frame
+    // cache, so frames the decoder drops to stay within its 4MB budget are
+    // only freed if we let go of them too. Past that budget the decoder
+    // decodes frames again from its checkpoints.
+    static const unsigned cLargeAnimationCutoff = 4194304;
+#else
     // Animated images >5MB are considered large enough that we'll only hang on
     // to one frame at a time.
     static const unsigned cLargeAnimationCutoff = 5242880;
+#endif
     if (m_frames.size() * frameBytes(m_size) > cLargeAnimationCutoff)
         destroyDecodedData(destroyAll);
 }
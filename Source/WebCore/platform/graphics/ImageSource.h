@@ -49,6 +49,7 @@ typedef struct _cairo_surface cairo_surface_t;
 #elif USE(SKIA)
 #if PLATFORM(ANDROID)
 #include "SkString.h"
+class SkBitmap;
 class SkBitmapRef;
 class PrivateAndroidImageSourceRec;
 #else
@@ -89,12 +90,16 @@ typedef QPixmap* NativeImagePtr;
 #ifdef ANDROID_ANIMATED_GIF
 class GIFImageDecoder;
 #endif
+class Image;
+class ImageDecodeRequest;
 struct NativeImageSourcePtr {
     SkString m_url;
     PrivateAndroidImageSourceRec* m_image;
 #ifdef ANDROID_ANIMATED_GIF
     GIFImageDecoder* m_gifDecoder;
 #endif
+    // Holds a reference while m_image is being decoded off the WebKit thread.
+    ImageDecodeRequest* m_decodeRequest;
 };
 typedef const Vector<char>* NativeBytePtr;
 typedef SkBitmapRef* NativeImagePtr;
@@ -210,6 +215,21 @@ public:
 #if PLATFORM(ANDROID)
     void clearURL();
     void setURL(const String& url);
+    // Whether painting should wait for the pixels, which are being decoded off
+    // the WebKit thread. If so, image is repainted when they are ready.
+    bool isDecodePendingForImage(Image*);
+    // While the decode is pending, the bitmap the image was painted with
+    // before it asked for more pixels, or 0 if it had not been painted.
+    const SkBitmap* previousBitmap() const;
+    // Called as the image is painted with the size that the whole image is
+    // drawn at and the zoom scale of the view it is drawn for, so that no
+    // more pixels than the zoomed view shows are decoded.
+    void requestDisplaySize(const IntSize&, float zoomScale);
+    // Whether images painted for a view at recordedZoomScale may show fewer
+    // pixels than they are displayed with once it is zoomed to zoomScale, in
+    // which case the view should repaint them so that they request their
+    // display size again.
+    static bool isZoomedPastDisplaySize(float recordedZoomScale, float zoomScale);
 #endif
 
 private:
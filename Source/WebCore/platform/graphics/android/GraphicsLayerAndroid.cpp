@@ -54,6 +54,7 @@
 #include "StyleCachedImage.h"
 #include "TransformationMatrix.h"
 #include "TranslateTransformOperation.h"
+#include "WebViewCore.h"
 
 #include <wtf/CurrentTime.h>
 #include <wtf/text/CString.h>
@@ -836,6 +837,15 @@ void GraphicsLayerAndroid::paintContents(GraphicsContext* gc, IntRect& dirty)
     paintGraphicsLayerContents(*gc, dirty);
 }
 
+float GraphicsLayerAndroid::displayZoomScale()
+{
+    RenderLayer* layer = renderLayerFromClient(m_client);
+    if (!layer)
+        return 1;
+    android::WebViewCore* webViewCore = android::WebViewCore::getWebViewCore(layer->renderer()->frame()->view());
+    return webViewCore ? webViewCore->scale() : 1;
+}
+
 bool GraphicsLayerAndroid::paintContext(LayerAndroid* layer,
                                         PicturePile& picture)
 {
@@ -50,6 +50,7 @@ public:
     // PicturePainter
 
     virtual void paintContents(GraphicsContext* gc, IntRect& dirty);
+    virtual float displayZoomScale();
 
     /////
 
@@ -182,8 +182,32 @@ void BitmapImage::draw(GraphicsContext* gc, const FloatRect& dstRect,
         return;
     }
 
+    // Let the source know how big the whole image is drawn, so that it decodes
+    // no more pixels than that.
+    if (srcRect.width() > 0 && srcRect.height() > 0) {
+        AffineTransform ctm = gc->getCTM();
+        float scaleX = dstRect.width() / srcRect.width() * ctm.xScale();
+        float scaleY = dstRect.height() / srcRect.height() * ctm.yScale();
+        IntSize imageSize = size();
+        m_source.requestDisplaySize(IntSize(ceilf(imageSize.width() * scaleX),
+                                            ceilf(imageSize.height() * scaleY)),
+                                    gc->platformContext()->displayZoomScale());
+    }
+
+    // Don't make the texture generators decode the image; we are repainted
+    // once it is decoded. Until then record the pixels the image had before
+    // it asked for more, or leave a hole. Other contexts, such as a canvas,
+    // need the pixels now.
+    const SkBitmap* bitmapToDraw = &image->bitmap();
+    if (gc->platformContext()->type() == PlatformGraphicsContext::RecordingContext
+            && m_source.isDecodePendingForImage(this)) {
+        bitmapToDraw = m_source.previousBitmap();
+        if (!bitmapToDraw)
+            return;
+    }
+
     // in case we get called with an incomplete bitmap
-    const SkBitmap& bitmap = image->bitmap();
+    const SkBitmap& bitmap = *bitmapToDraw;
     if (bitmap.getPixels() == NULL && bitmap.pixelRef() == NULL) {
 #ifdef TRACE_SKIPPED_BITMAPS
         SkDebugf("----- skip bitmapimage: [%d %d] pixels %p pixelref %p\n",
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "ImageDecodeService.h"
+
+#include "Image.h"
+#include "ImageObserver.h"
+#include "JavaSharedClient.h"
+
+// Skia's image refs decode under a global lock, so more workers than this
+// would only queue up behind each other.
+#define NUM_DECODE_WORKERS 2
+
+namespace WebCore {
+
+class ImageDecodeService::Worker : public android::Thread {
+public:
+    Worker(ImageDecodeService* service)
+        : Thread(false)
+        , m_service(service)
+    {
+    }
+
+private:
+    virtual bool threadLoop()
+    {
+        m_service->decodeNextRequest();
+        return true;
+    }
+
+    ImageDecodeService* m_service;
+};
+
+ImageDecodeService* ImageDecodeService::instance()
+{
+    static ImageDecodeService* service = new ImageDecodeService;
+    return service;
+}
+
+ImageDecodeService::ImageDecodeService()
+{
+    for (int i = 0; i < NUM_DECODE_WORKERS; i++) {
+        android::sp<Worker> worker = new Worker(this);
+        worker->run("ImageDecodeWorker", android::PRIORITY_BACKGROUND);
+        m_workers.append(worker);
+    }
+}
+
+PassRefPtr<ImageDecodeRequest> ImageDecodeService::schedule(const SkBitmap& bitmap, bool isVisible)
+{
+    RefPtr<ImageDecodeRequest> request = adoptRef(new ImageDecodeRequest(bitmap, isVisible));
+    android::Mutex::Autolock lock(m_queueLock);
+    m_queue.append(request);
+    m_queueCondition.signal();
+    return request.release();
+}
+
+PassRefPtr<ImageDecodeRequest> ImageDecodeService::waitForRequest()
+{
+    android::Mutex::Autolock lock(m_queueLock);
+    while (m_queue.isEmpty())
+        m_queueCondition.wait(m_queueLock);
+
+    size_t next = 0;
+    for (size_t i = 0; i < m_queue.size(); i++) {
+        if (m_queue[i]->m_isVisible) {
+            next = i;
+            break;
+        }
+    }
+    RefPtr<ImageDecodeRequest> request = m_queue[next].release();
+    m_queue.remove(next);
+    request->m_state = ImageDecodeRequest::Decoding;
+    return request.release();
+}
+
+void ImageDecodeService::decodeNextRequest()
+{
+    RefPtr<ImageDecodeRequest> request = waitForRequest();
+
+    // Locking the pixels decodes them into the pixel ref's ashmem or the
+    // global pool. They are unlocked when the request is destroyed, which is
+    // once the image has been painted, so they cannot be purged before the
+    // texture generators get to them.
+    request->m_bitmap.lockPixels();
+
+    {
+        android::Mutex::Autolock lock(m_queueLock);
+        request->m_pixelsLocked = true;
+        request->m_state = ImageDecodeRequest::Done;
+    }
+    // The image can only be repainted from the WebKit thread. The queue takes
+    // over our reference.
+    JavaSharedClient::EnqueueFunctionPtr(notifyImage, request.release().leakRef());
+}
+
+void ImageDecodeService::notifyImage(void* payload)
+{
+    RefPtr<ImageDecodeRequest> request = adoptRef(static_cast<ImageDecodeRequest*>(payload));
+    Image* image = request->m_image;
+    request->m_image = 0;
+    if (image && image->imageObserver())
+        image->imageObserver()->changedInRect(image, image->rect());
+}
+
+ImageDecodeRequest::~ImageDecodeRequest()
+{
+    if (m_pixelsLocked)
+        m_bitmap.unlockPixels();
+}
+
+bool ImageDecodeRequest::isPendingForImage(Image* image)
+{
+    android::Mutex::Autolock lock(ImageDecodeService::instance()->m_queueLock);
+    if (m_state == Done)
+        return false;
+    m_isVisible = true;
+    m_image = image;
+    return true;
+}
+
+void ImageDecodeRequest::raisePriority()
+{
+    android::Mutex::Autolock lock(ImageDecodeService::instance()->m_queueLock);
+    m_isVisible = true;
+}
+
+void ImageDecodeRequest::cancel()
+{
+    m_image = 0;
+    ImageDecodeService* service = ImageDecodeService::instance();
+    android::Mutex::Autolock lock(service->m_queueLock);
+    if (m_state != Queued)
+        return;
+    size_t index = service->m_queue.find(this);
+    if (index != notFound)
+        service->m_queue.remove(index);
+    m_state = Done;
+}
+
+} // namespace WebCore
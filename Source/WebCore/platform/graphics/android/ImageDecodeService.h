@@ -0,0 +1,110 @@
+/*
+ * Copyright 2011, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ImageDecodeService_h
+#define ImageDecodeService_h
+
+#include "SkBitmap.h"
+#include <utils/threads.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/ThreadSafeRefCounted.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+class Image;
+
+class ImageDecodeService;
+
+// A bitmap waiting to be, or being, decoded by the ImageDecodeService.
+class ImageDecodeRequest : public ThreadSafeRefCounted<ImageDecodeRequest> {
+public:
+    // These are called on the WebKit thread.
+
+    // Whether the pixels are still being decoded. If they are, the request is
+    // moved ahead of images not yet painted, and image's observer is told once
+    // they are ready.
+    bool isPendingForImage(Image*);
+    // Moves the request ahead of images not yet painted.
+    void raisePriority();
+    void cancel();
+
+    ~ImageDecodeRequest();
+
+private:
+    friend class ImageDecodeService;
+    enum State { Queued, Decoding, Done };
+
+    ImageDecodeRequest(const SkBitmap& bitmap, bool isVisible)
+        : m_bitmap(bitmap)
+        , m_state(Queued)
+        , m_isVisible(isVisible)
+        , m_pixelsLocked(false)
+        , m_image(0)
+    {
+    }
+
+    SkBitmap m_bitmap;
+    // Guarded by the service's lock.
+    State m_state;
+    bool m_isVisible;
+    // Set by the worker that decoded the pixels. They stay locked, and so
+    // cannot be purged, until the request goes away after the first paint.
+    bool m_pixelsLocked;
+    // Only used on the WebKit thread.
+    Image* m_image;
+};
+
+// Decodes the pixels of lazily decoded bitmaps on a pool of worker threads once
+// their data is complete, so that neither painting nor the texture generators
+// block on a large image. Requests for images that have been painted are
+// served before the others.
+class ImageDecodeService {
+public:
+    static ImageDecodeService* instance();
+
+    // Called on the WebKit thread once all of the bitmap's data has arrived.
+    // isVisible is whether the image has been painted.
+    PassRefPtr<ImageDecodeRequest> schedule(const SkBitmap&, bool isVisible);
+
+private:
+    friend class ImageDecodeRequest;
+    class Worker;
+
+    ImageDecodeService();
+
+    void decodeNextRequest();
+    PassRefPtr<ImageDecodeRequest> waitForRequest();
+    static void notifyImage(void* request);
+
+    WTF::Vector<RefPtr<ImageDecodeRequest> > m_queue;
+    android::Mutex m_queueLock;
+    android::Condition m_queueCondition;
+    WTF::Vector<android::sp<Worker> > m_workers;
+};
+
+} // namespace WebCore
+
+#endif // ImageDecodeService_h
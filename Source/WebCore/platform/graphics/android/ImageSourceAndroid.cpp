@@ -29,6 +29,7 @@
 
 #include "AndroidLog.h"
 #include "BitmapAllocatorAndroid.h"
+#include "ImageDecodeService.h"
 #include "ImageSource.h"
 #include "IntSize.h"
 #include "NotImplemented.h"
@@ -40,6 +41,8 @@
 #include "SkImageRef.h"
 #include "SkStream.h"
 #include "SkTemplates.h"
+#include <algorithm>
+#include <wtf/MathExtras.h>
 
 #ifdef ANDROID_ANIMATED_GIF
     #include "EmojiFont.h"
@@ -94,18 +97,40 @@
 size_t computeMaxBitmapSizeForCache() {
     return MAX_SIZE_BEFORE_SUBSAMPLE;
 }
+
+// Smaller images decode quickly enough on whichever thread first needs them.
+#define MIN_SIZE_FOR_DECODE_SERVICE   (64*1024)
+
+// Images are decoded for this much more than the zoom scale of the view, so
+// that zooming in on the recorded picture does not show them blurred.
+#define DISPLAY_SIZE_ZOOM_ALLOWANCE   2
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class PrivateAndroidImageSourceRec : public SkBitmapRef {
 public:
     PrivateAndroidImageSourceRec(const SkBitmap& bm, int origWidth,
                                  int origHeight, int sampleSize)
-            : SkBitmapRef(bm), fSampleSize(sampleSize), fAllDataReceived(false) {
+            : SkBitmapRef(bm), fSampleSize(sampleSize),
+              fMemorySampleSize(sampleSize), fDisplayWidth(0),
+              fDisplayHeight(0), fAllDataReceived(false), fDrawn(false) {
         this->setOrigSize(origWidth, origHeight);
     }
 
     int  fSampleSize;
+    // the sample size needed to keep the decoded bitmap under the cache limit
+    int  fMemorySampleSize;
+    // the largest size, in device pixels, that the image has been drawn at
+    int  fDisplayWidth;
+    int  fDisplayHeight;
     bool fAllDataReceived;
+    // set once the image has been drawn with all of its data
+    bool fDrawn;
+    // kept so the pixel ref can be rebuilt at a different sample size
+    WTF::RefPtr<WebCore::SharedBuffer> fData;
+    // the bitmap drawn before a re-decode at a smaller sample size, drawn
+    // instead of the new one until its pixels are ready
+    SkBitmap fPreviousBitmap;
 };
 
 namespace WebCore {
@@ -118,9 +143,33 @@ ImageSource::ImageSource(AlphaOption alphaOption, GammaAndColorProfileOption gam
 #ifdef ANDROID_ANIMATED_GIF
     m_decoder.m_gifDecoder = 0;
 #endif
+    m_decoder.m_decodeRequest = 0;
+}
+
+static void cancelDecode(NativeImageSourcePtr& source)
+{
+    if (source.m_decodeRequest) {
+        source.m_decodeRequest->cancel();
+        source.m_decodeRequest->deref();
+        source.m_decodeRequest = 0;
+    }
+}
+
+// Decode big images now, off the WebKit thread, rather than when a texture
+// generator first needs the pixels. Images that have not been drawn yet wait
+// behind those that have.
+static void scheduleDecode(NativeImageSourcePtr& source, bool isVisible)
+{
+    cancelDecode(source);
+    const SkBitmap& bitmap = source.m_image->bitmap();
+    if (bitmap.getSize() >= MIN_SIZE_FOR_DECODE_SERVICE)
+        source.m_decodeRequest = ImageDecodeService::instance()->schedule(bitmap, isVisible).leakRef();
+    else
+        source.m_image->fPreviousBitmap.reset();
 }
 
 ImageSource::~ImageSource() {
+    cancelDecode(m_decoder);
     delete m_decoder.m_image;
 #ifdef ANDROID_ANIMATED_GIF
     delete m_decoder.m_gifDecoder;
@@ -155,6 +204,60 @@ static int computeSampleSize(const SkBitmap& bitmap) {
     return sampleSize;
 }
 
+/*  Returns the largest power-of-2 sample size that still leaves at least as
+    many pixels as the image is displayed with, but never less than the sample
+    size the memory limit asks for. Powers of 2 let the JPEG decoder scale in
+    its DCT rather than decode everything and throw most of it away.
+*/
+static int computeDisplaySampleSize(const PrivateAndroidImageSourceRec* decoder) {
+    int sampleSize = 1;
+    if (decoder->fDisplayWidth > 0 && decoder->fDisplayHeight > 0) {
+        while (decoder->origWidth() / (sampleSize << 1) >= decoder->fDisplayWidth &&
+               decoder->origHeight() / (sampleSize << 1) >= decoder->fDisplayHeight) {
+            sampleSize <<= 1;
+        }
+    }
+    return std::max(sampleSize, decoder->fMemorySampleSize);
+}
+
+// Points the bitmap at a new pixel ref that decodes the data at sampleSize
+// when its pixels are first needed.
+static bool setPixelRef(PrivateAndroidImageSourceRec* decoder, int sampleSize,
+                        const SkString& url) {
+    WebCore::SharedBuffer* data = decoder->fData.get();
+    SkBitmap bm(decoder->bitmap());
+
+    if (sampleSize != decoder->fSampleSize) {
+        // the sampled dimensions depend on the codec, so ask it for them
+        SkMemoryStream stream(data->data(), data->size(), false);
+        SkImageDecoder* codec = SkImageDecoder::Factory(&stream);
+        if (!codec)
+            return false;
+
+        SkAutoTDelete<SkImageDecoder> ad(codec);
+        codec->setPrefConfigTable(gPrefConfigTable);
+        codec->setSampleSize(sampleSize);
+        bm.reset();
+        if (!codec->decode(&stream, &bm, SkImageDecoder::kDecodeBounds_Mode))
+            return false;
+    }
+
+    BitmapAllocatorAndroid alloc(data, sampleSize);
+    if (!alloc.allocPixelRef(&bm, NULL)) {
+        return false;
+    }
+    SkPixelRef* ref = bm.pixelRef();
+
+    // we promise to never change the pixels (makes picture recording fast)
+    ref->setImmutable();
+    // give it the URL if we have one
+    ref->setURI(url);
+
+    decoder->bitmap() = bm;
+    decoder->fSampleSize = sampleSize;
+    return true;
+}
+
 void ImageSource::clearURL() 
 {
     m_decoder.m_url.reset(); 
@@ -200,23 +303,40 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
                                             ) {
         SkBitmap tmp;
 
-        SkMemoryStream stream(data->data(), data->size(), false);
+        // The header usually fits in the first contiguous part of the buffer,
+        // so only flatten the whole buffer if the bounds are not in there.
+        const char* contents;
+        unsigned contentsLength = data->getSomeData(contents);
+        SkMemoryStream stream(contents, contentsLength, false);
         SkImageDecoder* codec = SkImageDecoder::Factory(&stream);
+        if (!codec && contentsLength < data->size()) {
+            // The first part may be too short to recognize the format.
+            contents = data->data();
+            contentsLength = data->size();
+            stream.setMemory(contents, contentsLength, false);
+            codec = SkImageDecoder::Factory(&stream);
+        }
         if (!codec)
             return;
 
         SkAutoTDelete<SkImageDecoder> ad(codec);
         codec->setPrefConfigTable(gPrefConfigTable);
-        if (!codec->decode(&stream, &tmp, SkImageDecoder::kDecodeBounds_Mode))
-            return;
+        if (!codec->decode(&stream, &tmp, SkImageDecoder::kDecodeBounds_Mode)) {
+            if (contentsLength == data->size())
+                return;
+            contents = data->data();
+            contentsLength = data->size();
+            stream.setMemory(contents, contentsLength, false);
+            if (!codec->decode(&stream, &tmp, SkImageDecoder::kDecodeBounds_Mode))
+                return;
+        }
 
         int origW = tmp.width();
         int origH = tmp.height();
 
 #ifdef ANDROID_ANIMATED_GIF
         // First, check to see if this is an animated GIF
-        const char* contents = data->data();
-        if (data->size() > 3 && strncmp(contents, "GIF8", 4) == 0
+        if (contentsLength > 3 && strncmp(contents, "GIF8", 4) == 0
                 && should_use_animated_gif(origW, origH)
                 && !disabledAnimatedGif) {
             // This means we are looking at a GIF, so create special
@@ -258,22 +378,82 @@ void ImageSource::setData(SharedBuffer* data, bool allDataReceived)
     PrivateAndroidImageSourceRec* decoder = m_decoder.m_image;
     if (allDataReceived && decoder && !decoder->fAllDataReceived) {
         decoder->fAllDataReceived = true;
+        decoder->fData = data;
 
-        SkBitmap* bm = &decoder->bitmap();
-
-        BitmapAllocatorAndroid alloc(data, decoder->fSampleSize);
-        if (!alloc.allocPixelRef(bm, NULL)) {
+        if (!setPixelRef(decoder, computeDisplaySampleSize(decoder), m_decoder.m_url))
             return;
-        }
-        SkPixelRef* ref = bm->pixelRef();
 
-        // we promise to never change the pixels (makes picture recording fast)
-        ref->setImmutable();
-        // give it the URL if we have one
-        ref->setURI(m_decoder.m_url);
+        // An image that has not been drawn yet is decoded at low priority;
+        // requestDisplaySize() raises the priority when it is first drawn.
+        decoder->fDrawn = decoder->fDisplayWidth > 0;
+        scheduleDecode(m_decoder, decoder->fDrawn);
     }
 }
 
+bool ImageSource::isZoomedPastDisplaySize(float recordedZoomScale, float zoomScale)
+{
+    return zoomScale > recordedZoomScale * DISPLAY_SIZE_ZOOM_ALLOWANCE;
+}
+
+void ImageSource::requestDisplaySize(const IntSize& drawnSize, float zoomScale)
+{
+    PrivateAndroidImageSourceRec* decoder = m_decoder.m_image;
+    if (!decoder || drawnSize.isEmpty())
+        return;
+
+    float scale = (zoomScale > 0 ? zoomScale : 1) * DISPLAY_SIZE_ZOOM_ALLOWANCE;
+    IntSize size(ceilf(drawnSize.width() * scale), ceilf(drawnSize.height() * scale));
+    bool grew = size.width() > decoder->fDisplayWidth || size.height() > decoder->fDisplayHeight;
+    decoder->fDisplayWidth = std::max(decoder->fDisplayWidth, size.width());
+    decoder->fDisplayHeight = std::max(decoder->fDisplayHeight, size.height());
+    if (!decoder->fAllDataReceived)
+        return;
+
+    bool firstDraw = !decoder->fDrawn;
+    if (!grew && !firstDraw)
+        return;
+    decoder->fDrawn = true;
+
+    // The first draw tells us how big the image really is, so it may need
+    // fewer pixels than the low priority decode was given; after that, only
+    // re-decode if the image needs more pixels than it has.
+    int sampleSize = computeDisplaySampleSize(decoder);
+    if (sampleSize == decoder->fSampleSize || (!firstDraw && sampleSize > decoder->fSampleSize)) {
+        if (firstDraw && m_decoder.m_decodeRequest)
+            m_decoder.m_decodeRequest->raisePriority();
+        return;
+    }
+    // Once the image is on screen, keep drawing the pixels it has until the
+    // new ones are decoded rather than leave a hole.
+    SkBitmap previous(decoder->bitmap());
+    if (!setPixelRef(decoder, sampleSize, m_decoder.m_url))
+        return;
+    if (!firstDraw)
+        decoder->fPreviousBitmap = previous;
+    scheduleDecode(m_decoder, true);
+}
+
+const SkBitmap* ImageSource::previousBitmap() const
+{
+    if (!m_decoder.m_image || m_decoder.m_image->fPreviousBitmap.isNull())
+        return 0;
+    return &m_decoder.m_image->fPreviousBitmap;
+}
+
+bool ImageSource::isDecodePendingForImage(Image* image)
+{
+    if (!m_decoder.m_decodeRequest)
+        return false;
+    if (m_decoder.m_decodeRequest->isPendingForImage(image))
+        return true;
+    // The repaint notification may still be queued; make sure it does not
+    // reach an image that is gone by the time it runs.
+    cancelDecode(m_decoder);
+    if (m_decoder.m_image)
+        m_decoder.m_image->fPreviousBitmap.reset();
+    return false;
+}
+
 bool ImageSource::isSizeAvailable()
 {
     return
@@ -414,7 +594,14 @@ void ImageSource::clear(bool destroyAll, size_t clearBeforeFrame, SharedBuffer*
             m_decoder.m_gifDecoder->clearFrameBufferCache(clearBeforeFrame);
         return;
     }
-    
+
+    // The decoder can go back to any frame it has decoded from that frame's
+    // checkpoint, so keep it rather than parse the whole image again.
+    if (m_decoder.m_gifDecoder && !m_decoder.m_gifDecoder->failed()) {
+        m_decoder.m_gifDecoder->clearFrameBufferCache(m_decoder.m_gifDecoder->frameCount());
+        return;
+    }
+
     delete m_decoder.m_gifDecoder;
     m_decoder.m_gifDecoder = 0;
     if (data)
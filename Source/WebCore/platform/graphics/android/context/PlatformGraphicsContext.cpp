@@ -197,6 +197,7 @@ PlatformGraphicsContext::State PlatformGraphicsContext::State::cloneInheritedPro
 //**************************************
 
 PlatformGraphicsContext::PlatformGraphicsContext()
+    : m_displayZoomScale(1)
 {
     m_stateStack.append(State());
     m_state = &m_stateStack.last();
@@ -53,6 +53,11 @@ public:
     typedef enum { PaintingContext, RecordingContext } ContextType;
     virtual ContextType type() = 0;
 
+    // The zoom scale of the view the content is painted for, which images
+    // use to decide how many pixels to decode.
+    float displayZoomScale() const { return m_displayZoomScale; }
+    void setDisplayZoomScale(float scale) { m_displayZoomScale = scale; }
+
     // State management
     virtual void beginTransparencyLayer(float opacity) = 0;
     virtual void endTransparencyLayer() = 0;
@@ -205,6 +210,7 @@ protected:
     virtual bool shadowsIgnoreTransforms() const = 0;
     void setupPaintCommon(SkPaint* paint) const;
     GraphicsContext* m_gc; // Back-ptr to our parent
+    float m_displayZoomScale;
 
     WTF::Vector<State> m_stateStack;
     State* m_state;
@@ -26,9 +26,16 @@
 #include "config.h"
 #include "GIFImageDecoder.h"
 #include "GIFImageReader.h"
+#include <wtf/NotFound.h>
 
 namespace WebCore {
 
+// Decoded frames beyond this many bytes are dropped as the animation plays,
+// and decoded again from their checkpoints when they are next needed. On
+// Android, BitmapImage lets go of the frames of animations this large, as its
+// frames share their pixels with ours.
+static const size_t cMaxCachedFrameBytes = 4 * 1024 * 1024;
+
 GIFImageDecoder::GIFImageDecoder(ImageSource::AlphaOption alphaOption,
                                  ImageSource::GammaAndColorProfileOption gammaAndColorProfileOption)
     : ImageDecoder(alphaOption, gammaAndColorProfileOption)
@@ -124,8 +131,14 @@ ImageFrame* GIFImageDecoder::frameBufferAtIndex(size_t index)
         return 0;
 
     ImageFrame& frame = m_frameBufferCache[index];
-    if (frame.status() != ImageFrame::FrameComplete)
+    if ((frame.status() != ImageFrame::FrameComplete) && !failed()) {
+        // The frame may have been decoded and dropped before, in which case
+        // we go back to its checkpoint rather than to the start of the data.
+        size_t firstFrame = firstFrameToDecode(index);
+        if (!m_reader || firstFrame < m_reader->images_decoded)
+            rewindToFrame(firstFrame);
         decode(index + 1, GIFFullQuery);
+    }
     return &frame;
 }
 
@@ -262,6 +275,7 @@ bool GIFImageDecoder::frameComplete(unsigned frameIndex, unsigned frameDuration,
     buffer.setStatus(ImageFrame::FrameComplete);
     buffer.setDuration(frameDuration);
     buffer.setDisposalMethod(disposalMethod);
+    const size_t completedFrame = frameIndex;
 
     if (!m_currentBufferSawAlpha) {
         // The whole frame was non-transparent, so it's possible that the entire
@@ -294,9 +308,24 @@ bool GIFImageDecoder::frameComplete(unsigned frameIndex, unsigned frameDuration,
         }
     }
 
+    pruneFrameCache(completedFrame);
     return true;
 }
 
+void GIFImageDecoder::frameCheckpoint(unsigned frameIndex, unsigned bytesLeft)
+{
+    // After a rewind we pass checkpoints we already have.
+    if (frameIndex != m_frameCheckpoints.size() + 1)
+        return;
+
+    const GIFFrameReader* frameReader = m_reader->frame_reader;
+    FrameCheckpoint checkpoint;
+    checkpoint.offset = m_data->size() - bytesLeft;
+    checkpoint.delayTime = frameReader->delay_time;
+    checkpoint.disposalMethod = frameReader->disposal_method;
+    m_frameCheckpoints.append(checkpoint);
+}
+
 void GIFImageDecoder::gifComplete()
 {
     // Cache the repetition count, which is now as authoritative as it's ever
@@ -396,4 +425,84 @@ bool GIFImageDecoder::initFrameBuffer(unsigned frameIndex)
     return true;
 }
 
+size_t GIFImageDecoder::requiredPreviousFrameIndex(size_t frameIndex) const
+{
+    // This follows the choice of starting state made in initFrameBuffer().
+    if (!frameIndex)
+        return notFound;
+    const ImageFrame* prevBuffer = &m_frameBufferCache[--frameIndex];
+    while (frameIndex && (prevBuffer->disposalMethod() == ImageFrame::DisposeOverwritePrevious))
+        prevBuffer = &m_frameBufferCache[--frameIndex];
+
+    if ((prevBuffer->disposalMethod() == ImageFrame::DisposeOverwriteBgcolor)
+        && (!frameIndex || prevBuffer->originalFrameRect().contains(IntRect(IntPoint(), scaledSize()))))
+        return notFound;
+    return frameIndex;
+}
+
+bool GIFImageDecoder::isKeyFrame(size_t frameIndex) const
+{
+    return (frameIndex + 1 < m_frameBufferCache.size())
+        && (m_frameBufferCache[frameIndex].disposalMethod() != ImageFrame::DisposeOverwritePrevious)
+        && (m_frameBufferCache[frameIndex + 1].disposalMethod() == ImageFrame::DisposeOverwritePrevious);
+}
+
+size_t GIFImageDecoder::firstFrameToDecode(size_t frameIndex) const
+{
+    // Frames past the reader have not been parsed yet, so their disposal
+    // methods are unknown; they can only be decoded in order from the reader.
+    size_t frame = std::min(frameIndex, m_reader ? static_cast<size_t>(m_reader->images_decoded) : m_frameCheckpoints.size());
+
+    while (m_frameBufferCache[frame].status() == ImageFrame::FrameEmpty) {
+        size_t previous = requiredPreviousFrameIndex(frame);
+        if ((previous == notFound) || (m_frameBufferCache[previous].status() == ImageFrame::FrameComplete))
+            break;
+        frame = previous;
+    }
+    return frame;
+}
+
+void GIFImageDecoder::rewindToFrame(size_t frameIndex)
+{
+    ASSERT(frameIndex <= m_frameCheckpoints.size());
+    m_reader.set(new GIFImageReader(this));
+    m_readOffset = 0;
+    if (!frameIndex)
+        return;
+
+    // Read the header again for the screen size and global colormap, which
+    // halts at the first frame, then carry on from the checkpoint instead.
+    m_reader->read((const unsigned char*)m_data->data(), m_data->size(), GIFFullQuery, 0);
+    if (!m_reader)
+        return; // setFailed() was called.
+    const FrameCheckpoint& checkpoint = m_frameCheckpoints[frameIndex - 1];
+    m_reader->seek_to_frame(frameIndex, checkpoint.delayTime, checkpoint.disposalMethod);
+    m_readOffset = checkpoint.offset;
+}
+
+void GIFImageDecoder::pruneFrameCache(size_t currentFrame)
+{
+    const size_t frameBytes = scaledSize().width() * scaledSize().height() * sizeof(ImageFrame::PixelData);
+    size_t cachedBytes = 0;
+    for (size_t i = 0; i < m_frameBufferCache.size(); ++i) {
+        if (m_frameBufferCache[i].status() != ImageFrame::FrameEmpty)
+            cachedBytes += frameBytes;
+    }
+    if (cachedBytes <= cMaxCachedFrameBytes)
+        return;
+
+    // Frames are shown in order, so the ones just before |currentFrame| will
+    // be needed again last; drop those first.
+    const size_t frameCount = m_frameBufferCache.size();
+    const size_t nextRequiredFrame = requiredPreviousFrameIndex(currentFrame + 1);
+    for (size_t n = 1; (n < frameCount) && (cachedBytes > cMaxCachedFrameBytes); ++n) {
+        const size_t i = (currentFrame + frameCount - n) % frameCount;
+        ImageFrame& frame = m_frameBufferCache[i];
+        if ((frame.status() != ImageFrame::FrameComplete) || (i == nextRequiredFrame) || isKeyFrame(i))
+            continue;
+        frame.clearPixelData();
+        cachedBytes -= frameBytes;
+    }
+}
+
 } // namespace WebCore
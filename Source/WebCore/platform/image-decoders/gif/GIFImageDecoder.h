@@ -59,6 +59,7 @@ namespace WebCore {
         void decodingHalted(unsigned bytesLeft);
         bool haveDecodedRow(unsigned frameIndex, unsigned char* rowBuffer, unsigned char* rowEnd, unsigned rowNumber, unsigned repeatCount, bool writeTransparentPixels);
         bool frameComplete(unsigned frameIndex, unsigned frameDuration, ImageFrame::FrameDisposalMethod disposalMethod);
+        void frameCheckpoint(unsigned frameIndex, unsigned bytesLeft);
         void gifComplete();
 
     private:
@@ -73,11 +74,43 @@ namespace WebCore {
         // failure, this will mark the image as failed.
         bool initFrameBuffer(unsigned frameIndex);
 
+        // Returns the index of the frame whose pixels initFrameBuffer() starts
+        // |frameIndex| from, or notFound if it starts from a cleared image.
+        size_t requiredPreviousFrameIndex(size_t frameIndex) const;
+
+        // Whether a later DisposeOverwritePrevious frame starts from this one.
+        bool isKeyFrame(size_t frameIndex) const;
+
+        // Returns the frame decoding has to start at for |frameIndex| to be
+        // decoded: where the reader stopped, or an earlier frame whose pixels
+        // were dropped but are needed to build |frameIndex|.
+        size_t firstFrameToDecode(size_t frameIndex) const;
+
+        // Sets up a new reader to decode |frameIndex|, which has been decoded
+        // before, from its checkpoint.
+        void rewindToFrame(size_t frameIndex);
+
+        // Drops decoded frames, other than |currentFrame| and those needed to
+        // decode the frames after it, until the cache is within its budget.
+        void pruneFrameCache(size_t currentFrame);
+
+        // Where a frame's data starts, and the reader state that carries over
+        // into it from the frame before. The LZW decoder starts afresh with
+        // every frame, so this is all it takes to decode the frame again
+        // without decoding the frames before it.
+        struct FrameCheckpoint {
+            unsigned offset;
+            unsigned delayTime;
+            ImageFrame::FrameDisposalMethod disposalMethod;
+        };
+
         bool m_alreadyScannedThisDataForFrameCount;
         bool m_currentBufferSawAlpha;
         mutable int m_repetitionCount;
         OwnPtr<GIFImageReader> m_reader;
         unsigned m_readOffset;
+        // m_frameCheckpoints[i] is where frame i + 1 starts.
+        Vector<FrameCheckpoint> m_frameCheckpoints;
     };
 
 } // namespace WebCore
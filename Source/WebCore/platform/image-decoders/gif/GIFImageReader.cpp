@@ -886,6 +886,10 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
             frame_reader->is_transparent = false;
         }
 
+        // CALLBACK: The next frame's data starts here.
+        if (clientptr && frame_reader)
+          clientptr->frameCheckpoint(images_decoded, len);
+
         GETN(1, gif_image_start);
       }
     }
@@ -923,3 +927,21 @@ bool GIFImageReader::read(const unsigned char *buf, unsigned len,
     clientptr->decodingHalted(0);
   return false;
 }
+
+void GIFImageReader::seek_to_frame(unsigned frameIndex, unsigned delayTime,
+                                   WebCore::ImageFrame::FrameDisposalMethod disposalMethod)
+{
+  state = gif_image_start;
+  bytes_to_consume = 1;
+  bytes_in_hold = 0;
+  count = 0;
+  images_decoded = frameIndex;
+  images_count = frameIndex;
+
+  if (!frame_reader)
+    frame_reader = new GIFFrameReader();
+  frame_reader->delay_time = delayTime;
+  frame_reader->disposal_method = disposalMethod;
+  frame_reader->is_local_colormap_defined = false;
+  frame_reader->is_transparent = false;
+}
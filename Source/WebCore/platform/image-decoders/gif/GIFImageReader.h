@@ -201,6 +201,11 @@ struct GIFImageReader {
     bool read(const unsigned char * buf, unsigned int numbytes, 
               WebCore::GIFImageDecoder::GIFQuery query = WebCore::GIFImageDecoder::GIFFullQuery, unsigned haltAtFrame = -1);
 
+    // Continues, after the header has been read, at the start of frame
+    // |frameIndex| as if all the frames before it had just been decoded.
+    void seek_to_frame(unsigned frameIndex, unsigned delayTime,
+                       WebCore::ImageFrame::FrameDisposalMethod disposalMethod);
+
 private:
     bool output_row();
     bool do_lzw(const unsigned char *q);
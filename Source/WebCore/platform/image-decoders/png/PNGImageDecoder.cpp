@@ -47,6 +47,11 @@
 #define JMPBUF(png_ptr) png_ptr->jmpbuf
 #endif
 
+#if CPU(X86_64) || (CPU(X86) && defined(__SSE2__))
+#include <emmintrin.h>
+#define WTF_USE_SSE2_PNG_ROW_CONVERSION 1
+#endif
+
 namespace WebCore {
 
 // Gamma constants.
@@ -57,6 +62,98 @@ const double cInverseGamma = 0.45455;
 // Protect against large PNGs. See Mozilla's bug #251381 for more info.
 const unsigned long cMaxPNGSize = 1000000UL;
 
+// Bit offsets of the channels within an ImageFrame::PixelData.
+#if USE(SKIA)
+const unsigned cRedShift = SK_R32_SHIFT;
+const unsigned cGreenShift = SK_G32_SHIFT;
+const unsigned cBlueShift = SK_B32_SHIFT;
+const unsigned cAlphaShift = SK_A32_SHIFT;
+#else
+const unsigned cRedShift = 16;
+const unsigned cGreenShift = 8;
+const unsigned cBlueShift = 0;
+const unsigned cAlphaShift = 24;
+#endif
+
+static inline ImageFrame::PixelData packPixel(unsigned r, unsigned g, unsigned b, unsigned a)
+{
+    return (r << cRedShift) | (g << cGreenShift) | (b << cBlueShift) | (a << cAlphaShift);
+}
+
+// Returns component * alpha / 255, rounded down, which is what
+// ImageFrame::setRGBA() computes.
+static inline unsigned premultiplyComponent(unsigned component, unsigned alpha)
+{
+    unsigned product = component * alpha;
+    return (product + 1 + (product >> 8)) >> 8;
+}
+
+#if USE(SSE2_PNG_ROW_CONVERSION)
+// Each 32-bit lane holds one component, in its low byte.
+static inline __m128i premultiplyComponents(__m128i components, __m128i alphas)
+{
+    // The products fit in the low 16 bits of each lane.
+    __m128i products = _mm_mullo_epi16(components, alphas);
+    __m128i sums = _mm_add_epi32(_mm_add_epi32(products, _mm_set1_epi32(1)), _mm_srli_epi32(products, 8));
+    return _mm_srli_epi32(sums, 8);
+}
+#endif
+
+// Writes a row of RGBA pixels into |destination|, premultiplying them if asked
+// to. Returns whether any of them is not fully opaque.
+static bool convertRGBARow(ImageFrame::PixelData* destination, const png_byte* source, int width, bool premultiply)
+{
+    unsigned alphaMask = 0xff;
+    int x = 0;
+#if USE(SSE2_PNG_ROW_CONVERSION)
+    const __m128i byteMask = _mm_set1_epi32(0xff);
+    __m128i alphaMaskVector = byteMask;
+    for (; x + 4 <= width; x += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + x * 4));
+        __m128i r = _mm_and_si128(pixels, byteMask);
+        __m128i g = _mm_and_si128(_mm_srli_epi32(pixels, 8), byteMask);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), byteMask);
+        __m128i a = _mm_srli_epi32(pixels, 24);
+        alphaMaskVector = _mm_and_si128(alphaMaskVector, a);
+        if (premultiply) {
+            r = premultiplyComponents(r, a);
+            g = premultiplyComponents(g, a);
+            b = premultiplyComponents(b, a);
+        }
+        __m128i packed = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, cRedShift), _mm_slli_epi32(g, cGreenShift)),
+                                      _mm_or_si128(_mm_slli_epi32(b, cBlueShift), _mm_slli_epi32(a, cAlphaShift)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x), packed);
+    }
+    alphaMaskVector = _mm_and_si128(alphaMaskVector, _mm_srli_si128(alphaMaskVector, 8));
+    alphaMaskVector = _mm_and_si128(alphaMaskVector, _mm_srli_si128(alphaMaskVector, 4));
+    alphaMask &= _mm_cvtsi128_si32(alphaMaskVector);
+#endif
+    for (; x < width; ++x) {
+        const png_byte* pixel = source + x * 4;
+        unsigned r = pixel[0];
+        unsigned g = pixel[1];
+        unsigned b = pixel[2];
+        unsigned a = pixel[3];
+        alphaMask &= a;
+        if (premultiply && a < 255) {
+            r = premultiplyComponent(r, a);
+            g = premultiplyComponent(g, a);
+            b = premultiplyComponent(b, a);
+        }
+        destination[x] = packPixel(r, g, b, a);
+    }
+    return alphaMask != 0xff;
+}
+
+// Writes a row of opaque RGB pixels into |destination|.
+static void convertRGBRow(ImageFrame::PixelData* destination, const png_byte* source, int width)
+{
+    for (int x = 0; x < width; ++x) {
+        const png_byte* pixel = source + x * 3;
+        destination[x] = packPixel(pixel[0], pixel[1], pixel[2], 255);
+    }
+}
+
 // Called if the decoding of the image fails.
 static void PNGAPI decodingFailed(png_structp png, png_const_charp)
 {
@@ -402,11 +499,21 @@ void PNGImageDecoder::rowAvailable(unsigned char* rowBuffer, unsigned rowIndex,
     if (destY < 0 || destY >= scaledSize().height())
         return;
     bool nonTrivialAlpha = false;
-    for (int x = 0; x < width; ++x) {
-        png_bytep pixel = row + (m_scaled ? m_scaledColumns[x] : x) * colorChannels;
-        unsigned alpha = hasAlpha ? pixel[3] : 255;
-        buffer.setRGBA(x, destY, pixel[0], pixel[1], pixel[2], alpha);
-        nonTrivialAlpha |= alpha < 255;
+    if (!m_scaled) {
+        // Whole rows are converted at once, several pixels at a time where
+        // the CPU allows.
+        ImageFrame::PixelData* destination = buffer.getAddr(0, destY);
+        if (hasAlpha)
+            nonTrivialAlpha = convertRGBARow(destination, row, width, buffer.premultiplyAlpha());
+        else
+            convertRGBRow(destination, row, width);
+    } else {
+        for (int x = 0; x < width; ++x) {
+            png_bytep pixel = row + m_scaledColumns[x] * colorChannels;
+            unsigned alpha = hasAlpha ? pixel[3] : 255;
+            buffer.setRGBA(x, destY, pixel[0], pixel[1], pixel[2], alpha);
+            nonTrivialAlpha |= alpha < 255;
+        }
     }
     if (nonTrivialAlpha && !buffer.hasAlpha())
         buffer.setHasAlpha(nonTrivialAlpha);
@@ -45,6 +45,15 @@ WEBPImageDecoder::WEBPImageDecoder(ImageSource::AlphaOption alphaOption,
 
 WEBPImageDecoder::~WEBPImageDecoder()
 {
+    clearDecoder();
+}
+
+void WEBPImageDecoder::clearDecoder()
+{
+    if (m_decoder) {
+        WebPIDelete(m_decoder);
+        m_decoder = 0;
+    }
 }
 
 bool WEBPImageDecoder::isSizeAvailable()
@@ -95,7 +104,6 @@ bool WEBPImageDecoder::decode(bool onlySize)
     if (onlySize)
         return true;
 
-    bool allDataReceived = isAllDataReceived();
     int stride = width * bytesPerPixel;
     ASSERT(!m_frameBufferCache.isEmpty());
     ImageFrame& buffer = m_frameBufferCache[0];
@@ -104,31 +112,31 @@ bool WEBPImageDecoder::decode(bool onlySize)
         ASSERT(height == size().height());
         if (!buffer.setSize(width, height))
             return setFailed();
-        buffer.setStatus(allDataReceived ? ImageFrame::FrameComplete : ImageFrame::FramePartial);
+        // Rows are committed as they are decoded, so the image can be painted
+        // before all the data has arrived.
+        buffer.setStatus(ImageFrame::FramePartial);
         // FIXME: We currently hard code false below because libwebp doesn't support alpha yet.
         buffer.setHasAlpha(false);
         buffer.setOriginalFrameRect(IntRect(IntPoint(), size()));
         m_rgbOutput.resize(height * stride);
     }
-    int newLastVisibleRow = 0; // Last completed row.
-    if (allDataReceived) {
-        if (!WebPDecodeRGBInto(dataBytes, dataSize, m_rgbOutput.data(), m_rgbOutput.size(), stride))
-            return setFailed();
-        newLastVisibleRow = height;
-    } else {
-        if (!m_decoder) {
-            m_decoder = WebPINewRGB(MODE_RGB, m_rgbOutput.data(), m_rgbOutput.size(), stride);
-            if (!m_decoder)
-                return setFailed();
-        }
-        const VP8StatusCode status = WebPIUpdate(m_decoder, dataBytes, dataSize);
-        if (status != VP8_STATUS_OK && status != VP8_STATUS_SUSPENDED)
-            return setFailed();
-        if (!WebPIDecGetRGB(m_decoder, &newLastVisibleRow, 0, 0, 0))
+
+    // The incremental decoder picks up where the last call left off, so each
+    // call only decodes the data that has arrived since.
+    if (!m_decoder) {
+        m_decoder = WebPINewRGB(MODE_RGB, m_rgbOutput.data(), m_rgbOutput.size(), stride);
+        if (!m_decoder)
             return setFailed();
-        ASSERT(newLastVisibleRow >= 0);
-        ASSERT(newLastVisibleRow <= height);
     }
+    const VP8StatusCode status = WebPIUpdate(m_decoder, dataBytes, dataSize);
+    if (status != VP8_STATUS_OK && status != VP8_STATUS_SUSPENDED)
+        return setFailed();
+    int newLastVisibleRow = 0; // Last completed row.
+    if (!WebPIDecGetRGB(m_decoder, &newLastVisibleRow, 0, 0, 0))
+        return setFailed();
+    ASSERT(newLastVisibleRow >= 0);
+    ASSERT(newLastVisibleRow <= height);
+
     // FIXME: remove this data copy.
     for (int y = m_lastVisibleRow; y < newLastVisibleRow; ++y) {
         const uint8_t* const src = &m_rgbOutput[y * stride];
@@ -136,9 +144,18 @@ bool WEBPImageDecoder::decode(bool onlySize)
             buffer.setRGBA(x, y, src[bytesPerPixel * x + 0], src[bytesPerPixel * x + 1], src[bytesPerPixel * x + 2], 0xff);
     }
     m_lastVisibleRow = newLastVisibleRow;
-    if (m_lastVisibleRow == height)
-         buffer.setStatus(ImageFrame::FrameComplete);
-    return m_lastVisibleRow == height;
+    if (m_lastVisibleRow == height) {
+        buffer.setStatus(ImageFrame::FrameComplete);
+        clearDecoder();
+        m_rgbOutput.clear();
+        return true;
+    }
+
+    // If we couldn't decode the whole image but we've received all the data,
+    // decoding has failed.
+    if (isAllDataReceived())
+        return setFailed();
+    return false;
 }
 
 }
@@ -49,8 +49,9 @@ public:
 private:
     // Returns false in case of decoding failure.
     bool decode(bool onlySize);
+    void clearDecoder();
 
-    WebPIDecoder* m_decoder; // This is only used when we want to decode() but not all data is available yet.
+    WebPIDecoder* m_decoder; // Incremental decoder, kept until the image has been decoded completely.
     int m_lastVisibleRow;
     Vector<uint8_t> m_rgbOutput;
 };
@@ -30,9 +30,24 @@
 
 namespace WebCore {
 
+#if PLATFORM(ANDROID)
+    class Document;
+    class KURL;
+#endif
+
 #if !USE(SOUP)
     void prefetchDNS(const String& hostname);
 #endif
+
+#if PLATFORM(ANDROID)
+    // Android keeps private browsing hints apart from the others, so it needs
+    // the document the hint comes from. The overload above drops the hint.
+    void prefetchDNS(const Document*, const String& hostname);
+
+    // Opens a connection to the origin of a URL the document is expected to
+    // load from soon, such as one found by the preload scanner.
+    void preconnect(const Document*, const KURL&);
+#endif
 }
 
 #endif
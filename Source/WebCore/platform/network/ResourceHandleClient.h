@@ -26,6 +26,7 @@
 #ifndef ResourceHandleClient_h
 #define ResourceHandleClient_h
 
+#include "SharedBuffer.h"
 #include <wtf/CurrentTime.h>
 #include <wtf/RefCounted.h>
 #include <wtf/RefPtr.h>
@@ -72,6 +73,8 @@ namespace WebCore {
 
         virtual void didReceiveResponse(ResourceHandle*, const ResourceResponse&) { }
         virtual void didReceiveData(ResourceHandle*, const char*, int, int /*encodedDataLength*/) { }
+        // Clients that keep the data can override this to hold on to the segment instead of copying it.
+        virtual void didReceiveDataSegment(ResourceHandle* handle, PassRefPtr<SharedBuffer::DataSegment> segment, int encodedDataLength) { didReceiveData(handle, segment->data(), segment->size(), encodedDataLength); }
         virtual void didReceiveCachedMetadata(ResourceHandle*, const char*, int) { }
         virtual void didFinishLoading(ResourceHandle*, double /*finishTime*/) { }
         virtual void didFail(ResourceHandle*, const ResourceError&) { }
@@ -181,18 +181,31 @@ void SegmentedString::advanceSubstring()
 
 String SegmentedString::toString() const
 {
-    String result;
+    // Share the buffer when a single untouched substring holds everything.
+    if (!m_pushedChar1 && !isComposite() && m_currentString.m_current == m_currentString.string().characters())
+        return m_currentString.string();
+
+    unsigned totalLength = length();
+    if (!totalLength)
+        return String();
+
+    // Otherwise flatten once into a buffer of the final size.
+    UChar* destination;
+    String result = String::createUninitialized(totalLength, destination);
     if (m_pushedChar1) {
-        result.append(m_pushedChar1);
+        *destination++ = m_pushedChar1;
         if (m_pushedChar2)
-            result.append(m_pushedChar2);
+            *destination++ = m_pushedChar2;
     }
-    m_currentString.appendTo(result);
+    m_currentString.copyTo(destination);
+    destination += m_currentString.m_length;
     if (isComposite()) {
         Deque<SegmentedSubstring>::const_iterator it = m_substrings.begin();
         Deque<SegmentedSubstring>::const_iterator e = m_substrings.end();
-        for (; it != e; ++it)
-            it->appendTo(result);
+        for (; it != e; ++it) {
+            it->copyTo(destination);
+            destination += it->m_length;
+        }
     }
     return result;
 }
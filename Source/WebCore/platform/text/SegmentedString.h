@@ -54,15 +54,12 @@ public:
 
     int numberOfCharactersConsumed() const { return m_string.length() - m_length; }
 
-    void appendTo(String& str) const
+    const String& string() const { return m_string; }
+
+    void copyTo(UChar* destination) const
     {
-        if (m_string.characters() == m_current) {
-            if (str.isEmpty())
-                str = m_string;
-            else
-                str.append(m_string);
-        } else
-            str.append(String(m_current, m_length));
+        if (m_length)
+            memcpy(destination, m_current, m_length * sizeof(UChar));
     }
 
 public:
@@ -254,20 +251,53 @@ private:
         return lookAheadSlowCase<equals>(string);
     }
 
+    // Compares against the pushed characters and then each substring in turn,
+    // so a look-ahead that straddles a segment boundary does not have to
+    // consume and re-prepend a copy of the input.
     template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
     LookAheadResult lookAheadSlowCase(const String& string)
     {
         unsigned count = string.length();
         if (count > length())
             return NotEnoughCharacters;
-        UChar* consumedCharacters;
-        String consumedString = String::createUninitialized(count, consumedCharacters);
-        advance(count, consumedCharacters);
-        LookAheadResult result = DidNotMatch;
-        if (equals(string.characters(), consumedCharacters, count))
-            result = DidMatch;
-        prepend(SegmentedString(consumedString));
-        return result;
+        const UChar* characters = string.characters();
+        if (m_pushedChar1) {
+            if (!equals(characters, &m_pushedChar1, 1))
+                return DidNotMatch;
+            ++characters;
+            if (!--count)
+                return DidMatch;
+            if (m_pushedChar2) {
+                if (!equals(characters, &m_pushedChar2, 1))
+                    return DidNotMatch;
+                ++characters;
+                if (!--count)
+                    return DidMatch;
+            }
+        }
+        if (!lookAheadSubstring<equals>(m_currentString, characters, count))
+            return DidNotMatch;
+        for (Deque<SegmentedSubstring>::const_iterator it = m_substrings.begin(); count; ++it) {
+            ASSERT(it != m_substrings.end());
+            if (!lookAheadSubstring<equals>(*it, characters, count))
+                return DidNotMatch;
+        }
+        return DidMatch;
+    }
+
+    // Matches as much of [characters, characters + count) as the substring holds
+    // and advances past what was matched.
+    template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
+    static bool lookAheadSubstring(const SegmentedSubstring& substring, const UChar*& characters, unsigned& count)
+    {
+        unsigned chunk = std::min(count, static_cast<unsigned>(substring.m_length));
+        if (!chunk)
+            return true;
+        if (!equals(characters, substring.m_current, chunk))
+            return false;
+        characters += chunk;
+        count -= chunk;
+        return true;
     }
 
     bool isComposite() const { return !m_substrings.isEmpty(); }
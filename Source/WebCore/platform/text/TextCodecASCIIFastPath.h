@@ -29,6 +29,14 @@
 
 #include <stdint.h>
 
+#if CPU(X86_64) || (CPU(X86) && defined(__SSE2__))
+#include <emmintrin.h>
+#define WTF_USE_SSE2_ASCII_FAST_PATH 1
+#elif CPU(ARM_NEON) && COMPILER(GCC)
+#include <arm_neon.h>
+#define WTF_USE_NEON_ASCII_FAST_PATH 1
+#endif
+
 namespace WebCore {
 
 // Assuming that a pointer is the size of a "machine word", then
@@ -91,6 +99,58 @@ template<typename T> inline T* alignToMachineWord(T* pointer)
     return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(pointer) & ~machineWordAlignmentMask);
 }
 
+#if USE(SSE2_ASCII_FAST_PATH) || USE(NEON_ASCII_FAST_PATH)
+// Number of bytes examined at once by the vector fast path.
+const ptrdiff_t asciiVectorSize = 16;
+
+inline bool isAllASCIIVector(const uint8_t* source)
+{
+#if USE(SSE2_ASCII_FAST_PATH)
+    // The sign bit of each byte is set only for non-ASCII bytes.
+    return !_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+#else
+    uint8x16_t bytes = vld1q_u8(source);
+    uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+    return !(vget_lane_u64(vreinterpret_u64_u8(folded), 0) & 0x8080808080808080ULL);
+#endif
+}
+
+inline void copyASCIIVector(UChar* destination, const uint8_t* source)
+{
+#if USE(SSE2_ASCII_FAST_PATH)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + 8), _mm_unpackhi_epi8(bytes, zero));
+#else
+    uint8x16_t bytes = vld1q_u8(source);
+    vst1q_u16(reinterpret_cast<uint16_t*>(destination), vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(reinterpret_cast<uint16_t*>(destination + 8), vmovl_u8(vget_high_u8(bytes)));
+#endif
+}
+#endif
+
+// Widens the run of ASCII bytes starting at source, 16 bytes at a time, and
+// advances both pointers past what was copied. Stops at the first vector that
+// contains a non-ASCII byte or when fewer than 16 bytes remain; the caller is
+// expected to finish with the machine word and byte-at-a-time loops.
+inline void copyASCIIVectors(UChar*& destination, const uint8_t*& source, const uint8_t* end)
+{
+#if USE(SSE2_ASCII_FAST_PATH) || USE(NEON_ASCII_FAST_PATH)
+    while (end - source >= asciiVectorSize) {
+        if (!isAllASCIIVector(source))
+            break;
+        copyASCIIVector(destination, source);
+        source += asciiVectorSize;
+        destination += asciiVectorSize;
+    }
+#else
+    UNUSED_PARAM(destination);
+    UNUSED_PARAM(source);
+    UNUSED_PARAM(end);
+#endif
+}
+
 } // namespace WebCore
 
 #endif // TextCodecASCIIFastPath_h
@@ -129,6 +129,11 @@ String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, boo
     while (source < end) {
         if (isASCII(*source)) {
             // Fast path for ASCII. Most Latin-1 text will be ASCII.
+            copyASCIIVectors(destination, source, end);
+            if (source == end)
+                break;
+            if (!isASCII(*source))
+                goto useLookupTable;
             if (isAlignedToMachineWord(source)) {
                 while (source < alignedEnd) {
                     MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
@@ -249,6 +249,12 @@ void RenderImage::paintReplaced(PaintInfo& paintInfo, int tx, int ty)
 
     GraphicsContext* context = paintInfo.context;
 
+    // Being painted while it loads means the image is on screen, so let it start ahead of images that are not.
+    if (CachedImage* cachedImage = m_imageResource->cachedImage()) {
+        if (cachedImage->isLoading() && cachedImage->loadPriority() < ResourceLoadPriorityMedium)
+            cachedImage->setLoadPriority(ResourceLoadPriorityMedium);
+    }
+
     if (!m_imageResource->hasImage() || m_imageResource->errorOccurred()) {
         if (paintInfo.phase == PaintPhaseSelection)
             return;
@@ -1076,7 +1076,7 @@ void DatabaseTracker::scheduleForNotification()
     ASSERT(!notificationMutex().tryLock());
 
     if (!notificationScheduled) {
-        callOnMainThread(DatabaseTracker::notifyDatabasesChanged, 0);
+        callOnMainThread(DatabaseTracker::notifyDatabasesChanged, 0, MainThreadIdlePriority);
         notificationScheduled = true;
     }
 }
@@ -234,7 +234,7 @@ void StorageTracker::syncFileSystemAndTrackerDatabase()
     for (OriginSet::const_iterator it = originSetCopy.begin(); it != setEnd; ++it) {
         if (!foundOrigins.contains(*it)) {
             RefPtr<StringImpl> originIdentifier = (*it).threadsafeCopy().impl();
-            callOnMainThread(deleteOriginOnMainThread, originIdentifier.release().leakRef());
+            callOnMainThread(deleteOriginOnMainThread, originIdentifier.release().leakRef(), MainThreadIdlePriority);
         }
     }
 }
@@ -259,7 +259,7 @@ void StorageTracker::setOriginDetails(const String& originIdentifier, const Stri
         ASSERT(m_thread);
         m_thread->scheduleTask(task.release());
     } else 
-        callOnMainThread(scheduleTask, reinterpret_cast<void*>(task.leakPtr()));
+        callOnMainThread(scheduleTask, reinterpret_cast<void*>(task.leakPtr()), MainThreadIdlePriority);
 }
 
 void StorageTracker::scheduleTask(void* taskIn)
@@ -65,10 +65,21 @@ PassRefPtr<XPathResult> XPathEvaluator::evaluate(const String& expression,
     }
 
     ec = 0;
-    RefPtr<XPathExpression> expr = createExpression(expression, resolver, ec);
-    if (ec)
-        return 0;
-    
+    RefPtr<XPathExpression> expr = expression.isNull() ? 0 : m_expressionCache.get(expression);
+    if (!expr) {
+        expr = createExpression(expression, resolver, ec);
+        if (ec)
+            return 0;
+
+        // Evaluation does not modify the compiled expression, so it can be reused for any
+        // context node, as long as it was compiled without consulting the resolver.
+        if (!expression.isNull() && expr->isResolverIndependent()) {
+            if (m_expressionCache.size() >= maximumCachedExpressions)
+                m_expressionCache.clear();
+            m_expressionCache.set(expression, expr);
+        }
+    }
+
     return expr->evaluate(contextNode, type, result, ec);
 }
 
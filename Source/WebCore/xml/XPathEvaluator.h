@@ -29,16 +29,18 @@
 
 #if ENABLE(XPATH)
 
+#include "XPathExpression.h"
 #include <wtf/Forward.h>
+#include <wtf/HashMap.h>
 #include <wtf/RefCounted.h>
 #include <wtf/PassRefPtr.h>
+#include <wtf/text/StringHash.h>
 
 namespace WebCore {
 
     typedef int ExceptionCode;
 
     class Node;
-    class XPathExpression;
     class XPathNSResolver;
     class XPathResult;
 
@@ -53,6 +55,11 @@ namespace WebCore {
 
     private:
         XPathEvaluator() { }
+
+        // Compiled expressions used by evaluate(), keyed by source. The cache is cleared when full.
+        static const unsigned maximumCachedExpressions = 32;
+        typedef HashMap<String, RefPtr<XPathExpression> > ExpressionCache;
+        ExpressionCache m_expressionCache;
     };
 
 }
@@ -50,6 +50,7 @@ PassRefPtr<XPathExpression> XPathExpression::createExpression(const String& expr
     expr->m_topExpression = parser.parseStatement(expression, resolver, ec);
     if (!expr->m_topExpression)
         return 0;
+    expr->m_isResolverIndependent = !parser.usedNamespaceResolver();
 
     return expr.release();
 }
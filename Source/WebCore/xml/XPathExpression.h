@@ -52,11 +52,19 @@ namespace WebCore {
         
         static PassRefPtr<XPathExpression> createExpression(const String& expression, XPathNSResolver*, ExceptionCode&);
         PassRefPtr<XPathResult> evaluate(Node* contextNode, unsigned short type, XPathResult*, ExceptionCode&);
-            
+
+        // False if a namespace prefix was resolved while parsing, in which case the same string
+        // may compile differently with another resolver.
+        bool isResolverIndependent() const { return m_isResolverIndependent; }
+
     private:
-        XPathExpression() { }
+        XPathExpression()
+            : m_isResolverIndependent(true)
+        {
+        }
 
         XPath::Expression* m_topExpression;
+        bool m_isResolverIndependent;
     };
 
 }
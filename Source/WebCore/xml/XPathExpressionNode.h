@@ -82,6 +82,11 @@ namespace WebCore {
 
             virtual Value::Type resultType() const = 0;
 
+            // Structural queries that let Step recognize predicates it can answer from an index.
+            virtual bool isStringLiteral(String&) const { return false; }
+            virtual bool isAttributeReference(AtomicString&) const { return false; }
+            virtual bool isAttributeEqualityTest(AtomicString&, String&) const { return false; }
+
         protected:
             unsigned subExprCount() const { return m_subExpressions.size(); }
             Expression* subExpr(unsigned i) { return m_subExpressions[i]; }
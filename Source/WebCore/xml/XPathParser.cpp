@@ -417,6 +417,7 @@ void Parser::reset(const String& data)
     
     m_topExpr = 0;
     m_gotNamespaceError = false;
+    m_usedNamespaceResolver = false;
 }
 
 int Parser::lex(void* data)
@@ -456,6 +457,7 @@ bool Parser::expandQName(const String& qName, String& localName, String& namespa
     if (colon != notFound) {
         if (!m_resolver)
             return false;
+        m_usedNamespaceResolver = true;
         namespaceURI = m_resolver->lookupNamespaceURI(qName.left(colon));
         if (namespaceURI.isNull())
             return false;
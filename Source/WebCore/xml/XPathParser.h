@@ -76,6 +76,9 @@ namespace WebCore {
             Expression* m_topExpr;
             bool m_gotNamespaceError;
 
+            // Whether the parsed expression depends on the resolver passed to parseStatement().
+            bool usedNamespaceResolver() const { return m_usedNamespaceResolver; }
+
             void registerParseNode(ParseNode*);
             void unregisterParseNode(ParseNode*);
 
@@ -117,6 +120,7 @@ namespace WebCore {
             String m_data;
             int m_lastTokenType;
             RefPtr<XPathNSResolver> m_resolver;
+            bool m_usedNamespaceResolver;
 
             HashSet<ParseNode*> m_parseNodes;
             HashSet<Vector<Predicate*>*> m_predicateVectors;
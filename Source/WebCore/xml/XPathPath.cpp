@@ -148,6 +148,24 @@ void LocationPath::evaluate(NodeSet& nodes) const
     nodes.markSorted(resultIsSorted);
 }
 
+bool LocationPath::isAttributeReference(AtomicString& localName) const
+{
+    // A relative path consisting of a single unprefixed attribute name test, e.g. @id.
+    if (m_absolute || m_steps.size() != 1)
+        return false;
+
+    const Step* step = m_steps[0];
+    if (step->axis() != Step::AttributeAxis || step->hasPredicates())
+        return false;
+
+    const Step::NodeTest& nodeTest = step->nodeTest();
+    if (nodeTest.kind() != Step::NodeTest::NameTest || nodeTest.data() == starAtom || !nodeTest.namespaceURI().isEmpty())
+        return false;
+
+    localName = nodeTest.data();
+    return true;
+}
+
 void LocationPath::appendStep(Step* step)
 {
     unsigned stepCount = m_steps.size();
@@ -65,6 +65,8 @@ namespace WebCore {
             void appendStep(Step* step);
             void insertFirstStep(Step* step);
 
+            virtual bool isAttributeReference(AtomicString& localName) const;
+
         private:
             virtual Value::Type resultType() const { return Value::NodeSetValue; }
 
@@ -61,6 +61,12 @@ Value StringExpression::evaluate() const
     return m_value;
 }
 
+bool StringExpression::isStringLiteral(String& value) const
+{
+    value = m_value.toString();
+    return true;
+}
+
 Value Negative::evaluate() const
 {
     Value p(subExpr(0)->evaluate());
@@ -201,6 +207,18 @@ Value EqTestOp::evaluate() const
     return compare(lhs, rhs);
 }
 
+bool EqTestOp::isAttributeEqualityTest(AtomicString& attributeName, String& value) const
+{
+    if (m_opcode != OP_EQ)
+        return false;
+
+    // A node-set compares equal to a string if any node in it has that string value, so the
+    // operands can be in either order.
+    if (subExpr(0)->isAttributeReference(attributeName) && subExpr(1)->isStringLiteral(value))
+        return true;
+    return subExpr(1)->isAttributeReference(attributeName) && subExpr(0)->isStringLiteral(value);
+}
+
 LogicalOp::LogicalOp(Opcode opcode, Expression* lhs, Expression* rhs)
     : m_opcode(opcode)
 {
@@ -49,6 +49,7 @@ namespace WebCore {
         class StringExpression : public Expression {
         public:
             StringExpression(const String&);
+            virtual bool isStringLiteral(String&) const;
         private:
             virtual Value evaluate() const;
             virtual Value::Type resultType() const { return Value::StringValue; }
@@ -80,6 +81,7 @@ namespace WebCore {
             enum Opcode { OP_EQ, OP_NE, OP_GT, OP_LT, OP_GE, OP_LE };
             EqTestOp(Opcode, Expression* lhs, Expression* rhs);
             virtual Value evaluate() const;
+            virtual bool isAttributeEqualityTest(AtomicString& attributeName, String& value) const;
         private:
             virtual Value::Type resultType() const { return Value::BooleanValue; }
             bool compare(const Value&, const Value&) const;
@@ -115,6 +117,9 @@ namespace WebCore {
             bool isContextPositionSensitive() const { return m_expr->isContextPositionSensitive() || m_expr->resultType() == Value::NumberValue; }
             bool isContextSizeSensitive() const { return m_expr->isContextSizeSensitive(); }
 
+            // True for predicates of the form [@name = 'literal'] or ['literal' = @name].
+            bool isAttributeEqualityTest(AtomicString& attributeName, String& value) const { return m_expr->isAttributeEqualityTest(attributeName, value); }
+
         private:
             Expression* m_expr;
         };
@@ -33,6 +33,7 @@
 #include "Attr.h"
 #include "Document.h"
 #include "Element.h"
+#include "HTMLNames.h"
 #include "NamedNodeMap.h"
 #include "XMLNSNames.h"
 #include "XPathParser.h"
@@ -68,6 +69,16 @@ void Step::optimize()
             remainingPredicates.append(predicate);
     }
     swap(remainingPredicates, m_predicates);
+
+    // descendant::foo[@id='bar'], the form that //foo[@id='bar'] is optimized into, can only match the
+    // element the document's id map holds for 'bar'. The predicate stays merged so that it is still checked.
+    m_indexedId = nullAtom;
+    AtomicString attributeName;
+    String value;
+    if (m_axis == DescendantAxis && m_nodeTest.kind() == NodeTest::NameTest && !m_nodeTest.mergedPredicates().isEmpty()
+        && m_nodeTest.mergedPredicates()[0]->isAttributeEqualityTest(attributeName, value)
+        && attributeName == HTMLNames::idAttr.localName() && !value.isEmpty())
+        m_indexedId = value;
 }
 
 void optimizeStepPair(Step* first, Step* second, bool& dropSecondStep)
@@ -232,6 +243,24 @@ static inline bool nodeMatches(Node* node, Step::Axis axis, const Step::NodeTest
     return true;
 }
 
+bool Step::nodesInAxisFromIdIndex(Node* context, NodeSet& nodes) const
+{
+    ASSERT(m_axis == DescendantAxis);
+    ASSERT(!m_indexedId.isNull());
+
+    // The id map only covers elements in the document, and its answer is only complete when the id is unique.
+    if (!context->inDocument() || context->isInShadowTree())
+        return false;
+    Document* document = context->document();
+    if (document->idAttributeName() != HTMLNames::idAttr || document->containsMultipleElementsWithId(m_indexedId))
+        return false;
+
+    Element* element = document->getElementById(m_indexedId);
+    if (element && element->isDescendantOf(context) && nodeMatches(element, DescendantAxis, m_nodeTest))
+        nodes.append(element);
+    return true;
+}
+
 // Result nodes are ordered in axis order. Node test (including merged predicates) is applied.
 void Step::nodesInAxis(Node* context, NodeSet& nodes) const
 {
@@ -249,6 +278,9 @@ void Step::nodesInAxis(Node* context, NodeSet& nodes) const
             if (context->isAttributeNode()) // In XPath model, attribute nodes do not have children.
                 return;
 
+            if (!m_indexedId.isNull() && nodesInAxisFromIdIndex(context, nodes))
+                return;
+
             for (Node* n = context->firstChild(); n; n = n->traverseNextNode(context))
                 if (nodeMatches(n, DescendantAxis, m_nodeTest))
                     nodes.append(n);
@@ -348,7 +380,7 @@ void Step::nodesInAxis(Node* context, NodeSet& nodes) const
                 return;
 
             for (unsigned i = 0; i < attrs->length(); ++i) {
-                RefPtr<Attr> attr = attrs->attributeItem(i)->createAttrIfNeeded(static_cast<Element*>(context));
+                RefPtr<Attr> attr = attrs->unsharedAttributeItem(i)->createAttrIfNeeded(static_cast<Element*>(context));
                 if (nodeMatches(attr.get(), AttributeAxis, m_nodeTest))
                     nodes.append(attr.release());
             }
@@ -85,6 +85,7 @@ namespace WebCore {
 
             Axis axis() const { return m_axis; }
             const NodeTest& nodeTest() const { return m_nodeTest; }
+            bool hasPredicates() const { return !m_predicates.isEmpty() || !m_nodeTest.mergedPredicates().isEmpty(); }
 
         private:
             friend void optimizeStepPair(Step*, Step*, bool&);
@@ -92,11 +93,15 @@ namespace WebCore {
 
             void parseNodeTest(const String&);
             void nodesInAxis(Node* context, NodeSet&) const;
+            bool nodesInAxisFromIdIndex(Node* context, NodeSet&) const;
             String namespaceFromNodetest(const String& nodeTest) const;
 
             Axis m_axis;
             NodeTest m_nodeTest;
             Vector<Predicate*> m_predicates;
+
+            // Set for descendant::foo[@id='bar'] steps, whose only candidate is the element with that id.
+            AtomicString m_indexedId;
         };
 
         void optimizeStepPair(Step*, Step*, bool& dropSecondStep);
@@ -26,6 +26,7 @@
 #include "config.h"
 #include "CacheResult.h"
 
+#include "WebCache.h"
 #include "WebResponse.h"
 #include "WebUrlLoaderClient.h"
 #include <platform/FileSystem.h>
@@ -51,6 +52,7 @@ enum {
 
 CacheResult::CacheResult(disk_cache::Entry* entry, String url)
     : m_entry(entry)
+    , m_contentSize(-1)
     , m_onResponseHeadersDoneCallback(this, &CacheResult::onResponseHeadersDone)
     , m_onReadNextChunkDoneCallback(this, &CacheResult::onReadNextChunkDone)
     , m_url(url)
@@ -58,9 +60,23 @@ CacheResult::CacheResult(disk_cache::Entry* entry, String url)
     ASSERT(m_entry);
 }
 
+CacheResult::CacheResult(WebCache* cache, String url, HttpResponseHeaders* responseHeaders, int64 contentSize)
+    : m_entry(0)
+    , m_cache(cache)
+    , m_contentSize(contentSize)
+    , m_responseHeaders(responseHeaders)
+    , m_onResponseHeadersDoneCallback(this, &CacheResult::onResponseHeadersDone)
+    , m_onReadNextChunkDoneCallback(this, &CacheResult::onReadNextChunkDone)
+    , m_url(url)
+{
+    ASSERT(m_cache);
+    ASSERT(m_responseHeaders);
+}
+
 CacheResult::~CacheResult()
 {
-    m_entry->Close();
+    if (m_entry)
+        m_entry->Close();
     // TODO: Should we also call DoneReadingFromEntry() on the cache for our
     // entry?
 }
@@ -70,7 +86,16 @@ int64 CacheResult::contentSize() const
     // The android stack does not take the content length from the HTTP response
     // headers but calculates it when writing the content to disk. It can never
     // overflow a long because we limit the cache size.
-    return m_entry->GetDataSize(kResponseContentIndex);
+    if (m_contentSize >= 0)
+        return m_contentSize;
+    return ensureEntry() ? m_entry->GetDataSize(kResponseContentIndex) : 0;
+}
+
+bool CacheResult::ensureEntry() const
+{
+    if (!m_entry && m_cache)
+        m_entry = m_cache->openEntryForUrl(m_url);
+    return m_entry;
 }
 
 bool CacheResult::firstResponseHeader(const char* name, String* result, bool allowEmptyString) const
@@ -131,7 +156,7 @@ bool CacheResult::writeToFile(const String& filePath) const
     MutexLocker lock(m_mutex);
 
     base::Thread* thread = WebUrlLoaderClient::ioThread();
-    if (!thread)
+    if (!thread || !ensureEntry())
         return false;
 
     m_filePath = filePath.threadsafeCopy();
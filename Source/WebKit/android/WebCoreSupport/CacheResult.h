@@ -34,11 +34,16 @@
 
 namespace android {
 
+class WebCache;
+
 // A wrapper around a disk_cache::Entry. Provides fields appropriate for constructing a Java CacheResult object.
 class CacheResult : public base::RefCountedThreadSafe<CacheResult> {
 public:
     // Takes ownership of the Entry passed to the constructor.
     CacheResult(disk_cache::Entry*, String url);
+    // For an entry whose headers are already known. The entry is only opened
+    // if the content size is unknown (-1) or the body is written to a file.
+    CacheResult(WebCache*, String url, net::HttpResponseHeaders*, int64 contentSize);
     ~CacheResult();
 
     int64 contentSize() const;
@@ -51,6 +56,7 @@ public:
     int responseCode() const;
     bool writeToFile(const WTF::String& filePath) const;
 private:
+    bool ensureEntry() const;
     net::HttpResponseHeaders* responseHeaders() const;
     void responseHeadersImpl();
     void onResponseHeadersDone(int size);
@@ -61,7 +67,9 @@ private:
     bool writeChunkToFile();
     void onWriteToFileDone();
 
-    disk_cache::Entry* m_entry;
+    mutable disk_cache::Entry* m_entry;
+    scoped_refptr<WebCache> m_cache;
+    int64 m_contentSize;
 
     scoped_refptr<net::HttpResponseHeaders> m_responseHeaders;
 
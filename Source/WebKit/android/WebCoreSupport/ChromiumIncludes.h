@@ -62,6 +62,7 @@
 #include <android/net/android_network_library_impl.h>
 #include <android/jni/jni_utils.h>
 #include <base/callback.h>
+#include <base/hash_tables.h>
 #include <base/lazy_instance.h>
 #include <base/memory/ref_counted.h>
 #include <base/message_loop_proxy.h>
@@ -94,6 +95,7 @@
 #include <net/http/http_cache.h>
 #include <net/http/http_network_layer.h>
 #include <net/http/http_response_headers.h>
+#include <net/http/http_util.h>
 #include <net/proxy/proxy_config_service_android.h>
 #include <net/proxy/proxy_service.h>
 #include <net/url_request/url_request.h>
@@ -103,6 +103,18 @@ bool PlatformBridge::cookiesEnabled(const Document* document)
     return WebCookieJar::get(isPrivateBrowsing)->allowCookies();
 }
 
+void PlatformBridge::prefetchDNS(const Document* document, const String& hostname)
+{
+    bool isPrivateBrowsing = document->settings() && document->settings()->privateBrowsingEnabled();
+    WebRequestContext::prefetchHost(std::string(hostname.utf8().data()), isPrivateBrowsing);
+}
+
+void PlatformBridge::preconnect(const Document* document, const KURL& url)
+{
+    bool isPrivateBrowsing = document->settings() && document->settings()->privateBrowsingEnabled();
+    WebRequestContext::preconnect(GURL(url.string().utf8().data()), isPrivateBrowsing);
+}
+
 NPObject* PlatformBridge::pluginScriptableObject(Widget* widget)
 {
     if (!widget->isPluginView())
@@ -42,6 +42,12 @@ namespace android {
 
 static WTF::Mutex instanceMutex;
 
+// Copied from HttpCache
+enum {
+    kResponseInfoIndex = 0,
+    kResponseContentIndex
+};
+
 static string storageDirectory()
 {
     static const char* const kDirectory = "/webviewCacheChromium";
@@ -90,6 +96,14 @@ WebCache::WebCache(bool isPrivateBrowsing)
     , m_openEntryCallback(this, &WebCache::openEntry)
     , m_onGetEntryDoneCallback(this, &WebCache::onGetEntryDone)
     , m_isGetEntryInProgress(false)
+    , m_openNextIndexEntryCallback(this, &WebCache::openNextIndexEntry)
+    , m_onIndexEntryOpenedCallback(this, &WebCache::onIndexEntryOpened)
+    , m_onIndexResponseInfoReadCallback(this, &WebCache::onIndexResponseInfoRead)
+    , m_indexIterator(0)
+    , m_indexEntry(0)
+    , m_indexBufferSize(0)
+    , m_isIndexLoadStarted(false)
+    , m_isIndexLoaded(false)
     , m_cacheBackend(0)
 {
     base::Thread* ioThread = WebUrlLoaderClient::ioThread();
@@ -100,15 +114,19 @@ WebCache::WebCache(bool isPrivateBrowsing)
 
     m_proxyConfigService = new ProxyConfigServiceAndroid();
     net::HttpCache::BackendFactory* backendFactory;
-    if (isPrivateBrowsing)
+    if (isPrivateBrowsing) {
         backendFactory = net::HttpCache::DefaultBackend::InMemory(kMaximumCacheSizeBytes / 2);
-    else {
+        // An in-memory cache starts out empty, so there is nothing to load into the index.
+        m_isIndexLoadStarted = m_isIndexLoaded = true;
+    } else {
         string storage(storageDirectory());
-        if (storage.empty()) // Can't get a storage directory from the OS
+        if (storage.empty()) { // Can't get a storage directory from the OS
             backendFactory = net::HttpCache::DefaultBackend::InMemory(kMaximumCacheSizeBytes / 2);
-        else {
+            m_isIndexLoadStarted = m_isIndexLoaded = true;
+        } else {
             FilePath directoryPath(storage.c_str());
             backendFactory = new net::HttpCache::DefaultBackend(net::DISK_CACHE, directoryPath, kMaximumCacheSizeBytes, cacheMessageLoopProxy);
+            m_fileBackingDirectory = WTF::String(storage.c_str());
         }
     }
 
@@ -164,6 +182,13 @@ void WebCache::clearImpl()
         return;
     m_isClearInProgress = true;
 
+    // Forget the keys now rather than when the doom completes, so that
+    // entries written in the meantime stay in the index.
+    {
+        MutexLocker lock(m_indexMutex);
+        m_index.clear();
+    }
+
     if (!m_cacheBackend) {
         int code = m_cache->GetBackend(&m_cacheBackend, &m_doomAllEntriesCallback);
         // Code ERR_IO_PENDING indicates that the operation is still in progress and
@@ -199,7 +224,26 @@ void WebCache::onClearDone(int)
 
 scoped_refptr<CacheResult> WebCache::getCacheResult(String url)
 {
-    // This is called on the UI thread.
+    // This is called on the UI thread. Don't go to the Chromium thread at all
+    // if the index knows the answer.
+    string key(url.utf8().data());
+    if (!mayHaveEntry(key))
+        return 0;
+    {
+        MutexLocker lock(m_indexMutex);
+        Index::const_iterator it = m_index.find(key);
+        if (m_isIndexLoaded && it != m_index.end() && it->second.responseHeaders)
+            return new CacheResult(this, url, it->second.responseHeaders, it->second.contentSize);
+    }
+
+    disk_cache::Entry* entry = openEntryForUrl(url);
+    if (!entry)
+        return 0;
+    return new CacheResult(entry, url);
+}
+
+disk_cache::Entry* WebCache::openEntryForUrl(const String& url)
+{
     MutexLocker lock(m_getEntryMutex);
     if (m_isGetEntryInProgress)
         return 0; // TODO: OK? Or can we queue 'em up?
@@ -219,10 +263,38 @@ scoped_refptr<CacheResult> WebCache::getCacheResult(String url)
     while (m_isGetEntryInProgress)
         m_getEntryCondition.wait(m_getEntryMutex);
 
-    if (!m_entry)
-        return 0;
+    return m_entry;
+}
 
-    return new CacheResult(m_entry, url);
+bool WebCache::mayHaveEntry(const string& key)
+{
+    {
+        MutexLocker lock(m_indexMutex);
+        if (m_isIndexLoaded)
+            return m_index.find(key) != m_index.end();
+        if (m_isIndexLoadStarted)
+            return true;
+        m_isIndexLoadStarted = true;
+    }
+
+    // The index is only loaded once something asks for it.
+    if (base::Thread* thread = WebUrlLoaderClient::ioThread())
+        thread->message_loop()->PostTask(FROM_HERE, NewRunnableMethod(this, &WebCache::loadIndexImpl));
+    return true;
+}
+
+void WebCache::didWriteEntry(const string& key, HttpResponseHeaders* responseHeaders, int64 contentSize)
+{
+    MutexLocker lock(m_indexMutex);
+    IndexEntry& entry = m_index[key];
+    entry.responseHeaders = responseHeaders;
+    entry.contentSize = contentSize;
+}
+
+void WebCache::didDoomEntry(const string& key)
+{
+    MutexLocker lock(m_indexMutex);
+    m_index.erase(key);
 }
 
 void WebCache::getEntryImpl()
@@ -259,4 +331,72 @@ void WebCache::onGetEntryDone(int)
     m_getEntryCondition.signal();
 }
 
+void WebCache::loadIndexImpl()
+{
+    if (!m_cacheBackend) {
+        int code = m_cache->GetBackend(&m_cacheBackend, &m_openNextIndexEntryCallback);
+        if (code == ERR_IO_PENDING)
+            return;
+    }
+    openNextIndexEntry(0 /*unused*/);
+}
+
+void WebCache::openNextIndexEntry(int)
+{
+    // The index stays unloaded if there is no backend to enumerate.
+    if (!m_cacheBackend)
+        return;
+
+    int rv = m_cacheBackend->OpenNextEntry(&m_indexIterator, &m_indexEntry, &m_onIndexEntryOpenedCallback);
+    if (rv == ERR_IO_PENDING)
+        return;
+    onIndexEntryOpened(rv);
+}
+
+void WebCache::onIndexEntryOpened(int rv)
+{
+    if (rv == OK) {
+        // Keep the response headers, so that getCacheResult() needn't read them.
+        m_indexBufferSize = m_indexEntry->GetDataSize(kResponseInfoIndex);
+        m_indexBuffer = new IOBuffer(m_indexBufferSize);
+        int rv = m_indexEntry->ReadData(kResponseInfoIndex, 0, m_indexBuffer, m_indexBufferSize, &m_onIndexResponseInfoReadCallback);
+        if (rv == ERR_IO_PENDING)
+            return;
+        onIndexResponseInfoRead(rv);
+        return;
+    }
+
+    m_cacheBackend->EndEnumeration(&m_indexIterator);
+    MutexLocker lock(m_indexMutex);
+    m_isIndexLoaded = true;
+}
+
+void WebCache::onIndexResponseInfoRead(int size)
+{
+    HttpResponseInfo response;
+    bool truncated = false;
+    bool parsed = size == m_indexBufferSize && HttpCache::ParseResponseInfo(m_indexBuffer->data(), m_indexBufferSize, &response, &truncated) && !truncated;
+    {
+        // Don't replace what a load has written since the enumeration started.
+        // An entry whose headers can't be read is still indexed, without them,
+        // so that getCacheResult() falls back to opening it.
+        MutexLocker lock(m_indexMutex);
+        string key = m_indexEntry->GetKey();
+        if (m_index.find(key) == m_index.end()) {
+            IndexEntry& entry = m_index[key];
+            if (parsed) {
+                entry.responseHeaders = response.headers;
+                entry.contentSize = m_indexEntry->GetDataSize(kResponseContentIndex);
+            }
+        }
+    }
+    m_indexBuffer = 0;
+    m_indexEntry->Close();
+    m_indexEntry = 0;
+
+    // Post rather than loop, so that a run of synchronous completions
+    // neither recurses nor holds up the Chromium thread.
+    MessageLoop::current()->PostTask(FROM_HERE, NewRunnableMethod(this, &WebCache::openNextIndexEntry, 0));
+}
+
 } // namespace android
@@ -43,12 +43,30 @@ public:
     static void cleanup(bool isPrivateBrowsing);
 
     void clear();
+    // Once the index has loaded, a result for an indexed entry is built from
+    // the index, and the entry itself is only opened if its body is needed.
     scoped_refptr<CacheResult> getCacheResult(WTF::String url);
+    // Blocks until the Chromium thread has opened the entry for url, which the
+    // caller then owns. Returns 0 if there is none. Called on a UI thread.
+    disk_cache::Entry* openEntryForUrl(const WTF::String& url);
+    // Answers from an in-memory index of the cache, without touching disk.
+    // False means there is no entry for key; true means there may be one, as
+    // evicted keys are not removed. Until the index has loaded, which the
+    // first call starts, the answer is always true. Threadsafe.
+    bool mayHaveEntry(const std::string& key);
+    // Keep the index current. Called on the Chromium thread when a load is
+    // about to write, or has doomed, the cache entry for key. A contentSize
+    // of -1 means the size is not known until the entry is opened.
+    void didWriteEntry(const std::string& key, net::HttpResponseHeaders*, int64 contentSize);
+    void didDoomEntry(const std::string& key);
     net::HostResolver* hostResolver() { return m_hostResolver.get(); }
     net::HttpCache* cache() { return m_cache.get(); }
     net::ProxyConfigServiceAndroid* proxy() { return m_proxyConfigService; }
     void closeIdleConnections();
     void certTrustChanged();
+    // Where large resources may be kept in mapped files next to the disk
+    // cache. Empty for an in-memory cache, such as the private browsing one.
+    const WTF::String& fileBackingDirectory() const { return m_fileBackingDirectory; }
 
 private:
     WebCache(bool isPrivateBrowsing);
@@ -67,11 +85,24 @@ private:
     void openEntry(int);
     void onGetEntryDone(int);
 
+    // For the index
+    struct IndexEntry {
+        IndexEntry() : contentSize(-1) { }
+        scoped_refptr<net::HttpResponseHeaders> responseHeaders;
+        int64 contentSize;
+    };
+    typedef base::hash_map<std::string, IndexEntry> Index;
+    void loadIndexImpl();
+    void openNextIndexEntry(int);
+    void onIndexEntryOpened(int);
+    void onIndexResponseInfoRead(int);
+
     OwnPtr<net::HostResolver> m_hostResolver;
     OwnPtr<net::HttpCache> m_cache;
     // This is owned by the ProxyService, which is owned by the HttpNetworkLayer,
     // which is owned by the HttpCache, which is owned by this class.
     net::ProxyConfigServiceAndroid* m_proxyConfigService;
+    WTF::String m_fileBackingDirectory;
 
     // For clear()
     net::CompletionCallbackImpl<WebCache> m_doomAllEntriesCallback;
@@ -85,6 +116,19 @@ private:
     disk_cache::Entry* m_entry;
     WTF::Mutex m_getEntryMutex;
     WTF::ThreadCondition m_getEntryCondition;
+    // For the index. m_index and the flags are guarded by m_indexMutex; the
+    // rest is only used on the Chromium thread, while the index loads.
+    net::CompletionCallbackImpl<WebCache> m_openNextIndexEntryCallback;
+    net::CompletionCallbackImpl<WebCache> m_onIndexEntryOpenedCallback;
+    net::CompletionCallbackImpl<WebCache> m_onIndexResponseInfoReadCallback;
+    void* m_indexIterator;
+    disk_cache::Entry* m_indexEntry;
+    int m_indexBufferSize;
+    scoped_refptr<net::IOBuffer> m_indexBuffer;
+    Index m_index;
+    bool m_isIndexLoadStarted;
+    bool m_isIndexLoaded;
+    WTF::Mutex m_indexMutex;
 
     disk_cache::Backend* m_cacheBackend;
 };
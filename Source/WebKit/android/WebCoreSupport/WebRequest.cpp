@@ -29,6 +29,7 @@
 #include "JNIUtility.h"
 #include "MainThread.h"
 #include "UrlInterceptResponse.h"
+#include "WebCache.h"
 #include "WebCoreFrameBridge.h"
 #include "WebCoreJni.h"
 #include "WebRequestContext.h"
@@ -77,6 +78,19 @@ RequestPackageName::RequestPackageName() {
 
 base::LazyInstance<RequestPackageName> s_packageName(base::LINKER_INITIALIZED);
 
+// Whether the HttpCache may store the response. It keys GET responses by
+// HttpUtil::SpecForRequest(), the URL without its fragment.
+bool isCachedByHttpCache(net::URLRequest* request)
+{
+    return request->context() && request->method() == "GET"
+        && (request->url().SchemeIs("http") || request->url().SchemeIs("https"));
+}
+
+WebCache* webCacheForRequest(net::URLRequest* request)
+{
+    return WebCache::get(static_cast<WebRequestContext*>(request->context())->isPrivateBrowsing());
+}
+
 }
 
 WebRequest::WebRequest(WebUrlLoaderClient* loader, const WebResourceRequest& webResourceRequest)
@@ -91,6 +105,7 @@ WebRequest::WebRequest(WebUrlLoaderClient* loader, const WebResourceRequest& web
     , m_wantToPause(false)
     , m_isPaused(false)
     , m_isSync(false)
+    , m_warmHints(WebRequestContext::NoHints)
 {
     GURL gurl(m_url);
 
@@ -118,6 +133,7 @@ WebRequest::WebRequest(WebUrlLoaderClient* loader, const WebResourceRequest& web
     , m_wantToPause(false)
     , m_isPaused(false)
     , m_isSync(false)
+    , m_warmHints(WebRequestContext::NoHints)
 {
 }
 
@@ -253,6 +269,18 @@ void WebRequest::start()
     updateLoadFlags(loadFlags);
     m_request->set_load_flags(loadFlags);
 
+    // A cache-only load of a URL the cache index doesn't have would just miss
+    // on disk, so fail it the same way without going to disk.
+    if ((loadFlags & net::LOAD_ONLY_FROM_CACHE) && isCachedByHttpCache(m_request.get())
+            && !webCacheForRequest(m_request.get())->mayHaveEntry(net::HttpUtil::SpecForRequest(m_request->url()))) {
+        m_request->SimulateError(net::ERR_CACHE_MISS);
+        finish(false);
+        return;
+    }
+
+    if (m_request->context())
+        m_warmHints = WebRequestContext::hintsWarmFor(m_request->url(), static_cast<WebRequestContext*>(m_request->context())->isPrivateBrowsing());
+
     m_request->Start();
 }
 
@@ -391,6 +419,12 @@ void WebRequest::OnReceivedRedirect(net::URLRequest* newRequest, const GURL& new
     ASSERT(m_loadState < Response, "Redirect after receiving response");
     ASSERT(newRequest && newRequest->status().is_success(), "Invalid redirect");
 
+    // The cache keeps redirects too.
+    if (isCachedByHttpCache(newRequest)) {
+        net::HttpResponseHeaders* headers = newRequest->response_headers();
+        webCacheForRequest(newRequest)->didWriteEntry(net::HttpUtil::SpecForRequest(newRequest->url()), headers, headers ? headers->GetContentLength() : -1);
+    }
+
     m_url = newUrl.spec();
     OwnPtr<WebResponse> webResponse(new WebResponse(newRequest));
     webResponse->setUrl(newUrl.spec());
@@ -449,6 +483,25 @@ void WebRequest::OnResponseStarted(net::URLRequest* request)
 
     m_loadState = Response;
     if (request && request->status().is_success()) {
+        // Tell the cache index about the entry the cache transaction is
+        // writing, or dooming if the response may not be stored.
+        if (isCachedByHttpCache(request)) {
+            std::string key = net::HttpUtil::SpecForRequest(request->url());
+            net::HttpResponseHeaders* headers = request->response_headers();
+            if (headers && headers->HasHeaderValue("cache-control", "no-store"))
+                webCacheForRequest(request)->didDoomEntry(key);
+            else {
+                // The cache stores the body as it comes off the network, so
+                // Content-Length, when there is one, is the size it will have.
+                webCacheForRequest(request)->didWriteEntry(key, headers, headers ? headers->GetContentLength() : -1);
+            }
+        }
+
+        // A response from the HTTP cache didn't need the hinted host or
+        // connection.
+        if (m_warmHints && !request->was_cached())
+            WebRequestContext::didUseHints(request->url(), static_cast<WebRequestContext*>(request->context())->isPrivateBrowsing(), m_warmHints);
+
         OwnPtr<WebResponse> webResponse(new WebResponse(request));
         m_urlLoader->maybeCallOnMainThread(NewRunnableMethod(
                 m_urlLoader.get(), &WebUrlLoaderClient::didReceiveResponse, webResponse.release()));
@@ -530,8 +583,7 @@ void WebRequest::startReading()
 
     m_loadState = GotData;
     // Read ok, forward buffer to webcore
-    m_urlLoader->maybeCallOnMainThread(NewRunnableMethod(m_urlLoader.get(), &WebUrlLoaderClient::didReceiveData, m_networkBuffer, bytesRead));
-    m_networkBuffer = 0;
+    forwardNetworkBuffer(bytesRead);
     MessageLoop::current()->PostTask(FROM_HERE, m_runnableFactory.NewRunnableMethod(&WebRequest::startReading));
 }
 
@@ -545,6 +597,21 @@ bool WebRequest::read(int* bytesRead)
     return m_request->Read(m_networkBuffer, kInitialReadBufSize, bytesRead);
 }
 
+void WebRequest::forwardNetworkBuffer(int bytesRead)
+{
+    // WebCore keeps the buffer it is given as part of the resource data, so
+    // copy short reads into a buffer of their own size rather than holding on
+    // to a mostly empty read buffer.
+    if (bytesRead > 0 && bytesRead < kInitialReadBufSize / 2) {
+        scoped_refptr<net::IOBuffer> buffer = new net::IOBuffer(bytesRead);
+        memcpy(buffer->data(), m_networkBuffer->data(), bytesRead);
+        m_networkBuffer = buffer;
+    }
+
+    m_urlLoader->maybeCallOnMainThread(NewRunnableMethod(m_urlLoader.get(), &WebUrlLoaderClient::didReceiveData, m_networkBuffer, bytesRead));
+    m_networkBuffer = 0;
+}
+
 // This is called when there is data available
 
 // Called when the a Read of the response body is completed after an
@@ -560,9 +627,7 @@ void WebRequest::OnReadCompleted(net::URLRequest* request, int bytesRead)
 
     if (request->status().is_success()) {
         m_loadState = GotData;
-        m_urlLoader->maybeCallOnMainThread(NewRunnableMethod(
-                m_urlLoader.get(), &WebUrlLoaderClient::didReceiveData, m_networkBuffer, bytesRead));
-        m_networkBuffer = 0;
+        forwardNetworkBuffer(bytesRead);
 
         // Get the rest of the data
         startReading();
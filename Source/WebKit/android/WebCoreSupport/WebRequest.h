@@ -95,6 +95,7 @@ public:
 private:
     void startReading();
     bool read(int* bytesRead);
+    void forwardNetworkBuffer(int bytesRead);
 
     friend class base::RefCountedThreadSafe<WebRequest>;
     virtual ~WebRequest();
@@ -118,6 +119,8 @@ private:
     bool m_wantToPause;
     bool m_isPaused;
     bool m_isSync;
+    // The WebRequestContext::HintTypes whose work this request may reuse.
+    unsigned m_warmHints;
 #ifdef LOG_REQUESTS
     time_t m_startTime;
 #endif
@@ -30,7 +30,17 @@
 #include "ChromiumInit.h"
 #include "WebCache.h"
 #include "WebCookieJar.h"
+#include "WebUrlLoaderClient.h"
 
+#include <net/base/address_list.h>
+#include <net/base/host_cache.h>
+#include <net/base/host_port_pair.h>
+#include <net/base/host_resolver_impl.h>
+#include <net/base/net_log.h>
+#include <net/http/http_network_session.h>
+#include <net/http/http_request_info.h>
+#include <net/http/http_stream_factory.h>
+#include <net/socket/client_socket_pool.h>
 #include <wtf/text/CString.h>
 
 static std::string acceptLanguageStdString("");
@@ -39,6 +49,30 @@ static WTF::Mutex acceptLanguageMutex;
 
 static int numPrivateBrowsingInstances;
 
+// A hint is not repeated for a host or origin hinted more recently than
+// this, and can only be useful to a request that starts within this time.
+static const int kHintLifetimeSeconds = 10;
+// Expired hints are swept once there are more hinted hosts than this.
+static const size_t kMaximumHintedHosts = 64;
+
+// DNS hints are keyed by host and preconnect hints by origin, as a connection
+// is only of use to requests with the same scheme, host and port. Private
+// browsing hints go to a separate network stack, so they are kept apart here
+// as well.
+struct HintedHost {
+    base::TimeTicks time;
+    bool preconnected;
+    // Whether the host resolved or the connection opened.
+    bool completed;
+    // The resource whose preload sent the preconnect hint, which is not
+    // counted as a request the hint was useful to.
+    std::string hintingUrl;
+};
+typedef base::hash_map<std::string, HintedHost> HintedHostMap;
+static HintedHostMap hintedHosts[2];
+static android::WebRequestContext::HintStatistics hintCounters;
+static WTF::Mutex hintMutex;
+
 extern void ANPSystemInterface_CleanupIncognito();
 
 using namespace WTF;
@@ -127,4 +161,229 @@ const String& WebRequestContext::acceptLanguage()
     return acceptLanguageWtfString;
 }
 
+static std::string preconnectHintKey(const GURL& url)
+{
+    return url.GetOrigin().spec();
+}
+
+// Returns false if the hint adds nothing to one given recently for the key.
+static bool recordHint(const std::string& key, bool isPreconnect, bool isPrivateBrowsing, const std::string& hintingUrl)
+{
+    MutexLocker lock(hintMutex);
+    HintedHostMap& hosts = hintedHosts[isPrivateBrowsing];
+    base::TimeTicks now = base::TimeTicks::Now();
+    base::TimeDelta lifetime = base::TimeDelta::FromSeconds(kHintLifetimeSeconds);
+
+    HintedHostMap::iterator it = hosts.find(key);
+    if (it != hosts.end() && now - it->second.time < lifetime) {
+        hintCounters.repeatedHints++;
+        return false;
+    }
+
+    if (hosts.size() > kMaximumHintedHosts) {
+        for (it = hosts.begin(); it != hosts.end();) {
+            if (now - it->second.time >= lifetime)
+                hosts.erase(it++);
+            else
+                ++it;
+        }
+    }
+
+    HintedHost& hintedHost = hosts[key];
+    hintedHost.time = now;
+    hintedHost.preconnected = isPreconnect;
+    hintedHost.completed = false;
+    hintedHost.hintingUrl = hintingUrl;
+    if (isPreconnect)
+        hintCounters.preconnectHints++;
+    else
+        hintCounters.dnsPrefetchHints++;
+    return true;
+}
+
+static void didCompleteHint(const std::string& key, bool isPrivateBrowsing, int result)
+{
+    if (result != net::OK)
+        return;
+    MutexLocker lock(hintMutex);
+    HintedHostMap::iterator it = hintedHosts[isPrivateBrowsing].find(key);
+    if (it != hintedHosts[isPrivateBrowsing].end())
+        it->second.completed = true;
+}
+
+// Whether the host cache still has the address a DNS hint resolved.
+static bool hasResolvedHost(WebCache* cache, const std::string& host)
+{
+    net::HostResolverImpl* resolver = cache->hostResolver()->GetAsHostResolverImpl();
+    if (!resolver || !resolver->cache())
+        return false;
+    net::HostCache::Key key(host, resolver->GetDefaultAddressFamily(), 0);
+    return resolver->cache()->Lookup(key, base::TimeTicks::Now());
+}
+
+// Whether the socket pool has an idle connection to the origin of the URL,
+// such as one a preconnect hint opened. The group names are those of direct
+// connections, so connections through a proxy are never counted.
+static bool hasIdleSocket(WebCache* cache, const GURL& url)
+{
+    net::HttpNetworkSession* session = cache->cache()->GetSession();
+    if (!session)
+        return false;
+    std::string group = net::HostPortPair::FromURL(url).ToString();
+    if (url.SchemeIs("https"))
+        return session->ssl_socket_pool()->IdleSocketCountInGroup("ssl/" + group);
+    return session->transport_socket_pool()->IdleSocketCountInGroup(group);
+}
+
+// Resolves a hinted host into the host cache. Lives on the Chromium thread
+// and deletes itself when done.
+class HostPrefetch {
+public:
+    static void start(scoped_refptr<WebCache> cache, std::string host, bool isPrivateBrowsing)
+    {
+        HostPrefetch* prefetch = new HostPrefetch(cache, host, isPrivateBrowsing);
+        net::HostResolver::RequestInfo info(net::HostPortPair(host, 80));
+        info.set_is_speculative(true);
+        int rv = cache->hostResolver()->Resolve(info, &prefetch->m_addresses, &prefetch->m_callback, 0, net::BoundNetLog());
+        if (rv != net::ERR_IO_PENDING)
+            prefetch->done(rv);
+    }
+
+private:
+    HostPrefetch(WebCache* cache, const std::string& host, bool isPrivateBrowsing)
+        : m_cache(cache)
+        , m_host(host)
+        , m_isPrivateBrowsing(isPrivateBrowsing)
+        , m_callback(this, &HostPrefetch::done)
+    {
+    }
+
+    void done(int result)
+    {
+        didCompleteHint(m_host, m_isPrivateBrowsing, result);
+        delete this;
+    }
+
+    scoped_refptr<WebCache> m_cache;
+    std::string m_host;
+    bool m_isPrivateBrowsing;
+    net::AddressList m_addresses;
+    net::CompletionCallbackImpl<HostPrefetch> m_callback;
+};
+
+// Opens a connection, including the proxy lookup and any TLS handshake, to a
+// hinted origin. Lives on the Chromium thread and deletes itself when done.
+class Preconnect {
+public:
+    static void start(scoped_refptr<WebCache> cache, GURL url, bool isPrivateBrowsing)
+    {
+        net::HttpNetworkSession* session = cache->cache()->GetSession();
+        if (!session)
+            return;
+
+        Preconnect* preconnect = new Preconnect(cache, url, isPrivateBrowsing);
+        session->ssl_config_service()->GetSSLConfig(&preconnect->m_sslConfig);
+        int rv = session->http_stream_factory()->PreconnectStreams(1, preconnect->m_requestInfo, preconnect->m_sslConfig, net::BoundNetLog(), &preconnect->m_callback);
+        if (rv != net::ERR_IO_PENDING)
+            preconnect->done(rv);
+    }
+
+private:
+    Preconnect(WebCache* cache, const GURL& url, bool isPrivateBrowsing)
+        : m_cache(cache)
+        , m_isPrivateBrowsing(isPrivateBrowsing)
+        , m_callback(this, &Preconnect::done)
+    {
+        m_requestInfo.url = url;
+        m_requestInfo.method = "GET";
+        m_requestInfo.motivation = net::HttpRequestInfo::PRECONNECT_MOTIVATED;
+    }
+
+    void done(int result)
+    {
+        didCompleteHint(preconnectHintKey(m_requestInfo.url), m_isPrivateBrowsing, result);
+        delete this;
+    }
+
+    scoped_refptr<WebCache> m_cache;
+    bool m_isPrivateBrowsing;
+    net::HttpRequestInfo m_requestInfo;
+    net::SSLConfig m_sslConfig;
+    net::CompletionCallbackImpl<Preconnect> m_callback;
+};
+
+void WebRequestContext::prefetchHost(const std::string& host, bool isPrivateBrowsing)
+{
+    base::Thread* thread = WebUrlLoaderClient::ioThread();
+    if (!thread || !recordHint(host, false, isPrivateBrowsing, std::string()))
+        return;
+    thread->message_loop()->PostTask(FROM_HERE, NewRunnableFunction(&HostPrefetch::start, scoped_refptr<WebCache>(WebCache::get(isPrivateBrowsing)), host, isPrivateBrowsing));
+}
+
+void WebRequestContext::preconnect(const GURL& url, bool isPrivateBrowsing)
+{
+    base::Thread* thread = WebUrlLoaderClient::ioThread();
+    if (!url.is_valid() || !thread)
+        return;
+    // A resource the disk cache may have might not need a connection at all.
+    // This includes every resource until the cache index has loaded.
+    WebCache* cache = WebCache::get(isPrivateBrowsing);
+    if (cache->mayHaveEntry(net::HttpUtil::SpecForRequest(url)))
+        return;
+    if (!recordHint(preconnectHintKey(url), true, isPrivateBrowsing, net::HttpUtil::SpecForRequest(url)))
+        return;
+    thread->message_loop()->PostTask(FROM_HERE, NewRunnableFunction(&Preconnect::start, scoped_refptr<WebCache>(cache), url, isPrivateBrowsing));
+}
+
+unsigned WebRequestContext::hintsWarmFor(const GURL& url, bool isPrivateBrowsing)
+{
+    std::string origin = preconnectHintKey(url);
+    bool preconnected = false;
+    bool resolved = false;
+    {
+        MutexLocker lock(hintMutex);
+        HintedHostMap& hosts = hintedHosts[isPrivateBrowsing];
+        base::TimeDelta lifetime = base::TimeDelta::FromSeconds(kHintLifetimeSeconds);
+        base::TimeTicks now = base::TimeTicks::Now();
+        HintedHostMap::iterator it = hosts.find(origin);
+        if (it != hosts.end() && it->second.completed && now - it->second.time < lifetime)
+            preconnected = it->second.hintingUrl != net::HttpUtil::SpecForRequest(url);
+        it = hosts.find(url.host());
+        if (it != hosts.end() && it->second.completed && now - it->second.time < lifetime)
+            resolved = true;
+    }
+
+    // A hint only helps while what it warmed is still there to reuse.
+    WebCache* cache = WebCache::get(isPrivateBrowsing);
+    unsigned hints = NoHints;
+    if (preconnected && hasIdleSocket(cache, url))
+        hints |= PreconnectHint;
+    if (resolved && hasResolvedHost(cache, url.host()))
+        hints |= DNSPrefetchHint;
+    return hints;
+}
+
+void WebRequestContext::didUseHints(const GURL& url, bool isPrivateBrowsing, unsigned hints)
+{
+    MutexLocker lock(hintMutex);
+    HintedHostMap& hosts = hintedHosts[isPrivateBrowsing];
+    // Each hint is counted for the first request that reuses it. Another
+    // request may have done so since this one started.
+    HintedHostMap::iterator it;
+    if ((hints & PreconnectHint) && (it = hosts.find(preconnectHintKey(url))) != hosts.end()) {
+        hintCounters.usefulPreconnectHints++;
+        hosts.erase(it);
+    }
+    if ((hints & DNSPrefetchHint) && (it = hosts.find(url.host())) != hosts.end()) {
+        hintCounters.usefulDnsPrefetchHints++;
+        hosts.erase(it);
+    }
+}
+
+WebRequestContext::HintStatistics WebRequestContext::hintStatistics()
+{
+    MutexLocker lock(hintMutex);
+    return hintCounters;
+}
+
 } // namespace android
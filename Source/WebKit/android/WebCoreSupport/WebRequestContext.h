@@ -46,9 +46,41 @@ public:
     void setUserAgent(const WTF::String&);
     void setCacheMode(int);
     int getCacheMode();
+    bool isPrivateBrowsing() const { return m_isPrivateBrowsing; }
     static void setAcceptLanguage(const WTF::String&);
     static const WTF::String& acceptLanguage();
 
+    // Hints about hosts that WebCore expects to load from soon. These are
+    // threadsafe and do their work on the Chromium thread of the network
+    // stack for the given browsing mode. preconnect() does nothing for URLs
+    // the disk cache may already have.
+    static void prefetchHost(const std::string& host, bool isPrivateBrowsing);
+    static void preconnect(const GURL&, bool isPrivateBrowsing);
+
+    // Called on the Chromium thread as a network request starts, and returns
+    // which of the hints for its host or origin left a resolved host or an
+    // idle connection it can reuse. The preload that sent a preconnect hint
+    // does not count. Once the response has come from the network rather
+    // than the HTTP cache, pass those hints to didUseHints().
+    enum HintTypes {
+        NoHints = 0,
+        DNSPrefetchHint = 1 << 0,
+        PreconnectHint = 1 << 1
+    };
+    static unsigned hintsWarmFor(const GURL&, bool isPrivateBrowsing);
+    static void didUseHints(const GURL&, bool isPrivateBrowsing, unsigned hints);
+
+    struct HintStatistics {
+        unsigned dnsPrefetchHints;
+        unsigned preconnectHints;
+        // Hints dropped because the host or origin was hinted recently.
+        unsigned repeatedHints;
+        // Hints whose resolved host or open connection a later request reused.
+        unsigned usefulDnsPrefetchHints;
+        unsigned usefulPreconnectHints;
+    };
+    static HintStatistics hintStatistics();
+
 private:
     WebRequestContext();
     ~WebRequestContext();
@@ -33,6 +33,7 @@
 #include "ResourceHandle.h"
 #include "ResourceHandleClient.h"
 #include "ResourceResponse.h"
+#include "SharedBuffer.h"
 #include "WebCoreFrameBridge.h"
 #include "WebRequest.h"
 #include "WebResourceRequest.h"
@@ -45,6 +46,32 @@ using base::AutoLock;
 
 namespace android {
 
+namespace {
+
+// Lets the resource data keep a network read buffer instead of copying it.
+class IOBufferDataSegment : public WebCore::SharedBuffer::DataSegment {
+public:
+    static PassRefPtr<IOBufferDataSegment> create(scoped_refptr<net::IOBuffer> buffer, int size)
+    {
+        return adoptRef(new IOBufferDataSegment(buffer, size));
+    }
+
+    virtual const char* data() const { return m_buffer->data(); }
+    virtual unsigned size() const { return m_size; }
+
+private:
+    IOBufferDataSegment(scoped_refptr<net::IOBuffer> buffer, int size)
+        : m_buffer(buffer)
+        , m_size(size)
+    {
+    }
+
+    scoped_refptr<net::IOBuffer> m_buffer;
+    unsigned m_size;
+};
+
+} // namespace
+
 base::Thread* WebUrlLoaderClient::ioThread()
 {
     static base::Thread* networkThread = 0;
@@ -355,7 +382,7 @@ void WebUrlLoaderClient::maybeCallOnMainThread(Task* task)
         m_queue.push_back(task);
     } else {
         // Let WebKit handle it.
-        callOnMainThread(RunTask, task);
+        callOnMainThread(RunTask, task, MainThreadLoadingPriority);
     }
 }
 
@@ -393,9 +420,9 @@ void WebUrlLoaderClient::didReceiveData(scoped_refptr<net::IOBuffer> buf, int si
     if (!isActive() || !size)
         return;
 
-    // didReceiveData will take a copy of the data
+    // The buffer is passed on as is, clients that keep the data adopt it rather than copy it
     if (m_resourceHandle && m_resourceHandle->client())
-        m_resourceHandle->client()->didReceiveData(m_resourceHandle.get(), buf->data(), size, size);
+        m_resourceHandle->client()->didReceiveDataSegment(m_resourceHandle.get(), IOBufferDataSegment::create(buf, size), size);
 }
 
 // For data url's
@@ -31,5 +31,5 @@
 
 void MainThreadProxy::CallOnMainThread(CallOnMainThreadFunction f, void* c)
 {
-    callOnMainThread(f, c);
+    callOnMainThread(f, c, MainThreadIdlePriority);
 }
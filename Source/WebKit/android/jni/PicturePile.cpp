@@ -310,6 +310,7 @@ Picture* PicturePile::recordPicture(PicturePainter* painter, PictureContainer& p
 
     Recording* picture = new Recording();
     WebCore::PlatformGraphicsContextRecording pgc(picture);
+    pgc.setDisplayZoomScale(painter->displayZoomScale());
     WebCore::GraphicsContext gc(&pgc);
     painter->paintContents(&gc, pc.area);
     pc.maxZoomScale = pgc.maxZoomScale();
@@ -359,6 +360,7 @@ Picture* PicturePile::recordPicture(PicturePainter* painter, PictureContainer& p
         }
     }
     WebCore::PlatformGraphicsContextSkia pgc(canvas);
+    pgc.setDisplayZoomScale(painter->displayZoomScale());
     WebCore::GraphicsContext gc(&pgc);
     ALOGV("painting picture: " INT_RECT_FORMAT, INT_RECT_ARGS(drawArea));
     painter->paintContents(&gc, drawArea);
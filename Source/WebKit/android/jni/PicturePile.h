@@ -62,6 +62,8 @@ public:
     {
         return 0;
     }
+    // The zoom scale of the view the contents are shown in.
+    virtual float displayZoomScale() { return 1; }
     virtual ~PicturePainter() {}
 };
 
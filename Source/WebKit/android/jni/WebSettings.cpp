@@ -47,6 +47,7 @@
 #include "RenderTable.h"
 #include "SQLiteFileSystem.h"
 #include "Settings.h"
+#include "WebCache.h"
 #include "WebCoreFrameBridge.h"
 #include "WebCoreJni.h"
 #include "WorkerContextExecutionProxy.h"
@@ -508,6 +509,8 @@ public:
 
         flag = env->GetBooleanField(obj, gFieldIds->mPrivateBrowsingEnabled);
         s->setPrivateBrowsingEnabled(flag);
+        // Only the regular cache keeps files on disk, so this is empty in private browsing.
+        s->setResourceFileBackingPath(WebCache::get(flag)->fileBackingDirectory());
 
         flag = env->GetBooleanField(obj, gFieldIds->mSyntheticLinksEnabled);
         s->setDefaultFormatDetection(flag);
@@ -79,6 +79,7 @@
 #include "HistoryItem.h"
 #include "HitTestRequest.h"
 #include "HitTestResult.h"
+#include "ImageSource.h"
 #include "InlineTextBox.h"
 #include "KeyboardEvent.h"
 #include "MemoryUsage.h"
@@ -124,12 +125,15 @@
 #include "SkUtils.h"
 #include "Text.h"
 #include "TextIterator.h"
+#include "ThreadGlobalData.h"
+#include "ThreadTimers.h"
 #include "TilesManager.h"
 #include "TypingCommand.h"
 #include "WebCache.h"
 #include "WebCoreFrameBridge.h"
 #include "WebCoreJni.h"
 #include "WebFrameView.h"
+#include "WebRequestContext.h"
 #include "WindowsKeyboardCodes.h"
 #include "autofill/WebAutofill.h"
 #include "htmlediting.h"
@@ -144,6 +148,7 @@
 #include <cutils/properties.h>
 #include <v8.h>
 #include <wtf/CurrentTime.h>
+#include <wtf/MainThread.h>
 #include <wtf/text/AtomicString.h>
 #include <wtf/text/CString.h>
 #include <wtf/text/StringImpl.h>
@@ -434,6 +439,7 @@ WebViewCore::WebViewCore(JNIEnv* env, jobject javaWebViewCore, WebCore::Frame* m
     , m_screenHeight(240)
     , m_textWrapWidth(320)
     , m_scale(1.0f)
+    , m_recordedZoomScale(1.0f)
     , m_groupForVisitedLinks(0)
     , m_cacheMode(0)
     , m_fullscreenVideoMode(false)
@@ -1141,8 +1147,17 @@ void WebViewCore::setSizeScreenWidthAndScale(int width, int height,
     m_screenWidth = screenWidth;
     m_screenHeight = screenHeight;
     m_textWrapWidth = textWrapWidth;
-    if (scale >= 0) // negative means keep the current scale
+    if (scale >= 0) { // negative means keep the current scale
         m_scale = scale;
+        // Images are decoded for a limited amount of zoom past the scale they
+        // were recorded at. Past that, record them again so they decode more.
+        if (WebCore::ImageSource::isZoomedPastDisplaySize(m_recordedZoomScale, scale)) {
+            m_recordedZoomScale = scale;
+            if (WebCore::RenderView* renderView = m_mainFrame->contentRenderer())
+                renderView->repaintRectangleInViewAndCompositedLayers(renderView->documentRect());
+        } else if (scale > 0)
+            m_recordedZoomScale = std::min(m_recordedZoomScale, scale);
+    }
     m_maxXScroll = screenWidth >> 2;
     m_maxYScroll = m_maxXScroll * height / width;
     // Don't reflow if the diff is small.
@@ -1253,6 +1268,25 @@ void WebViewCore::dumpDomTree(bool useFile)
     if (useFile)
         gDomTreeFile = fopen(DOM_TREE_LOG_FILE, "w");
     m_mainFrame->document()->showTreeForThis();
+    // Per-class node memory accounting; a no-op unless built with ENABLE_NODE_STATISTICS=true.
+    WebCore::Node::dumpStatistics();
+#if STRING_STATS
+    WTF::StringStats::printStats();
+#endif
+    const WebCore::ThreadTimers::Statistics& timers = WebCore::threadGlobalData().threadTimers().statistics();
+    DUMP_DOM_LOGD("Timers: %u active (peak %u), %llu fired, %llu wakeups, %llu cascaded, lateness %.1fms average, %.1fms max\n",
+        timers.activeTimers, timers.peakActiveTimers, timers.firedTimers, timers.wakeups, timers.cascadedTimers,
+        timers.firedTimers ? timers.totalFireLateness * 1000 / timers.firedTimers : 0, timers.maxFireLateness * 1000);
+    static const char* const laneNames[WTF::MainThreadPriorityCount] = { "input", "rendering", "loading", "idle" };
+    for (unsigned lane = 0; lane < WTF::MainThreadPriorityCount; ++lane) {
+        WTF::MainThreadLaneStatistics functions = WTF::mainThreadLaneStatistics(static_cast<WTF::MainThreadPriority>(lane));
+        DUMP_DOM_LOGD("Main thread %s lane: %u pending, %llu dispatched, latency %.1fms average, %.1fms max\n",
+            laneNames[lane], functions.pendingFunctions, functions.dispatchedFunctions,
+            functions.dispatchedFunctions ? functions.totalLatency * 1000 / functions.dispatchedFunctions : 0, functions.maxLatency * 1000);
+    }
+    WebRequestContext::HintStatistics hints = WebRequestContext::hintStatistics();
+    DUMP_DOM_LOGD("Network hints: %u DNS prefetch (%u reused), %u preconnect (%u reused), %u repeated\n",
+        hints.dnsPrefetchHints, hints.usefulDnsPrefetchHints, hints.preconnectHints, hints.usefulPreconnectHints, hints.repeatedHints);
     if (gDomTreeFile) {
         fclose(gDomTreeFile);
         gDomTreeFile = 0;
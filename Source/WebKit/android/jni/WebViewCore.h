@@ -616,6 +616,7 @@ namespace android {
 
         virtual void paintContents(WebCore::GraphicsContext* gc, WebCore::IntRect& dirty);
         virtual SkCanvas* createPrerenderCanvas(WebCore::PrerenderedInval* prerendered);
+        virtual float displayZoomScale() { return m_scale; }
 #ifdef CONTEXT_RECORDING
         WebCore::GraphicsOperationCollection* rebuildGraphicsOperationCollection(const SkIRect& inval);
 #endif
@@ -774,6 +775,9 @@ namespace android {
         int m_screenHeight;// height of the visible rect in document coordinates
         int m_textWrapWidth;
         float m_scale;
+        // The smallest scale images were painted for since they last had to be
+        // painted again to decode more pixels.
+        float m_recordedZoomScale;
         WebCore::PageGroup* m_groupForVisitedLinks;
         int m_cacheMode;
         bool m_fullscreenVideoMode;
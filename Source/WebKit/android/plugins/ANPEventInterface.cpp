@@ -30,7 +30,7 @@
 #include "PluginView.h"
 #include "PluginWidgetAndroid.h"
 
-#include "JavaSharedClient.h"
+#include <wtf/MainThread.h>
 
 using namespace android;
 
@@ -69,7 +69,8 @@ static void anp_postEvent(NPP instance, const ANPEvent* event) {
         wrapper->fPWA = pluginWidget;
         // make a copy of the event
         wrapper->fEvent = *event;
-        JavaSharedClient::EnqueueFunctionPtr(send_anpevent, wrapper);
+        // Plugin events are user input, so they run ahead of loading and idle work.
+        callOnMainThread(send_anpevent, wrapper, MainThreadInputPriority);
     }
 }
 
@@ -76,7 +76,7 @@ static bool callDumpDomTree(const Frame* frame, const Connection* conn) {
 class WebCoreHandler : public Handler {
 public:
     virtual void post(TargetThreadFunction func, void* v) const {
-        callOnMainThread(func, v);
+        callOnMainThread(func, v, MainThreadIdlePriority);
     }
 };
 static WebCoreHandler s_webcoreHandler;
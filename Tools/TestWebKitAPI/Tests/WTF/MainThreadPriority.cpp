@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. AND ITS CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL APPLE INC. OR ITS CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+
+#include "PlatformUtilities.h"
+#include <JavaScriptCore/MainThread.h>
+#include <JavaScriptCore/Threading.h>
+#include <JavaScriptCore/Vector.h>
+
+namespace TestWebKitAPI {
+
+static Vector<int> dispatchOrder;
+static bool done;
+
+static void record(void* context)
+{
+    dispatchOrder.append(static_cast<int>(reinterpret_cast<intptr_t>(context)));
+}
+
+static void finish(void*)
+{
+    done = true;
+}
+
+static void* tag(int value)
+{
+    return reinterpret_cast<void*>(static_cast<intptr_t>(value));
+}
+
+static void runQueuedFunctions()
+{
+    done = false;
+    callOnMainThread(finish, 0, MainThreadIdlePriority);
+    Util::run(&done);
+}
+
+TEST(WTF, MainThreadPriorityOrder)
+{
+    WTF::initializeMainThread();
+    dispatchOrder.clear();
+
+    callOnMainThread(record, tag(1), MainThreadIdlePriority);
+    callOnMainThread(record, tag(2));
+    callOnMainThread(record, tag(3), MainThreadRenderingPriority);
+    callOnMainThread(record, tag(4), MainThreadInputPriority);
+    callOnMainThread(record, tag(5), MainThreadLoadingPriority);
+    callOnMainThread(record, tag(6), MainThreadIdlePriority);
+    runQueuedFunctions();
+
+    // Higher lanes go first; each lane is first in, first out. Calls without a priority are loading work.
+    TEST_ASSERT(dispatchOrder.size() == 6);
+    TEST_ASSERT(dispatchOrder[0] == 4);
+    TEST_ASSERT(dispatchOrder[1] == 3);
+    TEST_ASSERT(dispatchOrder[2] == 2);
+    TEST_ASSERT(dispatchOrder[3] == 5);
+    TEST_ASSERT(dispatchOrder[4] == 1);
+    TEST_ASSERT(dispatchOrder[5] == 6);
+}
+
+TEST(WTF, MainThreadPriorityStarvation)
+{
+    WTF::initializeMainThread();
+    dispatchOrder.clear();
+
+    // An idle function that has waited longer than its lane allows (1 second) runs ahead of input.
+    callOnMainThread(record, tag(1), MainThreadIdlePriority);
+    Util::sleep(1.2);
+    callOnMainThread(record, tag(2), MainThreadInputPriority);
+    runQueuedFunctions();
+
+    TEST_ASSERT(dispatchOrder.size() == 2);
+    TEST_ASSERT(dispatchOrder[0] == 1);
+    TEST_ASSERT(dispatchOrder[1] == 2);
+}
+
+TEST(WTF, MainThreadPriorityCancel)
+{
+    WTF::initializeMainThread();
+    dispatchOrder.clear();
+
+    // Cancelling finds the function whichever lane it was queued in.
+    callOnMainThread(record, tag(1), MainThreadRenderingPriority);
+    callOnMainThread(record, tag(2), MainThreadIdlePriority);
+    callOnMainThread(record, tag(3));
+    cancelCallOnMainThread(record, tag(2));
+    runQueuedFunctions();
+
+    TEST_ASSERT(dispatchOrder.size() == 2);
+    TEST_ASSERT(dispatchOrder[0] == 1);
+    TEST_ASSERT(dispatchOrder[1] == 3);
+}
+
+TEST(WTF, MainThreadPriorityStatistics)
+{
+    WTF::initializeMainThread();
+    dispatchOrder.clear();
+    WTF::resetMainThreadLaneStatistics();
+
+    callOnMainThread(record, tag(1), MainThreadRenderingPriority);
+    callOnMainThread(record, tag(2), MainThreadRenderingPriority);
+    callOnMainThread(record, tag(3), MainThreadInputPriority);
+    TEST_ASSERT(WTF::mainThreadLaneStatistics(MainThreadRenderingPriority).pendingFunctions == 2);
+    TEST_ASSERT(WTF::mainThreadLaneStatistics(MainThreadInputPriority).pendingFunctions == 1);
+
+    Util::sleep(0.05);
+    runQueuedFunctions();
+
+    WTF::MainThreadLaneStatistics rendering = WTF::mainThreadLaneStatistics(MainThreadRenderingPriority);
+    TEST_ASSERT(!rendering.pendingFunctions);
+    TEST_ASSERT(rendering.dispatchedFunctions == 2);
+    TEST_ASSERT(rendering.maxLatency >= 0.05);
+    TEST_ASSERT(rendering.totalLatency >= 2 * 0.05);
+    TEST_ASSERT(WTF::mainThreadLaneStatistics(MainThreadInputPriority).dispatchedFunctions == 1);
+    // The idle lane ran the function that ended the run loop.
+    TEST_ASSERT(WTF::mainThreadLaneStatistics(MainThreadIdlePriority).dispatchedFunctions == 1);
+    TEST_ASSERT(!WTF::mainThreadLaneStatistics(MainThreadLoadingPriority).dispatchedFunctions);
+}
+
+static void* queueThenWait(void*)
+{
+    callOnMainThread(record, tag(1));
+    callOnMainThreadAndWait(record, tag(2));
+    callOnMainThread(record, tag(3));
+    callOnMainThread(finish, 0);
+    return 0;
+}
+
+TEST(WTF, MainThreadPriorityAndWaitKeepsOrder)
+{
+    WTF::initializeMainThread();
+    dispatchOrder.clear();
+    done = false;
+
+    // A function the caller waits for still runs after the functions it queued before.
+    ThreadIdentifier thread = createThread(queueThenWait, 0, "MainThreadPriorityAndWaitKeepsOrder");
+    Util::run(&done);
+    waitForThreadCompletion(thread, 0);
+
+    TEST_ASSERT(dispatchOrder.size() == 3);
+    TEST_ASSERT(dispatchOrder[0] == 1);
+    TEST_ASSERT(dispatchOrder[1] == 2);
+    TEST_ASSERT(dispatchOrder[2] == 3);
+}
+
+} // namespace TestWebKitAPI
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. AND ITS CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL APPLE INC. OR ITS CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "Test.h"
+
+#include <WebCore/SharedBuffer.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace WebCore;
+
+namespace TestWebKitAPI {
+
+static const unsigned minimumFileBackedSize = 64 * 1024;
+
+static void fill(Vector<char>& chunk, unsigned seed)
+{
+    for (size_t i = 0; i < chunk.size(); ++i)
+        chunk[i] = static_cast<char>(seed * 31 + i);
+}
+
+static String temporaryDirectory()
+{
+    const char* directory = getenv("TMPDIR");
+    return directory ? String(directory) : String("/tmp");
+}
+
+TEST(WebCore, SharedBufferFileBackedDataStaysValid)
+{
+    RefPtr<SharedBuffer> buffer = SharedBuffer::create();
+    buffer->setFileBacking(temporaryDirectory(), minimumFileBackedSize);
+
+    // Once the buffer is file-backed, grow it well past its first mapping while
+    // holding on to every pointer data() returns.
+    static const unsigned chunkSize = 16 * 1024;
+    Vector<char> expected;
+    Vector<const char*> heldData;
+    for (unsigned i = 0; i < 256; ++i) {
+        Vector<char> chunk(chunkSize);
+        fill(chunk, i);
+        buffer->append(chunk.data(), chunk.size());
+        expected.append(chunk.data(), chunk.size());
+        if (buffer->size() >= minimumFileBackedSize)
+            heldData.append(buffer->data());
+    }
+
+    TEST_ASSERT(buffer->size() == expected.size());
+    TEST_ASSERT(!memcmp(buffer->data(), expected.data(), expected.size()));
+    size_t firstHeldSize = expected.size() - (heldData.size() - 1) * chunkSize;
+    for (size_t i = 0; i < heldData.size(); ++i)
+        TEST_ASSERT(!memcmp(heldData[i], expected.data(), firstHeldSize + i * chunkSize));
+}
+
+} // namespace TestWebKitAPI